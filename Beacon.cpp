@@ -0,0 +1,150 @@
+/*
+ * Beacon.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include <cmath>
+#include "Beacon.h"
+
+using namespace std;
+
+const float Beacon::SIGMA = 0.01f;  // minimum standard deviation of a measured point, given in [m]
+
+/**
+ * Creates a Beacon object.
+ */
+Beacon::Beacon() : Point() {
+    
+    residual = 0.0f;
+    
+    covariance[0][0] = 0.0f;
+    covariance[0][1] = 0.0f;
+    covariance[1][0] = 0.0f;
+    covariance[1][1] = 0.0f;
+    
+    size = 0;
+}
+
+/**
+ * Deletes this object.
+ */
+Beacon::~Beacon() {}
+
+/**
+ * Fits a circle with a given radius to the points of a beacon, and sets the
+ * coordinates of this beacon to the center of that circle.
+ * The fit minimizes the algebraic distances <code>(x-xc)^2+(y-yc)^2-radius^2</code>
+ * with a fixed number of Gauss-Newton iterations. It starts from the centroid of
+ * the points, moved away from the sensor by the radius of the circle.
+ * @param x an array with the x coordinates of the points, given in [m].
+ * @param y an array with the y coordinates of the points, given in [m].
+ * @param size the number of points.
+ * @param radius the known radius of the beacon, given in [m].
+ * @return <code>true</code> if the fit was successful, <code>false</code> otherwise.
+ */
+bool Beacon::fit(float x[], float y[], unsigned short size, float radius) {
+    
+    this->size = size;
+    
+    if (size < 1) return false;
+    
+    // calculate initial center from the centroid of the points
+    
+    float xc = 0.0f;
+    float yc = 0.0f;
+    
+    for (unsigned short i = 0; i < size; i++) {
+        xc += x[i];
+        yc += y[i];
+    }
+    
+    xc /= (float)size;
+    yc /= (float)size;
+    
+    float distance = sqrt(xc*xc+yc*yc);
+    if (distance < radius) return false;
+    
+    xc += radius*xc/distance;
+    yc += radius*yc/distance;
+    
+    // refine the center with Gauss-Newton iterations, with a small Levenberg damping of each step,
+    // so that the step stays bounded when the points only cover a small arc of the circle
+    
+    float radius2 = radius*radius;
+    
+    for (unsigned short iteration = 0; iteration < ITERATIONS; iteration++) {
+        
+        float a11 = 0.0f, a12 = 0.0f, a22 = 0.0f, b1 = 0.0f, b2 = 0.0f;
+        
+        for (unsigned short i = 0; i < size; i++) {
+            
+            float dx = x[i]-xc;
+            float dy = y[i]-yc;
+            float f = dx*dx+dy*dy-radius2;
+            
+            a11 += 4.0f*dx*dx;
+            a12 += 4.0f*dx*dy;
+            a22 += 4.0f*dy*dy;
+            b1 += 2.0f*dx*f;
+            b2 += 2.0f*dy*f;
+        }
+        
+        // damp the step with a multiple of the identity, scaled with the trace of the normal matrix
+        
+        float lambda = 1.0e-4f*(a11+a22);
+        a11 += lambda;
+        a22 += lambda;
+        
+        float determinant = a11*a22-a12*a12;
+        if (determinant <= 0.0f) break;
+        
+        xc += (a22*b1-a12*b2)/determinant;
+        yc += (a11*b2-a12*b1)/determinant;
+    }
+    
+    // calculate residual and covariance of the center with the geometric distances
+    
+    float sum = 0.0f, a11 = 0.0f, a12 = 0.0f, a22 = 0.0f;
+    
+    for (unsigned short i = 0; i < size; i++) {
+        
+        float dx = x[i]-xc;
+        float dy = y[i]-yc;
+        float d = sqrt(dx*dx+dy*dy);
+        
+        sum += (d-radius)*(d-radius);
+        
+        if (d > 0.0f) {
+            a11 += dx*dx/d/d;
+            a12 += dx*dy/d/d;
+            a22 += dy*dy/d/d;
+        }
+    }
+    
+    residual = sqrt(sum/(float)size);
+    
+    float sigma2 = (size > 2) ? sum/(float)(size-2) : 0.0f;
+    if (sigma2 < SIGMA*SIGMA) sigma2 = SIGMA*SIGMA;
+    
+    // the center cannot be further away from the initial center than the radius
+    
+    a11 += sigma2/radius2;
+    a22 += sigma2/radius2;
+    
+    float determinant = a11*a22-a12*a12;
+    
+    covariance[0][0] = sigma2*a22/determinant;
+    covariance[0][1] = -sigma2*a12/determinant;
+    covariance[1][0] = -sigma2*a12/determinant;
+    covariance[1][1] = sigma2*a11/determinant;
+    
+    // set coordinates of this beacon
+    
+    this->x = xc;
+    this->y = yc;
+    this->r = sqrt(xc*xc+yc*yc);
+    this->alpha = atan2(yc, xc);
+    
+    return true;
+}
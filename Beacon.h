@@ -0,0 +1,36 @@
+/*
+ * Beacon.h
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#ifndef BEACON_H_
+#define BEACON_H_
+
+#include <cstdlib>
+#include "Point.h"
+
+/**
+ * This class stores the center of a cylindrical beacon, i.e. a pipe, that was
+ * measured with a laser scanner. The center is obtained by fitting a circle of
+ * known radius to the points of the beacon.
+ */
+class Beacon : public Point {
+    
+    public:
+        
+        float           residual;           // root mean square of the fit residuals, given in [m]
+        float           covariance[2][2];   // covariance matrix of the center coordinates, given in [m2]
+        unsigned short  size;               // number of points the center was fitted to
+        
+                        Beacon();
+        virtual         ~Beacon();
+        bool            fit(float x[], float y[], unsigned short size, float radius);
+        
+    private:
+        
+        static const unsigned short ITERATIONS = 5; // fixed number of iterations of the fit
+        static const float          SIGMA;          // minimum standard deviation of a measured point, given in [m]
+};
+
+#endif /* BEACON_H_ */
@@ -0,0 +1,19 @@
+/*
+ * ByteStream.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include "ByteStream.h"
+
+using namespace std;
+
+/**
+ * Creates an abstract byte stream object.
+ */
+ByteStream::ByteStream() {}
+
+/**
+ * Deletes the byte stream object.
+ */
+ByteStream::~ByteStream() {}
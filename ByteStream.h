@@ -0,0 +1,31 @@
+/*
+ * ByteStream.h
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#ifndef BYTE_STREAM_H_
+#define BYTE_STREAM_H_
+
+#include <cstdlib>
+
+/**
+ * This is an abstract class of a bidirectional stream of bytes, like a serial interface.
+ * It allows device drivers to be independent of the hardware that receives the bytes,
+ * so that they can also be used with a simulated source of bytes.
+ * <br/>
+ * Derived classes implement the <code>read()</code> method without blocking, it copies
+ * the bytes that were received so far into a buffer and returns their number. The
+ * <code>write()</code> method writes bytes into the stream and returns their number.
+ */
+class ByteStream {
+    
+    public:
+        
+                        ByteStream();
+        virtual         ~ByteStream();
+        virtual int     read(char buffer[], int size) = 0;
+        virtual int     write(const char buffer[], int size) = 0;
+};
+
+#endif /* BYTE_STREAM_H_ */
@@ -8,23 +8,20 @@
 
 using namespace std;
 
-const float Controller::PERIOD = 0.001f;                    // period of control task, given in [s]
 const float Controller::M_PI = 3.14159265f;                 // the mathematical constant PI
-const float Controller::WHEEL_DISTANCE = 0.190f;            // distance between wheels, given in [m]
-const float Controller::WHEEL_RADIUS = 0.0375f;             // radius of wheels, given in [m]
-const float Controller::MAXIMUM_VELOCITY = 500.0;           // maximum wheel velocity, given in [rpm]
-const float Controller::MAXIMUM_ACCELERATION = 200.0;       // maximum wheel acceleration, given in [rpm/s]
-const float Controller::COUNTS_PER_TURN = 1200.0f;          // encoder resolution (pololu motors: 1200.0f, maxon motors: 86016.0f)
 const float Controller::LOWPASS_FILTER_FREQUENCY = 300.0f;  // given in [rad/s]
-const float Controller::KN = 40.0f;                         // speed constant in [rpm/V] (pololu motors: 40.0f, maxon motors: 45.0f)
-const float Controller::KP = 0.15f;                         // speed controller gain in [V/rpm]
-const float Controller::MAX_VOLTAGE = 12.0f;                // battery voltage in [V]
 const float Controller::MIN_DUTY_CYCLE = 0.02f;             // minimum duty-cycle
 const float Controller::MAX_DUTY_CYCLE = 0.98f;             // maximum duty-cycle
 const float Controller::SIGMA_TRANSLATION = 0.0001;         // standard deviation of estimated translation per period, given in [m]
 const float Controller::SIGMA_ORIENTATION = 0.0002;         // standard deviation of estimated orientation per period, given in [rad]
 const float Controller::SIGMA_DISTANCE = 0.01;              // standard deviation of distance measurement, given in [m]
 const float Controller::SIGMA_GAMMA = 0.02;                 // standard deviation of angle measurement, given in [rad]
+const float Controller::SMALL_ANGLE = 0.1f;                 // rotation per period below which the arc is integrated with series, given in [rad]
+const float Controller::SIGMA_GYRO = 0.02f;                 // standard deviation of gyro measurement, given in [rad/s]
+const float Controller::BIAS_GAIN = 0.0001f;                // gain of the estimation of the gyro bias per period
+const float Controller::STATIONARY_BIAS_GAIN = 0.002f;      // gain of the estimation of the gyro bias per period while the robot stands still
+const float Controller::SLIP_THRESHOLD = 0.3f;              // difference of gyro and encoder rotations that indicates wheel slip, given in [rad/s]
+const float Controller::SLIP_NOISE = 10.0f;                 // factor of the standard deviation of the translation while the wheels slip
 
 /**
  * Creates and initialises the robot controller.
@@ -32,8 +29,10 @@ const float Controller::SIGMA_GAMMA = 0.02;                 // standard deviatio
  * @param pwmRight a reference to the pwm output for the right motor.
  * @param counterLeft a reference to the encoder counter of the left motor.
  * @param counterRight a reference to the encoder counter of the right motor.
+ * @param imu a reference to the inertial measurement unit with the gyro to fuse the rotation with.
+ * @param poseHistory a reference to a history that the controller stores the recent poses of the robot in.
  */
-Controller::Controller(PwmOut& pwmLeft, PwmOut& pwmRight, EncoderCounter& counterLeft, EncoderCounter& counterRight) : pwmLeft(pwmLeft), pwmRight(pwmRight), counterLeft(counterLeft), counterRight(counterRight), thread(osPriorityHigh, STACK_SIZE) {
+Controller::Controller(PwmOut& pwmLeft, PwmOut& pwmRight, EncoderCounter& counterLeft, EncoderCounter& counterRight, IMU& imu, PoseHistory& poseHistory) : pwmLeft(pwmLeft), pwmRight(pwmRight), counterLeft(counterLeft), counterRight(counterRight), imu(imu), poseHistory(poseHistory), thread(osPriorityHigh, STACK_SIZE) {
     
     // initialise pwm outputs
 
@@ -57,41 +56,75 @@ Controller::Controller(PwmOut& pwmLeft, PwmOut& pwmRight, EncoderCounter& counte
     actualSpeedLeft = 0.0f;
     actualSpeedRight = 0.0f;
 
-    motionLeft.setProfileVelocity(MAXIMUM_VELOCITY);
-    motionLeft.setProfileAcceleration(MAXIMUM_ACCELERATION);
-    motionLeft.setProfileDeceleration(MAXIMUM_ACCELERATION);
+    motion.setProfileVelocity(Profile::MAXIMUM_VELOCITY);
+    motion.setProfileAcceleration(Profile::MAXIMUM_ACCELERATION);
+    motion.setProfileDeceleration(Profile::MAXIMUM_ACCELERATION);
+    motion.setProfileJerk(Profile::MAXIMUM_JERK);
 
-    motionRight.setProfileVelocity(MAXIMUM_VELOCITY);
-    motionRight.setProfileAcceleration(MAXIMUM_ACCELERATION);
-    motionRight.setProfileDeceleration(MAXIMUM_ACCELERATION);
+    previousCountLeft = counterLeft.readCount();
+    previousCountRight = counterRight.readCount();
 
-    previousValueCounterLeft = counterLeft.read();
-    previousValueCounterRight = counterRight.read();
+    velocityLeft.setPeriod(Profile::PERIOD);
+    velocityLeft.reset(previousCountLeft);
 
-    speedLeftFilter.setPeriod(PERIOD);
+    velocityRight.setPeriod(Profile::PERIOD);
+    velocityRight.reset(previousCountRight);
+
+    speedLeftFilter.setPeriod(Profile::PERIOD);
     speedLeftFilter.setFrequency(LOWPASS_FILTER_FREQUENCY);
 
-    speedRightFilter.setPeriod(PERIOD);
+    speedRightFilter.setPeriod(Profile::PERIOD);
     speedRightFilter.setFrequency(LOWPASS_FILTER_FREQUENCY);
 
+    speedControllerLeft.setPeriod(Profile::PERIOD);
+    speedControllerLeft.setGains(Profile::KP, Profile::KI);
+    speedControllerLeft.setModel(Profile::KN, Profile::TIME_CONSTANT);
+    speedControllerLeft.setLimits((MIN_DUTY_CYCLE-0.5f)/Profile::DUTY_CYCLE_PER_VOLTAGE, (MAX_DUTY_CYCLE-0.5f)/Profile::DUTY_CYCLE_PER_VOLTAGE);
+
+    speedControllerRight.setPeriod(Profile::PERIOD);
+    speedControllerRight.setGains(Profile::KP, Profile::KI);
+    speedControllerRight.setModel(Profile::KN, Profile::TIME_CONSTANT);
+    speedControllerRight.setLimits((MIN_DUTY_CYCLE-0.5f)/Profile::DUTY_CYCLE_PER_VOLTAGE, (MAX_DUTY_CYCLE-0.5f)/Profile::DUTY_CYCLE_PER_VOLTAGE);
+
+    identificationRequested = false;
+    identificationVoltage = 0.0f;
+    identificationDuration = 0.0f;
+
+    gyroFusion = false;
+    gyroBias = 0.0f;
+    slipPeriods = 0;
+    slipping = false;
+    
+    // enable the cycle counter of the data watchpoint and trace unit, to measure the duration of the control loop
+    
+    cycles = 0;
+    maximumCycles = 0;
+    
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->LAR = 0xC5ACCE55;                      // unlock the registers of the DWT unit of the Cortex-M7
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
     x = 0.0f;
     y = 0.0f;
     alpha = 0.0f;
+    cosAlpha = 1.0f;
+    sinAlpha = 0.0f;
+    
+    historyCounter = 0;
+    
+    snapshotSequence = 0;
+    correctionHead = 0;
+    correctionTail = 0;
 
-    p[0][0] = 0.001f;
-    p[0][1] = 0.0f;
-    p[0][2] = 0.0f;
-    p[1][0] = 0.0f;
-    p[1][1] = 0.001f;
-    p[1][2] = 0.0f;
-    p[2][0] = 0.0f;
-    p[2][1] = 0.0f;
-    p[2][2] = 0.001f;
+    p = Matrix<3, 3>::identity()*0.001f;
+    
+    publishSnapshot();
     
     // start thread and timer interrupt
 
     thread.start(callback(this, &Controller::run));
-    ticker.attach(callback(this, &Controller::sendThreadFlag), PERIOD);
+    ticker.attach(callback(this, &Controller::sendThreadFlag), Profile::PERIOD);
 }
 
 /**
@@ -138,13 +171,105 @@ float Controller::getActualRotationalVelocity() {
     return actualRotationalVelocity;
 }
 
+/**
+ * Enables or disables the fusion of the rotation measured with the encoders with the gyro.
+ * @param gyroFusion <code>true</code> to fuse the rotation with the gyro, <code>false</code> to use the encoders only.
+ */
+void Controller::setGyroFusion(bool gyroFusion) {
+    
+    this->gyroFusion = gyroFusion;
+}
+
+/**
+ * Tells if the wheels slip, i.e. if the rotations measured with the encoders and with the gyro disagree.
+ * This flag is only set while the rotation is fused with the gyro.
+ */
+bool Controller::isSlipping() {
+    
+    return slipping;
+}
+
+/**
+ * Gets the estimated bias of the gyro.
+ * @return the bias, given in [rad/s].
+ */
+float Controller::getGyroBias() {
+    
+    return gyroBias;
+}
+
+/**
+ * Gets the number of CPU cycles of the latest period of the control loop, measured with
+ * the cycle counter of the DWT unit, from the thread flag to the published pose.
+ * @return the number of cycles, i.e. 216 cycles per microsecond.
+ */
+uint32_t Controller::getCycles() {
+    
+    return cycles;
+}
+
+/**
+ * Gets the maximum number of CPU cycles of a period of the control loop since start up.
+ * @return the maximum number of cycles.
+ */
+uint32_t Controller::getMaximumCycles() {
+    
+    return maximumCycles;
+}
+
+/**
+ * Starts the identification of the models of both motors with a step response.
+ * The same voltage is applied to both motors, so that the robot turns on the spot.
+ * The robot should stand still, when the identification is started. The identified
+ * models are used by the speed controllers from then on.
+ * @param voltage the voltage of the step, given in [V].
+ * @param duration the duration of the step, which should be several time constants, given in [s].
+ */
+void Controller::identifyMotors(float voltage, float duration) {
+    
+    identificationVoltage = voltage;
+    identificationDuration = duration;
+    identificationRequested = true;
+}
+
+/**
+ * Tells if the identification of the motors is requested or still running.
+ */
+bool Controller::isIdentifying() {
+    
+    return identificationRequested || speedControllerLeft.isIdentifying() || speedControllerRight.isIdentifying();
+}
+
+/**
+ * Gets the speed controller of the left motor, for example to read its model
+ * or the statistics of its speed error.
+ * @return a reference to the speed controller.
+ */
+SpeedController& Controller::getSpeedControllerLeft() {
+    
+    return speedControllerLeft;
+}
+
+/**
+ * Gets the speed controller of the right motor, for example to read its model
+ * or the statistics of its speed error.
+ * @return a reference to the speed controller.
+ */
+SpeedController& Controller::getSpeedControllerRight() {
+    
+    return speedControllerRight;
+}
+
 /**
  * Sets the actual x coordinate of the robots position.
  * @param x the x coordinate of the position, given in [m].
  */
 void Controller::setX(float x) {
     
-    this->x = x;
+    PoseSnapshot correction;
+    correction.x = x;
+    
+    queueCorrection(SET_X, correction);
 }
 
 /**
@@ -153,7 +278,7 @@ void Controller::setX(float x) {
  */
 float Controller::getX() {
     
-    return x;
+    return getPoseSnapshot().x;
 }
 
 /**
@@ -162,7 +287,10 @@ float Controller::getX() {
  */
 void Controller::setY(float y) {
     
-    this->y = y;
+    PoseSnapshot correction;
+    correction.y = y;
+    
+    queueCorrection(SET_Y, correction);
 }
 
 /**
@@ -171,7 +299,7 @@ void Controller::setY(float y) {
  */
 float Controller::getY() {
     
-    return y;
+    return getPoseSnapshot().y;
 }
 
 /**
@@ -180,7 +308,10 @@ float Controller::getY() {
  */
 void Controller::setAlpha(float alpha) {
     
-    this->alpha = alpha;
+    PoseSnapshot correction;
+    correction.alpha = alpha;
+    
+    queueCorrection(SET_ALPHA, correction);
 }
 
 /**
@@ -189,7 +320,46 @@ void Controller::setAlpha(float alpha) {
  */
 float Controller::getAlpha() {
     
-    return alpha;
+    return getPoseSnapshot().alpha;
+}
+
+/**
+ * Sets the actual pose of the robot together with its covariance matrix,
+ * for example with the estimate of a global localization.
+ * @param x the x coordinate of the position, given in [m].
+ * @param y the y coordinate of the position, given in [m].
+ * @param alpha the orientation, given in [rad].
+ * @param p the covariance matrix of the pose.
+ */
+void Controller::setPose(float x, float y, float alpha, const Matrix<3, 3>& p) {
+    
+    PoseSnapshot correction;
+    correction.x = x;
+    correction.y = y;
+    correction.alpha = alpha;
+    correction.p = p;
+    
+    queueCorrection(SET_X | SET_Y | SET_ALPHA | SET_COVARIANCE, correction);
+}
+
+/**
+ * Gets a consistent snapshot of the actual pose of the robot and its covariance matrix.
+ * The snapshot is copied again, if the controller published a new snapshot while it was
+ * copied. This method must not be called from a thread with a higher priority than the
+ * controller.
+ * @return a snapshot of the pose, published at the end of the latest period of the controller.
+ */
+PoseSnapshot Controller::getPoseSnapshot() {
+    
+    PoseSnapshot pose;
+    uint32_t sequence = 0;
+    
+    do {
+        sequence = core_util_atomic_load_u32(&snapshotSequence);
+        pose = snapshot;
+    } while ((sequence & 1) || (sequence != core_util_atomic_load_u32(&snapshotSequence)));
+    
+    return pose;
 }
 
 /**
@@ -199,84 +369,278 @@ float Controller::getAlpha() {
  */
 void Controller::correctPoseWithBeacon(Point actualBeacon, Point measuredBeacon) {
     
+    correctPoseWithBeacons(&actualBeacon, &measuredBeacon, 1);
+}
+
+/**
+ * Correct the pose with the actual and measured coordinates of all beacons of a scan.
+ * The beacons are processed as a sequence of extended Kalman filter updates with a
+ * measurement of the distance and the angle to every beacon. The state and the
+ * covariance matrix are copied once, and every update is expressed with the measurement
+ * jacobian H, the innovation covariance S and the Kalman matrix K, so that the terms
+ * shared by these matrices are only calculated once.
+ * <br/>
+ * The update is calculated with a snapshot of the pose, and the resulting change of the
+ * pose and of the covariance matrix is queued to be applied by the controller.
+ * @param actualBeacons an array with the actual (known) coordinates of the beacons.
+ * @param measuredBeacons an array with the coordinates of the beacons measured with a sensor (i.e. a laser scanner).
+ * @param size the number of beacons in both arrays.
+ */
+void Controller::correctPoseWithBeacons(Point actualBeacons[], Point measuredBeacons[], unsigned short size) {
+    
     // create copies of current state and covariance matrix for Kalman filter P
     
-    float x = this->x;
-    float y = this->y;
-    float alpha = this->alpha;
+    PoseSnapshot pose = getPoseSnapshot();
     
-    float p[3][3];
+    float x = pose.x;
+    float y = pose.y;
+    float alpha = pose.alpha;
     
-    for (int i = 0; i < 3; i++) {
-        for (int j = 0; j < 3; j++) {
-            p[i][j] = this->p[i][j];
+    Matrix<3, 3> p = pose.p;
+    
+    for (unsigned short n = 0; n < size; n++) {
+        
+        // calculate estimated and measured distance and angle to this beacon
+        
+        float dx = actualBeacons[n].x-x;
+        float dy = actualBeacons[n].y-y;
+        float rr = dx*dx+dy*dy;
+        
+        if (rr < 1.0e-6f) continue;
+        
+        float r = sqrt(rr);
+        
+        float distanceEstimated = r;
+        float gammaEstimated = atan2(dy, dx)-alpha;
+        
+        float distanceMeasured = sqrt((measuredBeacons[n].x-x)*(measuredBeacons[n].x-x)+(measuredBeacons[n].y-y)*(measuredBeacons[n].y-y));
+        float gammaMeasured = atan2(measuredBeacons[n].y-y, measuredBeacons[n].x-x)-alpha;
+        
+        float innovationDistance = distanceMeasured-distanceEstimated;
+        float innovationGamma = gammaMeasured-gammaEstimated;
+        
+        while (innovationGamma > M_PI) innovationGamma -= 2.0f*M_PI;
+        while (innovationGamma < -M_PI) innovationGamma += 2.0f*M_PI;
+        
+        // calculate measurement jacobian H, the third column of the distance row is 0,
+        // the Kalman filter update is expanded for this structure, because it is faster
+        // than the generic update of the ExtendedKalmanFilter class
+        
+        float h00 = -dx/r;
+        float h01 = -dy/r;
+        float h10 = dy/rr;
+        float h11 = -dx/rr;
+        float h12 = -1.0f;
+        
+        // calculate P*H'
+        
+        float ph[3][2];
+        
+        for (int i = 0; i < 3; i++) {
+            ph[i][0] = p(i, 0)*h00+p(i, 1)*h01;
+            ph[i][1] = p(i, 0)*h10+p(i, 1)*h11+p(i, 2)*h12;
+        }
+        
+        // calculate covariance matrix of innovation S = H*P*H'+R and its inverse
+        
+        float s00 = h00*ph[0][0]+h01*ph[1][0]+SIGMA_DISTANCE*SIGMA_DISTANCE;
+        float s01 = h00*ph[0][1]+h01*ph[1][1];
+        float s11 = h10*ph[0][1]+h11*ph[1][1]+h12*ph[2][1]+SIGMA_GAMMA*SIGMA_GAMMA;
+        
+        float determinant = s00*s11-s01*s01;
+        
+        if (fabs(determinant) < 1.0e-12f) continue;
+        
+        float reciprocal = 1.0f/determinant;
+        
+        float i00 = s11*reciprocal;
+        float i01 = -s01*reciprocal;
+        float i11 = s00*reciprocal;
+        
+        // calculate Kalman matrix K = P*H'*S^-1
+        
+        float k[3][2];
+        
+        for (int i = 0; i < 3; i++) {
+            k[i][0] = ph[i][0]*i00+ph[i][1]*i01;
+            k[i][1] = ph[i][0]*i01+ph[i][1]*i11;
+        }
+        
+        // calculate pose correction
+        
+        x += k[0][0]*innovationDistance+k[0][1]*innovationGamma;
+        y += k[1][0]*innovationDistance+k[1][1]*innovationGamma;
+        alpha += k[2][0]*innovationDistance+k[2][1]*innovationGamma;
+        
+        while (alpha > M_PI) alpha -= 2.0f*M_PI;
+        while (alpha < -M_PI) alpha += 2.0f*M_PI;
+        
+        // calculate correction of covariance matrix P = P-K*H*P, with H*P = (P*H')'
+        
+        for (int i = 0; i < 3; i++) {
+            for (int j = i; j < 3; j++) {
+                p(i, j) -= k[i][0]*ph[j][0]+k[i][1]*ph[j][1];
+                p(j, i) = p(i, j);
+            }
         }
     }
     
-    // calculate covariance matrix of innovation S
+    // queue the change of the pose and of the covariance matrix
     
-    float s[2][2];
-    float r = sqrt((actualBeacon.x-x)*(actualBeacon.x-x)+(actualBeacon.y-y)*(actualBeacon.y-y));
+    PoseSnapshot correction;
     
-    s[0][0] = 1.0f/r/r*(p[1][0]*actualBeacon.x*actualBeacon.y+p[1][1]*actualBeacon.y*actualBeacon.y+r*r*SIGMA_DISTANCE*SIGMA_DISTANCE+p[0][0]*(actualBeacon.x-x)*(actualBeacon.x-x)-p[1][0]*actualBeacon.y*x+p[0][1]*(actualBeacon.x-x)*(actualBeacon.y-y)-p[1][0]*actualBeacon.x*y-2.0f*p[1][1]*actualBeacon.y*y+p[1][0]*x*y+p[1][1]*y*y);
-    s[0][1] = -(1.0f/r/r/r*(-p[1][1]*actualBeacon.x*actualBeacon.y+p[1][0]*actualBeacon.y*actualBeacon.y-p[0][2]*actualBeacon.x*r*r-p[1][2]*actualBeacon.y*r*r-p[0][1]*(actualBeacon.x-x)*(actualBeacon.x-x)+p[1][1]*actualBeacon.y*x+p[0][2]*r*r*x+p[0][0]*(actualBeacon.x-x)*(actualBeacon.y-y)+p[1][1]*actualBeacon.x*y-2.0f*p[1][0]*actualBeacon.y*y+p[1][2]*r*r*y-p[1][1]*x*y+p[1][0]*y*y));
-    s[1][0] = ((actualBeacon.x-x)*(p[2][0]*r*r+p[1][0]*(actualBeacon.x-x)+p[0][0]*(-actualBeacon.y+y))+(actualBeacon.y-y)*(p[2][1]*r*r+p[1][1]*(actualBeacon.x-x)+p[0][1]*(-actualBeacon.y+y)))/r/r/r;
-    s[1][1] = p[2][2]+SIGMA_GAMMA*SIGMA_GAMMA+p[1][2]*(actualBeacon.x-x)/r/r+p[0][2]*(-actualBeacon.y+y)/r/r-(actualBeacon.y-y)*(p[2][0]*r*r+p[1][0]*(actualBeacon.x-x)+p[0][0]*(-actualBeacon.y+y))/r/r/r/r+(actualBeacon.x-x)*(p[2][1]*r*r+p[1][1]*(actualBeacon.x-x)+p[0][1]*(-actualBeacon.y+y))/r/r/r/r;
+    correction.x = x-pose.x;
+    correction.y = y-pose.y;
+    correction.alpha = alpha-pose.alpha;
     
-    // calculate Kalman matrix K
+    while (correction.alpha > M_PI) correction.alpha -= 2.0f*M_PI;
+    while (correction.alpha < -M_PI) correction.alpha += 2.0f*M_PI;
     
-    float k[3][2];
+    correction.p = p-pose.p;
     
-    k[0][0] = -((s[1][0]*(-p[0][2]+(p[0][1]*(-actualBeacon.x+x))/r/r+(p[0][0]*(actualBeacon.y-y))/r/r))/(-(s[0][1]*s[1][0])+s[0][0]*s[1][1]))+(s[1][1]*((p[0][0]*(-actualBeacon.x+x))/r+(p[0][1]*(-actualBeacon.y+y))/r))/(-(s[0][1]*s[1][0])+s[0][0]*s[1][1]);
-    k[0][1] = (s[0][0]*(-p[0][2]+(p[0][1]*(-actualBeacon.x+x))/r/r+(p[0][0]*(actualBeacon.y-y))/r/r))/(-(s[0][1]*s[1][0])+s[0][0]*s[1][1])-(s[0][1]*((p[0][0]*(-actualBeacon.x+x))/r+(p[0][1]*(-actualBeacon.y+y))/r))/(-(s[0][1]*s[1][0])+s[0][0]*s[1][1]);
-    k[1][0] = -((s[1][0]*(-p[1][2]+(p[1][1]*(-actualBeacon.x+x))/r/r+(p[1][0]*(actualBeacon.y-y))/r/r))/(-(s[0][1]*s[1][0])+s[0][0]*s[1][1]))+(s[1][1]*((p[1][0]*(-actualBeacon.x+x))/r+(p[1][1]*(-actualBeacon.y+y))/r))/(-(s[0][1]*s[1][0])+s[0][0]*s[1][1]);
-    k[1][1] = (s[0][0]*(-p[1][2]+(p[1][1]*(-actualBeacon.x+x))/r/r+(p[1][0]*(actualBeacon.y-y))/r/r))/(-(s[0][1]*s[1][0])+s[0][0]*s[1][1])-(s[0][1]*((p[1][0]*(-actualBeacon.x+x))/r+(p[1][1]*(-actualBeacon.y+y))/r))/(-(s[0][1]*s[1][0])+s[0][0]*s[1][1]);
-    k[2][0] = -((s[1][0]*(-p[2][2]+(p[2][1]*(-actualBeacon.x+x))/r/r+(p[2][0]*(actualBeacon.y-y))/r/r))/(-(s[0][1]*s[1][0])+s[0][0]*s[1][1]))+(s[1][1]*((p[2][0]*(-actualBeacon.x+x))/r+(p[2][1]*(-actualBeacon.y+y))/r))/(-(s[0][1]*s[1][0])+s[0][0]*s[1][1]);
-    k[2][1] = (s[0][0]*(-p[2][2]+(p[2][1]*(-actualBeacon.x+x))/r/r+(p[2][0]*(actualBeacon.y-y))/r/r))/(-(s[0][1]*s[1][0])+s[0][0]*s[1][1])-(s[0][1]*((p[2][0]*(-actualBeacon.x+x))/r+(p[2][1]*(-actualBeacon.y+y))/r))/(-(s[0][1]*s[1][0])+s[0][0]*s[1][1]);
+    queueCorrection(ADD_DELTA, correction);
+}
+
+/**
+ * Correct the pose with a measurement of the full pose, for example with the pose of a scan
+ * that was aligned with a map. The measurement is processed as a Kalman filter update with
+ * the identity as measurement jacobian, and the resulting change of the pose and of the
+ * covariance matrix is queued to be applied by the controller.
+ * @param x the measured x coordinate of the position, given in [m].
+ * @param y the measured y coordinate of the position, given in [m].
+ * @param alpha the measured orientation, given in [rad].
+ * @param r the covariance matrix of the measurement noise.
+ */
+void Controller::correctPose(float x, float y, float alpha, const Matrix<3, 3>& r) {
+    
+    // create a Kalman filter with copies of current state and covariance matrix P
+    
+    PoseSnapshot pose = getPoseSnapshot();
+    
+    ExtendedKalmanFilter<3, 3> filter;
+    
+    filter.x(0, 0) = pose.x;
+    filter.x(1, 0) = pose.y;
+    filter.x(2, 0) = pose.alpha;
+    filter.p = pose.p;
+    
+    Matrix<3, 1> innovation;
+    
+    innovation(0, 0) = x-pose.x;
+    innovation(1, 0) = y-pose.y;
+    innovation(2, 0) = alpha-pose.alpha;
+    
+    while (innovation(2, 0) > M_PI) innovation(2, 0) -= 2.0f*M_PI;
+    while (innovation(2, 0) < -M_PI) innovation(2, 0) += 2.0f*M_PI;
+    
+    if (!filter.update(innovation, Matrix<3, 3>::identity(), r)) return;
+    
+    // queue the change of the pose and of the covariance matrix
     
-    // calculate pose correction
+    PoseSnapshot correction;
     
-    float distanceMeasured = sqrt((measuredBeacon.x-x)*(measuredBeacon.x-x)+(measuredBeacon.y-y)*(measuredBeacon.y-y));
-    float gammaMeasured = atan2(measuredBeacon.y-y, measuredBeacon.x-x)-alpha;
+    correction.x = filter.x(0, 0)-pose.x;
+    correction.y = filter.x(1, 0)-pose.y;
+    correction.alpha = filter.x(2, 0)-pose.alpha;
     
-    if (gammaMeasured > M_PI) gammaMeasured -= 2.0f*M_PI;
-    else if (gammaMeasured < -M_PI) gammaMeasured += 2.0f*M_PI;
+    while (correction.alpha > M_PI) correction.alpha -= 2.0f*M_PI;
+    while (correction.alpha < -M_PI) correction.alpha += 2.0f*M_PI;
     
-    float distanceEstimated = sqrt((actualBeacon.x-x)*(actualBeacon.x-x)+(actualBeacon.y-y)*(actualBeacon.y-y));
-    float gammaEstimated = atan2(actualBeacon.y-y, actualBeacon.x-x)-alpha;
+    correction.p = filter.p-pose.p;
     
-    if (gammaEstimated > M_PI) gammaEstimated -= 2.0f*M_PI;
-    else if (gammaEstimated < -M_PI) gammaEstimated += 2.0f*M_PI;
+    queueCorrection(ADD_DELTA, correction);
+}
+
+/**
+ * Queues a correction of the pose, to be applied by the controller at the beginning of its next period.
+ * If the queue is full, this method waits until the controller applied a correction.
+ * @param type the type of the correction, i.e. a combination of SET_X, SET_Y, SET_ALPHA and SET_COVARIANCE, or ADD_DELTA.
+ * @param correction the new values or the changes of the pose and covariance matrix.
+ */
+void Controller::queueCorrection(int type, PoseSnapshot& correction) {
     
-    x += k[0][0]*(distanceMeasured-distanceEstimated)+k[0][1]*(gammaMeasured-gammaEstimated);
-    y += k[1][0]*(distanceMeasured-distanceEstimated)+k[1][1]*(gammaMeasured-gammaEstimated);
-    alpha += k[2][0]*(distanceMeasured-distanceEstimated)+k[2][1]*(gammaMeasured-gammaEstimated);
+    correctionMutex.lock();
     
-    this->x = x;
-    this->y = y;
-    this->alpha = alpha;
+    while (core_util_atomic_load_u32(&correctionHead)-core_util_atomic_load_u32(&correctionTail) >= CORRECTIONS) {
+        ThisThread::sleep_for(1ms);
+    }
     
-    // calculate correction of covariance matrix for Kalman filter P
+    uint32_t head = correctionHead;
     
-    p[0][0] = k[0][1]*p[2][0]+p[0][0]*(1-(k[0][0]*(-actualBeacon.x+x))/r-(k[0][1]*(actualBeacon.y-y))/r/r)+p[1][0]*(-((k[0][1]*(-actualBeacon.x+x))/r/r)-(k[0][0]*(-actualBeacon.y+y))/r);
-    p[0][1] = k[0][1]*p[2][1]+p[0][1]*(1-(k[0][0]*(-actualBeacon.x+x))/r-(k[0][1]*(actualBeacon.y-y))/r/r)+p[1][1]*(-((k[0][1]*(-actualBeacon.x+x))/r/r)-(k[0][0]*(-actualBeacon.y+y))/r);
-    p[0][2] = k[0][1]*p[2][2]+p[0][2]*(1-(k[0][0]*(-actualBeacon.x+x))/r-(k[0][1]*(actualBeacon.y-y))/r/r)+p[1][2]*(-((k[0][1]*(-actualBeacon.x+x))/r/r)-(k[0][0]*(-actualBeacon.y+y))/r);
+    corrections[head%CORRECTIONS] = correction;
+    correctionTypes[head%CORRECTIONS] = type;
     
-    p[1][0] = k[1][1]*p[2][0]+p[0][0]*(-((k[1][0]*(-actualBeacon.x+x))/r)-(k[1][1]*(actualBeacon.y-y))/r/r)+p[1][0]*(1-(k[1][1]*(-actualBeacon.x+x))/r/r-(k[1][0]*(-actualBeacon.y+y))/r);
-    p[1][1] = k[1][1]*p[2][1]+p[0][1]*(-((k[1][0]*(-actualBeacon.x+x))/r)-(k[1][1]*(actualBeacon.y-y))/r/r)+p[1][1]*(1-(k[1][1]*(-actualBeacon.x+x))/r/r-(k[1][0]*(-actualBeacon.y+y))/r);
-    p[1][2] = k[1][1]*p[2][2]+p[0][2]*(-((k[1][0]*(-actualBeacon.x+x))/r)-(k[1][1]*(actualBeacon.y-y))/r/r)+p[1][2]*(1-(k[1][1]*(-actualBeacon.x+x))/r/r-(k[1][0]*(-actualBeacon.y+y))/r);
+    core_util_atomic_store_u32(&correctionHead, head+1);
     
-    p[2][0] = (1+k[2][1])*p[2][0]+p[0][0]*(-((k[2][0]*(-actualBeacon.x+x))/r)-(k[2][1]*(actualBeacon.y-y))/r/r)+p[1][0]*(-((k[2][1]*(-actualBeacon.x+x))/r/r)-(k[2][0]*(-actualBeacon.y+y))/r);
-    p[2][1] = (1+k[2][1])*p[2][1]+p[0][1]*(-((k[2][0]*(-actualBeacon.x+x))/r)-(k[2][1]*(actualBeacon.y-y))/r/r)+p[1][1]*(-((k[2][1]*(-actualBeacon.x+x))/r/r)-(k[2][0]*(-actualBeacon.y+y))/r);
-    p[2][2] = (1+k[2][1])*p[2][2]+p[0][2]*(-((k[2][0]*(-actualBeacon.x+x))/r)-(k[2][1]*(actualBeacon.y-y))/r/r)+p[1][2]*(-((k[2][1]*(-actualBeacon.x+x))/r/r)-(k[2][0]*(-actualBeacon.y+y))/r);
+    correctionMutex.unlock();
+}
+
+/**
+ * Applies all queued corrections of the pose.
+ * This method is called by the thread of the controller only.
+ */
+void Controller::applyCorrections() {
     
-    for (int i = 0; i < 3; i++) {
-        for (int j = 0; j < 3; j++) {
-            this->p[i][j] = p[i][j];
+    uint32_t head = core_util_atomic_load_u32(&correctionHead);
+    uint32_t tail = correctionTail;
+    
+    while (tail != head) {
+        
+        PoseSnapshot& correction = corrections[tail%CORRECTIONS];
+        int type = correctionTypes[tail%CORRECTIONS];
+        
+        if (type == ADD_DELTA) {
+            
+            x += correction.x;
+            y += correction.y;
+            alpha += correction.alpha;
+            
+            while (alpha > M_PI) alpha -= 2.0f*M_PI;
+            while (alpha < -M_PI) alpha += 2.0f*M_PI;
+            
+            p += correction.p;
+            
+        } else {
+            
+            if (type & SET_X) x = correction.x;
+            if (type & SET_Y) y = correction.y;
+            if (type & SET_ALPHA) alpha = correction.alpha;
+            if (type & SET_COVARIANCE) p = correction.p;
         }
+        
+        tail++;
+        core_util_atomic_store_u32(&correctionTail, tail);
+        
+        // the orientation was changed, recalculate its sine and cosine
+        
+        cosAlpha = cos(alpha);
+        sinAlpha = sin(alpha);
     }
 }
 
+/**
+ * Publishes a snapshot of the actual pose and covariance matrix for other threads.
+ * This method is called by the thread of the controller only.
+ */
+void Controller::publishSnapshot() {
+    
+    uint32_t sequence = snapshotSequence;
+    
+    core_util_atomic_store_u32(&snapshotSequence, sequence+1);
+    
+    snapshot.x = x;
+    snapshot.y = y;
+    snapshot.alpha = alpha;
+    snapshot.cosAlpha = cosAlpha;
+    snapshot.sinAlpha = sinAlpha;
+    
+    snapshot.p = p;
+    
+    snapshot.time = us_ticker_read();
+    
+    core_util_atomic_store_u32(&snapshotSequence, sequence+2);
+}
+
 /**
  * This method is called by the ticker timer interrupt service routine.
  * It sends a flag to the thread to make it run again.
@@ -297,65 +661,174 @@ void Controller::run() {
         
         ThisThread::flags_wait_any(threadFlag);
         
+        uint32_t startCycles = DWT->CYCCNT;
+        
+        // apply the corrections of the pose that were queued by other threads
+        
+        applyCorrections();
+        
         // calculate the values 'desiredSpeedLeft' and 'desiredSpeedRight' using the kinematic model
         
-        desiredSpeedLeft = (translationalVelocity-WHEEL_DISTANCE/2.0f*rotationalVelocity)/WHEEL_RADIUS*60.0f/2.0f/M_PI;
-        desiredSpeedRight = -(translationalVelocity+WHEEL_DISTANCE/2.0f*rotationalVelocity)/WHEEL_RADIUS*60.0f/2.0f/M_PI;
+        desiredSpeedLeft = (translationalVelocity-Profile::HALF_WHEEL_DISTANCE*rotationalVelocity)*Profile::RPM_PER_VELOCITY;
+        desiredSpeedRight = -(translationalVelocity+Profile::HALF_WHEEL_DISTANCE*rotationalVelocity)*Profile::RPM_PER_VELOCITY;
+        
+        // calculate planned speedLeft and speedRight values and accelerations jointly using the motion planner
         
-        // calculate planned speedLeft and speedRight values using the motion planner
+        motion.incrementToVelocity(desiredSpeedLeft, desiredSpeedRight, Profile::PERIOD);
         
-        motionLeft.incrementToVelocity(desiredSpeedLeft, PERIOD);
-        motionRight.incrementToVelocity(desiredSpeedRight, PERIOD);
+        desiredSpeedLeft = motion.getVelocityLeft();
+        desiredSpeedRight = motion.getVelocityRight();
         
-        desiredSpeedLeft = motionLeft.getVelocity();
-        desiredSpeedRight = motionRight.getVelocity();
+        float desiredAccelerationLeft = motion.getAccelerationLeft();
+        float desiredAccelerationRight = motion.getAccelerationRight();
         
         // calculate the actual speed of the motors in [rpm]
 
-        short valueCounterLeft = counterLeft.read();
-        short valueCounterRight = counterRight.read();
+        int64_t countLeft = counterLeft.readCount();
+        int64_t countRight = counterRight.readCount();
 
-        short countsInPastPeriodLeft = valueCounterLeft-previousValueCounterLeft;
-        short countsInPastPeriodRight = valueCounterRight-previousValueCounterRight;
+        int countsInPastPeriodLeft = static_cast<int>(countLeft-previousCountLeft);
+        int countsInPastPeriodRight = static_cast<int>(countRight-previousCountRight);
 
-        previousValueCounterLeft = valueCounterLeft;
-        previousValueCounterRight = valueCounterRight;
+        previousCountLeft = countLeft;
+        previousCountRight = countRight;
 
-        actualSpeedLeft = speedLeftFilter.filter((float)countsInPastPeriodLeft/COUNTS_PER_TURN/PERIOD*60.0f);
-        actualSpeedRight = speedRightFilter.filter((float)countsInPastPeriodRight/COUNTS_PER_TURN/PERIOD*60.0f);
+        actualSpeedLeft = speedLeftFilter.filter(velocityLeft.update(countLeft)*Profile::RPM_PER_COUNT_RATE);
+        actualSpeedRight = speedRightFilter.filter(velocityRight.update(countRight)*Profile::RPM_PER_COUNT_RATE);
 
-        // calculate desired motor voltages Uout
+        // start a requested identification of the motors
 
-        float voltageLeft = KP*(desiredSpeedLeft-actualSpeedLeft)+desiredSpeedLeft/KN;
-        float voltageRight = KP*(desiredSpeedRight-actualSpeedRight)+desiredSpeedRight/KN;
+        if (identificationRequested) {
+            speedControllerLeft.startIdentification(identificationVoltage, identificationDuration);
+            speedControllerRight.startIdentification(identificationVoltage, identificationDuration);
+            identificationRequested = false;
+        }
+
+        // calculate desired motor voltages Uout with the speed controllers
+
+        float voltageLeft = speedControllerLeft.control(desiredSpeedLeft, desiredAccelerationLeft, actualSpeedLeft);
+        float voltageRight = speedControllerRight.control(desiredSpeedRight, desiredAccelerationRight, actualSpeedRight);
 
         // calculate, limit and set the duty-cycle
 
-        float dutyCycleLeft = 0.5f+0.5f*voltageLeft/MAX_VOLTAGE;
+        float dutyCycleLeft = 0.5f+voltageLeft*Profile::DUTY_CYCLE_PER_VOLTAGE;
         if (dutyCycleLeft < MIN_DUTY_CYCLE) dutyCycleLeft = MIN_DUTY_CYCLE;
         else if (dutyCycleLeft > MAX_DUTY_CYCLE) dutyCycleLeft = MAX_DUTY_CYCLE;
         pwmLeft = dutyCycleLeft;
 
-        float dutyCycleRight = 0.5f+0.5f*voltageRight/MAX_VOLTAGE;
+        float dutyCycleRight = 0.5f+voltageRight*Profile::DUTY_CYCLE_PER_VOLTAGE;
         if (dutyCycleRight < MIN_DUTY_CYCLE) dutyCycleRight = MIN_DUTY_CYCLE;
         else if (dutyCycleRight > MAX_DUTY_CYCLE) dutyCycleRight = MAX_DUTY_CYCLE;
         pwmRight = dutyCycleRight;
 
         // calculate the values 'actualTranslationalVelocity' and 'actualRotationalVelocity' using the kinematic model
 
-        actualTranslationalVelocity = (actualSpeedLeft-actualSpeedRight)*2.0f*M_PI/60.0f*WHEEL_RADIUS/2.0f;
-        actualRotationalVelocity = (-actualSpeedRight-actualSpeedLeft)*2.0f*M_PI/60.0f*WHEEL_RADIUS/WHEEL_DISTANCE;
+        actualTranslationalVelocity = (actualSpeedLeft-actualSpeedRight)*Profile::TRANSLATION_PER_RPM;
+        actualRotationalVelocity = (-actualSpeedRight-actualSpeedLeft)*Profile::ROTATION_PER_RPM;
         
-        // calculate the actual robot pose
+        // fuse the rotational velocity of the encoders with the gyro, and detect wheel slip
         
-        float deltaTranslation = actualTranslationalVelocity*PERIOD;
-        float deltaOrientation = actualRotationalVelocity*PERIOD;
+        float fusedRotationalVelocity = actualRotationalVelocity;
+        float varianceTranslation = SIGMA_TRANSLATION*SIGMA_TRANSLATION;
+        float varianceOrientation = SIGMA_ORIENTATION*SIGMA_ORIENTATION;
         
-        float sinAlpha = sin(alpha+deltaOrientation);
-        float cosAlpha = cos(alpha+deltaOrientation);
-
-        x += cosAlpha*deltaTranslation;
-        y += sinAlpha*deltaTranslation;
+        if (gyroFusion) {
+            
+            float gyroRotationalVelocity = imu.getGyroZ()-gyroBias;
+            float difference = gyroRotationalVelocity-actualRotationalVelocity;
+            
+            if (fabs(difference) > SLIP_THRESHOLD) {
+                if (slipPeriods < SLIP_PERIODS) slipPeriods++;
+            } else {
+                slipPeriods = 0;
+            }
+            
+            slipping = (slipPeriods >= SLIP_PERIODS);
+            
+            float varianceGyro = SIGMA_GYRO*Profile::PERIOD*SIGMA_GYRO*Profile::PERIOD;
+            
+            if (slipping) {
+                
+                // the encoders are not reliable, take the rotation from the gyro only
+                
+                fusedRotationalVelocity = gyroRotationalVelocity;
+                varianceTranslation *= SLIP_NOISE*SLIP_NOISE;
+                varianceOrientation = varianceGyro;
+                
+            } else {
+                
+                // estimate the bias from the remaining difference, faster while the robot stands still,
+                // and weight both rotations with their variances
+                
+                bool stationary = (desiredSpeedLeft == 0.0f) && (desiredSpeedRight == 0.0f) && (countsInPastPeriodLeft == 0) && (countsInPastPeriodRight == 0);
+                
+                gyroBias += (stationary ? STATIONARY_BIAS_GAIN : BIAS_GAIN)*difference;
+                
+                float gain = varianceOrientation/(varianceOrientation+varianceGyro);
+                
+                fusedRotationalVelocity += gain*difference;
+                varianceOrientation *= 1.0f-gain;
+            }
+            
+        } else {
+            
+            slipPeriods = 0;
+            slipping = false;
+        }
+        
+        // calculate the actual robot pose, moving along a circular arc during this period
+        
+        float deltaTranslation = actualTranslationalVelocity*Profile::PERIOD;
+        float deltaOrientation = fusedRotationalVelocity*Profile::PERIOD;
+        
+        // sine and cosine of the rotation, the chord of the arc in robot coordinates, given by
+        // a = sin(delta)/delta and b = (1-cos(delta))/delta, and the derivatives of a and b
+        
+        float sinDelta, cosDelta, a, b, derivativeA, derivativeB;
+        
+        float delta2 = deltaOrientation*deltaOrientation;
+        
+        if (fabs(deltaOrientation) < SMALL_ANGLE) {
+            
+            sinDelta = deltaOrientation*(1.0f-delta2/6.0f*(1.0f-delta2/20.0f));
+            cosDelta = 1.0f-delta2/2.0f*(1.0f-delta2/12.0f);
+            a = 1.0f-delta2/6.0f*(1.0f-delta2/20.0f);
+            b = deltaOrientation/2.0f*(1.0f-delta2/12.0f);
+            derivativeA = -deltaOrientation/3.0f*(1.0f-delta2/10.0f);
+            derivativeB = 0.5f-delta2/8.0f;
+            
+        } else {
+            
+            sinDelta = sin(deltaOrientation);
+            cosDelta = cos(deltaOrientation);
+            a = sinDelta/deltaOrientation;
+            b = (1.0f-cosDelta)/deltaOrientation;
+            derivativeA = (cosDelta-a)/deltaOrientation;
+            derivativeB = (sinDelta-b)/deltaOrientation;
+        }
+        
+        float deltaX = deltaTranslation*(cosAlpha*a-sinAlpha*b);
+        float deltaY = deltaTranslation*(sinAlpha*a+cosAlpha*b);
+        
+        // jacobian G of the pose with respect to the translation and the rotation of this period,
+        // the third row of G is (0, 1)
+        
+        float g00 = cosAlpha*a-sinAlpha*b;
+        float g01 = deltaTranslation*(cosAlpha*derivativeA-sinAlpha*derivativeB);
+        float g10 = sinAlpha*a+cosAlpha*b;
+        float g11 = deltaTranslation*(sinAlpha*derivativeA+cosAlpha*derivativeB);
+        
+        x += deltaX;
+        y += deltaY;
+        
+        // rotate the sine and cosine of the orientation, and correct their norm with a newton step
+        
+        float cosAlphaNew = cosAlpha*cosDelta-sinAlpha*sinDelta;
+        float sinAlphaNew = sinAlpha*cosDelta+cosAlpha*sinDelta;
+        float norm = 1.5f-0.5f*(cosAlphaNew*cosAlphaNew+sinAlphaNew*sinAlphaNew);
+        
+        cosAlpha = cosAlphaNew*norm;
+        sinAlpha = sinAlphaNew*norm;
         
         float alpha = this->alpha+deltaOrientation;
         
@@ -364,18 +837,44 @@ void Controller::run() {
         
         this->alpha = alpha;
         
-        // calculate covariance matrix for Kalman filter P
+        // store the actual pose in the pose history
+        
+        if (++historyCounter >= HISTORY_DIVIDER) {
+            poseHistory.add(us_ticker_read(), x, y, alpha);
+            historyCounter = 0;
+        }
+        
+        // calculate covariance matrix for Kalman filter P = F*P*F'+G*Q*G', expanded for the
+        // symmetric matrix P, the jacobian F = [1 0 -deltaY; 0 1 deltaX; 0 0 1] and Q = diag(q0, q1)
+        
+        float p00 = p(0, 0);
+        float p01 = p(0, 1);
+        float p02 = p(0, 2);
+        float p11 = p(1, 1);
+        float p12 = p(1, 2);
+        float p22 = p(2, 2);
+        
+        float q0 = varianceTranslation;
+        float q1 = varianceOrientation;
+        
+        p(0, 0) = p00-deltaY*(2.0f*p02-deltaY*p22)+q0*g00*g00+q1*g01*g01;
+        p(0, 1) = p01-deltaY*p12+deltaX*(p02-deltaY*p22)+q0*g00*g10+q1*g01*g11;
+        p(0, 2) = p02-deltaY*p22+q1*g01;
+        p(1, 1) = p11+deltaX*(2.0f*p12+deltaX*p22)+q0*g10*g10+q1*g11*g11;
+        p(1, 2) = p12+deltaX*p22+q1*g11;
+        p(2, 2) = p22+q1;
+        
+        p(1, 0) = p(0, 1);
+        p(2, 0) = p(0, 2);
+        p(2, 1) = p(1, 2);
+        
+        // publish the actual pose for other threads
         
-        p[0][0] = p[0][0]+SIGMA_TRANSLATION*SIGMA_TRANSLATION*cosAlpha*cosAlpha+deltaTranslation*deltaTranslation*(SIGMA_ORIENTATION*SIGMA_ORIENTATION+p[2][2])*sinAlpha*sinAlpha-deltaTranslation*(p[0][2]+p[2][0])*sinAlpha;
-        p[0][1] = p[0][1]-deltaTranslation*p[2][1]*sinAlpha+cosAlpha*(deltaTranslation*p[0][2]+(SIGMA_TRANSLATION*SIGMA_TRANSLATION-deltaTranslation*deltaTranslation*(SIGMA_ORIENTATION*SIGMA_ORIENTATION+p[2][2]))*sinAlpha);
-        p[0][2] = p[0][2]-deltaTranslation*(SIGMA_ORIENTATION*SIGMA_ORIENTATION+p[2][2])*sinAlpha;
+        publishSnapshot();
         
-        p[1][0] = p[1][0]-deltaTranslation*p[1][2]*sinAlpha+cosAlpha*(deltaTranslation*p[2][0]+(SIGMA_TRANSLATION*SIGMA_TRANSLATION-deltaTranslation*deltaTranslation*(SIGMA_ORIENTATION*SIGMA_ORIENTATION+p[2][2]))*sinAlpha);
-        p[1][1] = p[1][1]+deltaTranslation*deltaTranslation*(SIGMA_ORIENTATION*SIGMA_ORIENTATION+p[2][2])*cosAlpha*cosAlpha+deltaTranslation*(p[1][2]+p[2][1])*cosAlpha+SIGMA_TRANSLATION*SIGMA_TRANSLATION*sinAlpha*sinAlpha;
-        p[1][2] = p[1][2]+deltaTranslation*(SIGMA_ORIENTATION*SIGMA_ORIENTATION+p[2][2])*cosAlpha;
+        // measure the duration of this period with the cycle counter
         
-        p[2][0] = p[2][0]-deltaTranslation*(SIGMA_ORIENTATION*SIGMA_ORIENTATION+p[2][2])*sinAlpha;
-        p[2][1] = p[2][1]+deltaTranslation*(SIGMA_ORIENTATION*SIGMA_ORIENTATION+p[2][2])*cosAlpha;
-        p[2][2] = p[2][2]+SIGMA_ORIENTATION*SIGMA_ORIENTATION;
+        cycles = DWT->CYCCNT-startCycles;
+        if (cycles > maximumCycles) maximumCycles = cycles;
     }
 }
@@ -10,59 +10,106 @@
 #include <cstdlib>
 #include <mbed.h>
 #include "EncoderCounter.h"
-#include "Motion.h"
+#include "IMU.h"
+#include "DifferentialMotion.h"
 #include "Point.h"
+#include "RobotProfile.h"
 #include "LowpassFilter.h"
+#include "VelocityEstimator.h"
+#include "SpeedController.h"
+#include "PoseHistory.h"
+#include "PoseSnapshot.h"
+#include "Matrix.h"
+#include "ExtendedKalmanFilter.h"
 #include "ThreadFlag.h"
 
 /**
  * This class implements a controller that regulates the
  * speed of the two motors of the ROME2 mobile robot.
+ * <br/>
+ * The pose of the robot is only written by the thread of this controller.
+ * Other threads read a consistent snapshot of the pose, which is published
+ * with a sequence counter at the end of every period. Corrections of the pose
+ * are queued by other threads and applied by the thread of this controller at
+ * the beginning of its next period. The recent poses are added to a pose history,
+ * which is also written with a sequence counter, so the controller never needs a mutex.
+ * <br/>
+ * Optionally, the rotation measured with the encoders is fused with the gyro of the
+ * inertial measurement unit, whose bias is estimated online. When the rotations of the
+ * encoders and of the gyro disagree for a number of periods, the wheels are assumed to
+ * slip, and the rotation is taken from the gyro only.
+ * <br/>
+ * The speed of each motor is regulated by a PI controller with feedforward of the speed
+ * and acceleration planned by the motion planner. The model of the motors can be identified
+ * with a step response, while the robot turns on the spot.
  */
 class Controller {
     
     public:
         
-                Controller(PwmOut& pwmLeft, PwmOut& pwmRight, EncoderCounter& counterLeft, EncoderCounter& counterRight);
-        virtual ~Controller();
-        void    setTranslationalVelocity(float velocity);
-        void    setRotationalVelocity(float velocity);
-        float   getActualTranslationalVelocity();
-        float   getActualRotationalVelocity();
-        void    setX(float x);
-        float   getX();
-        void    setY(float y);
-        float   getY();
-        void    setAlpha(float alpha);
-        float   getAlpha();
-        void    correctPoseWithBeacon(Point actualBeacon, Point measuredBeacon);
+                        Controller(PwmOut& pwmLeft, PwmOut& pwmRight, EncoderCounter& counterLeft, EncoderCounter& counterRight, IMU& imu, PoseHistory& poseHistory);
+        virtual         ~Controller();
+        void            setTranslationalVelocity(float velocity);
+        void            setRotationalVelocity(float velocity);
+        float           getActualTranslationalVelocity();
+        float           getActualRotationalVelocity();
+        void            setGyroFusion(bool gyroFusion);
+        bool            isSlipping();
+        float           getGyroBias();
+        uint32_t        getCycles();
+        uint32_t        getMaximumCycles();
+        void            identifyMotors(float voltage, float duration);
+        bool            isIdentifying();
+        SpeedController& getSpeedControllerLeft();
+        SpeedController& getSpeedControllerRight();
+        void            setX(float x);
+        float           getX();
+        void            setY(float y);
+        float           getY();
+        void            setAlpha(float alpha);
+        float           getAlpha();
+        void            setPose(float x, float y, float alpha, const Matrix<3, 3>& p);
+        PoseSnapshot    getPoseSnapshot();
+        void            correctPoseWithBeacon(Point actualBeacon, Point measuredBeacon);
+        void            correctPoseWithBeacons(Point actualBeacons[], Point measuredBeacons[], unsigned short size);
+        void            correctPose(float x, float y, float alpha, const Matrix<3, 3>& r);
         
     private:
         
+        typedef DefaultRobotProfile Profile;            // motors, geometry and period of the robot
+        
         static const unsigned int   STACK_SIZE = 4096;  // stack size of thread, given in [bytes]
-        static const float          PERIOD;             // period of control task, given in [s]
+        static const unsigned short HISTORY_DIVIDER = 5;    // number of periods between two poses stored in the pose history
+        static const unsigned short CORRECTIONS = 8;        // capacity of the queue of pose corrections
+        static const unsigned short SLIP_PERIODS = 10;      // number of periods with diverging rotations until wheel slip is detected
+        static const int            SET_X = 1;              // correction type that sets the x coordinate
+        static const int            SET_Y = 2;              // correction type that sets the y coordinate
+        static const int            SET_ALPHA = 4;          // correction type that sets the orientation
+        static const int            ADD_DELTA = 8;          // correction type that adds a delta to the pose and covariance matrix
+        static const int            SET_COVARIANCE = 16;    // correction type that sets the covariance matrix
         
         static const float  M_PI;                       // the mathematical constant PI
-        static const float  WHEEL_DISTANCE;             // distance between wheels, given in [m]
-        static const float  WHEEL_RADIUS;               // radius of wheels, given in [m]
-        static const float  MAXIMUM_VELOCITY;           // maximum wheel velocity, given in [rpm]
-        static const float  MAXIMUM_ACCELERATION;       // maximum wheel acceleration, given in [rpm/s]
-        static const float  COUNTS_PER_TURN;            // encoder resolution
         static const float  LOWPASS_FILTER_FREQUENCY;   // given in [rad/s]
-        static const float  KN;                         // speed constant in [rpm/V]
-        static const float  KP;                         // speed controller gain in [V/rpm]
-        static const float  MAX_VOLTAGE;                // battery voltage in [V]
         static const float  MIN_DUTY_CYCLE;             // minimum duty-cycle
         static const float  MAX_DUTY_CYCLE;             // maximum duty-cycle
         static const float  SIGMA_TRANSLATION;          // standard deviation of estimated translation per period, given in [m]
         static const float  SIGMA_ORIENTATION;          // standard deviation of estimated orientation per period, given in [rad]
         static const float  SIGMA_DISTANCE;             // standard deviation of distance measurement, given in [m]
         static const float  SIGMA_GAMMA;                // standard deviation of angle measurement, given in [rad]
+        static const float  SMALL_ANGLE;                // rotation per period below which the arc is integrated with series, given in [rad]
+        static const float  SIGMA_GYRO;                 // standard deviation of gyro measurement, given in [rad/s]
+        static const float  BIAS_GAIN;                  // gain of the estimation of the gyro bias per period
+        static const float  STATIONARY_BIAS_GAIN;       // gain of the estimation of the gyro bias per period while the robot stands still
+        static const float  SLIP_THRESHOLD;             // difference of gyro and encoder rotations that indicates wheel slip, given in [rad/s]
+        static const float  SLIP_NOISE;                 // factor of the standard deviation of the translation while the wheels slip
 
         PwmOut&             pwmLeft;
         PwmOut&             pwmRight;
         EncoderCounter&     counterLeft;
         EncoderCounter&     counterRight;
+        IMU&                imu;
+        PoseHistory&        poseHistory;
+        unsigned short      historyCounter;
         float               translationalVelocity;
         float               rotationalVelocity;
         float               actualTranslationalVelocity;
@@ -71,20 +118,44 @@ class Controller {
         float               desiredSpeedRight;
         float               actualSpeedLeft;
         float               actualSpeedRight;
-        Motion              motionLeft;
-        Motion              motionRight;
-        short               previousValueCounterLeft;
-        short               previousValueCounterRight;
+        DifferentialMotion  motion;                     // joint motion planner of the speeds of both wheels
+        int64_t             previousCountLeft;
+        int64_t             previousCountRight;
+        VelocityEstimator   velocityLeft;
+        VelocityEstimator   velocityRight;
         LowpassFilter       speedLeftFilter;
         LowpassFilter       speedRightFilter;
+        SpeedController     speedControllerLeft;
+        SpeedController     speedControllerRight;
+        volatile bool       identificationRequested;    // flag that the identification of the motors is requested
+        float               identificationVoltage;      // voltage of the step of the identification, given in [V]
+        float               identificationDuration;     // duration of the step of the identification, given in [s]
+        volatile bool       gyroFusion;                 // flag that the rotation is fused with the gyro
+        float               gyroBias;                   // estimated bias of the gyro, given in [rad/s]
+        unsigned short      slipPeriods;                // number of consecutive periods with diverging rotations
+        volatile bool       slipping;                   // flag that the wheels slip
+        volatile uint32_t   cycles;                     // number of CPU cycles of the latest period of the control loop
+        volatile uint32_t   maximumCycles;              // maximum number of CPU cycles of a period of the control loop
         float               x;
         float               y;
         float               alpha;
-        float               p[3][3];
+        float               cosAlpha;                   // cosine of the orientation, updated incrementally
+        float               sinAlpha;                   // sine of the orientation, updated incrementally
+        Matrix<3, 3>        p;
+        PoseSnapshot        snapshot;                   // latest published pose, consistent while the sequence counter is even
+        volatile uint32_t   snapshotSequence;           // sequence counter, odd while the snapshot is written
+        PoseSnapshot        corrections[CORRECTIONS];   // ring buffer of queued pose corrections
+        int                 correctionTypes[CORRECTIONS];
+        volatile uint32_t   correctionHead;             // number of queued corrections
+        volatile uint32_t   correctionTail;             // number of applied corrections
+        Mutex               correctionMutex;            // mutex to lock the queue against other producers, not used by the controller
         ThreadFlag          threadFlag;
         Thread              thread;
         Ticker              ticker;
         
+        void    queueCorrection(int type, PoseSnapshot& correction);
+        void    applyCorrections();
+        void    publishSnapshot();
         void    sendThreadFlag();
         void    run();
 };
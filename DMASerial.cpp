@@ -0,0 +1,165 @@
+/*
+ * DMASerial.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include "DMASerial.h"
+
+using namespace std;
+
+/**
+ * Creates and initialises a serial interface that receives bytes with a DMA controller.
+ * @param tx the transmit pin of the serial interface.
+ * @param rx the receive pin of the serial interface.
+ * @param baud the baud rate of the serial interface.
+ */
+DMASerial::DMASerial(PinName tx, PinName rx, int baud) : serial(tx, rx, baud) {
+    
+    // align receive buffer with the lines of the data cache
+    
+    receiveBuffer = (char*)(((uintptr_t)memory+CACHE_LINE_SIZE-1) & ~(uintptr_t)(CACHE_LINE_SIZE-1));
+    head = 0;
+    tail = 0;
+    overruns = 0;
+    
+    serial.format(8, SerialBase::None, 1);
+    
+    // check pins
+    
+    if ((tx == PG_14) && (rx == PG_9)) {
+        
+        // pinmap OK for USART6, receive requests on DMA2 stream 1 channel 5
+        
+        USART = USART6;
+        DMA = DMA2_Stream1;
+        
+        // configure reset and clock control registers
+        
+        RCC->AHB1ENR |= RCC_AHB1ENR_DMA2EN;     // DMA2 clock enable
+        
+    } else {
+        
+        printf("pinmap not found for peripheral\n");
+        
+        USART = NULL;
+        DMA = NULL;
+    }
+    
+    // configure DMA stream in circular mode, from peripheral to memory
+    
+    if (DMA != NULL) {
+        
+        DMA->CR &= ~DMA_SxCR_EN;                // stream disable
+        while (DMA->CR & DMA_SxCR_EN);          // wait until stream is disabled
+        
+        DMA2->LIFCR = 0x00000F40;               // clear all interrupt flags of stream 1
+        
+        DMA->PAR = (uint32_t)(uintptr_t)&USART->RDR;    // peripheral address of receive data register
+        DMA->M0AR = (uint32_t)(uintptr_t)receiveBuffer; // memory address of receive buffer
+        DMA->NDTR = BUFFER_SIZE;                // number of bytes of the circular buffer
+        DMA->FCR = 0x0000;                      // direct mode, no FIFO
+        DMA->CR = (5 << DMA_SxCR_CHSEL_Pos) | DMA_SxCR_PL_1 | DMA_SxCR_MINC | DMA_SxCR_CIRC; // channel 5, high priority, byte transfers
+        DMA->CR |= DMA_SxCR_EN;                 // stream enable
+        
+        USART->CR3 |= USART_CR3_DMAR;           // enable DMA requests of receiver
+    }
+}
+
+/**
+ * Stops the DMA controller and deletes this object.
+ */
+DMASerial::~DMASerial() {
+    
+    if (DMA != NULL) {
+        
+        USART->CR3 &= ~USART_CR3_DMAR;
+        DMA->CR &= ~DMA_SxCR_EN;
+    }
+}
+
+/**
+ * Reads the bytes that were received since the last call of this method.
+ * The circular buffer holds 2048 bytes, i.e. about 180 ms at 115200 baud.
+ * When this method is not called that often, the overwritten bytes are
+ * discarded, and the overrun is counted. Overruns are always detected when
+ * less than 1.5 times the size of the buffer was received since the last call.
+ * @param buffer a buffer to copy the received bytes into.
+ * @param size the size of this buffer, given in [bytes].
+ * @return the number of bytes copied into the buffer.
+ */
+int DMASerial::read(char buffer[], int size) {
+    
+    if (DMA == NULL) return 0;
+    
+    // read the half transfer and transfer complete flags of the DMA stream, before getting the index of the next byte it
+    // will write, and clear them only afterwards, so that the flags of the next read only report boundaries crossed after this index
+    
+    uint32_t flags = DMA2->LISR;
+    
+    int previousHead = head;
+    
+    head = BUFFER_SIZE-(int)DMA->NDTR;
+    if (head >= BUFFER_SIZE) head = 0;
+    
+    DMA2->LIFCR = DMA_LIFCR_CHTIF1 | DMA_LIFCR_CTCIF1;
+    
+    // the DMA controller wrote the bytes from the previous to the actual index, and one more revolution of the buffer,
+    // when a flag reports that it crossed the middle or the end of the buffer, but these bytes alone do not cross it
+    
+    int received = (head-previousHead+BUFFER_SIZE)%BUFFER_SIZE;
+    
+    bool crossedMiddle = ((previousHead < BUFFER_SIZE/2) && (previousHead+received >= BUFFER_SIZE/2)) || (previousHead+received >= BUFFER_SIZE+BUFFER_SIZE/2);
+    bool crossedEnd = previousHead+received >= BUFFER_SIZE;
+    
+    if (((flags & DMA_LISR_HTIF1) && !crossedMiddle) || ((flags & DMA_LISR_TCIF1) && !crossedEnd)) received += BUFFER_SIZE;
+    
+    // check if the received bytes overwrote bytes that were not read yet
+    
+    int unread = (previousHead-tail+BUFFER_SIZE)%BUFFER_SIZE;
+    
+    if (unread+received >= BUFFER_SIZE) {
+        
+        // discard the overwritten bytes, and keep the bytes received within the last revolution of the buffer
+        
+        overruns++;
+        tail = (head+1)%BUFFER_SIZE;
+    }
+    
+    // discard the cached copy of the receive buffer, because the DMA controller bypasses the data cache
+    
+    SCB_InvalidateDCache_by_Addr((uint32_t*)receiveBuffer, BUFFER_SIZE);
+    
+    // copy the received bytes
+    
+    int n = 0;
+    
+    while ((tail != head) && (n < size)) {
+        buffer[n++] = receiveBuffer[tail++];
+        if (tail >= BUFFER_SIZE) tail = 0;
+    }
+    
+    return n;
+}
+
+/**
+ * Writes bytes to the serial interface.
+ * This method blocks until all bytes are written.
+ * @param buffer a buffer with the bytes to write.
+ * @param size the number of bytes to write.
+ * @return the number of bytes written.
+ */
+int DMASerial::write(const char buffer[], int size) {
+    
+    return (int)serial.write(buffer, size);
+}
+
+/**
+ * Gets the number of times the DMA controller overwrote received bytes, because
+ * the <code>read()</code> method was not called often enough.
+ * @return the number of overruns since this object was created.
+ */
+uint32_t DMASerial::getOverruns() {
+    
+    return overruns;
+}
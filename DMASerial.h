@@ -0,0 +1,50 @@
+/*
+ * DMASerial.h
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#ifndef DMA_SERIAL_H_
+#define DMA_SERIAL_H_
+
+#include <cstdlib>
+#include <mbed.h>
+#include "ByteStream.h"
+
+/**
+ * This class implements a serial interface that receives bytes with a DMA controller
+ * of the STM32 microcontroller. The DMA controller writes all received bytes into a
+ * circular buffer, without any interrupts. The <code>read()</code> method copies the
+ * bytes received since the last call in bulk, so it must be called often enough that
+ * the DMA controller does not overwrite bytes that were not read yet. Such overruns
+ * are detected with the transfer complete flag of the DMA stream, and counted.
+ * <br/>
+ * This driver is only available on the pins PG_14 and PG_9, i.e. USART6 with the
+ * DMA2 stream 1 and channel 5.
+ */
+class DMASerial : public ByteStream {
+    
+    public:
+        
+                    DMASerial(PinName tx, PinName rx, int baud);
+        virtual     ~DMASerial();
+        int         read(char buffer[], int size);
+        int         write(const char buffer[], int size);
+        uint32_t    getOverruns();
+        
+    private:
+        
+        static const int    BUFFER_SIZE = 2048;     // size of the circular receive buffer, given in [bytes]
+        static const int    CACHE_LINE_SIZE = 32;   // size of a line of the data cache, given in [bytes]
+        
+        UnbufferedSerial        serial;     // serial interface that configures the pins and the USART
+        USART_TypeDef*          USART;
+        DMA_Stream_TypeDef*     DMA;
+        char                    memory[BUFFER_SIZE+CACHE_LINE_SIZE];    // memory for the receive buffer
+        char*                   receiveBuffer;  // receive buffer, aligned with the lines of the data cache
+        int                     head;           // index of the next byte the DMA controller writes, at the last read
+        int                     tail;           // index of the next byte in the receive buffer to read
+        uint32_t                overruns;       // number of times the DMA controller overwrote bytes that were not read
+};
+
+#endif /* DMA_SERIAL_H_ */
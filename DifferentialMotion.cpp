@@ -0,0 +1,154 @@
+/*
+ * DifferentialMotion.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include <cmath>
+#include <algorithm>
+#include "DifferentialMotion.h"
+
+using namespace std;
+
+const float DifferentialMotion::MINIMUM_CHANGE = 1.0e-6f;  // smallest change of the wheel speeds that is planned
+
+/**
+ * Creates a <code>DifferentialMotion</code> object.
+ * The speeds and accelerations of both wheels are set to 0.
+ */
+DifferentialMotion::DifferentialMotion() {
+    
+    profileVelocity = 1.0f;
+    profileAcceleration = 1.0f;
+    profileDeceleration = 1.0f;
+    
+    velocityLeft = 0.0f;
+    velocityRight = 0.0f;
+    accelerationLeft = 0.0f;
+    accelerationRight = 0.0f;
+}
+
+/**
+ * Deletes the DifferentialMotion object.
+ */
+DifferentialMotion::~DifferentialMotion() {}
+
+/**
+ * Sets the limit for the speed of each wheel.
+ * @param profileVelocity the limit of the speed.
+ */
+void DifferentialMotion::setProfileVelocity(float profileVelocity) {
+    
+    this->profileVelocity = profileVelocity;
+}
+
+/**
+ * Sets the limit for the acceleration of each wheel.
+ * @param profileAcceleration the limit of the acceleration.
+ */
+void DifferentialMotion::setProfileAcceleration(float profileAcceleration) {
+    
+    this->profileAcceleration = profileAcceleration;
+}
+
+/**
+ * Sets the limit for the deceleration of each wheel.
+ * @param profileDeceleration the limit of the deceleration.
+ */
+void DifferentialMotion::setProfileDeceleration(float profileDeceleration) {
+    
+    this->profileDeceleration = profileDeceleration;
+}
+
+/**
+ * Sets the limit for the jerk of each wheel.
+ * @param profileJerk the limit of the jerk, or 0 for a profile without a jerk limit.
+ */
+void DifferentialMotion::setProfileJerk(float profileJerk) {
+    
+    progress.setProfileJerk(profileJerk);
+}
+
+/**
+ * Gets the planned speed of the left wheel.
+ */
+float DifferentialMotion::getVelocityLeft() {
+    
+    return velocityLeft;
+}
+
+/**
+ * Gets the planned speed of the right wheel.
+ */
+float DifferentialMotion::getVelocityRight() {
+    
+    return velocityRight;
+}
+
+/**
+ * Gets the planned acceleration of the left wheel.
+ */
+float DifferentialMotion::getAccelerationLeft() {
+    
+    return accelerationLeft;
+}
+
+/**
+ * Gets the planned acceleration of the right wheel.
+ */
+float DifferentialMotion::getAccelerationRight() {
+    
+    return accelerationRight;
+}
+
+/**
+ * Increments the speeds of both wheels towards given target speeds.
+ * @param targetVelocityLeft the desired target speed of the left wheel.
+ * @param targetVelocityRight the desired target speed of the right wheel.
+ * @param period the time period to increment the motion values for, given in [s].
+ */
+void DifferentialMotion::incrementToVelocity(float targetVelocityLeft, float targetVelocityRight, float period) {
+    
+    // scale both target speeds down to the velocity limit, to preserve the curvature
+    
+    float maximumVelocity = max(fabs(targetVelocityLeft), fabs(targetVelocityRight));
+    
+    if (maximumVelocity > profileVelocity) {
+        targetVelocityLeft *= profileVelocity/maximumVelocity;
+        targetVelocityRight *= profileVelocity/maximumVelocity;
+    }
+    
+    // calculate the direction of the change, normalized such that the wheel with the larger change has a unit step
+    
+    float deltaLeft = targetVelocityLeft-velocityLeft;
+    float deltaRight = targetVelocityRight-velocityRight;
+    float delta = max(fabs(deltaLeft), fabs(deltaRight));
+    
+    if (delta < MINIMUM_CHANGE) {
+        
+        velocityLeft = targetVelocityLeft;
+        velocityRight = targetVelocityRight;
+        accelerationLeft = 0.0f;
+        accelerationRight = 0.0f;
+        
+        return;
+    }
+    
+    float directionLeft = deltaLeft/delta;
+    float directionRight = deltaRight/delta;
+    
+    bool slowDown = (fabs(deltaLeft) > fabs(deltaRight)) ? (fabs(targetVelocityLeft) < fabs(velocityLeft)) : (fabs(targetVelocityRight) < fabs(velocityRight));
+    
+    // project the actual accelerations onto the direction of the change, and plan the progress along this direction
+    
+    progress.set(0.0, 0.0f);
+    progress.acceleration = (accelerationLeft*directionLeft+accelerationRight*directionRight)/(directionLeft*directionLeft+directionRight*directionRight);
+    progress.setProfileVelocity(delta);
+    progress.setProfileAcceleration(slowDown ? profileDeceleration : profileAcceleration);
+    progress.incrementToVelocity(delta, period);
+    
+    velocityLeft += directionLeft*progress.velocity;
+    velocityRight += directionRight*progress.velocity;
+    accelerationLeft = directionLeft*progress.acceleration;
+    accelerationRight = directionRight*progress.acceleration;
+}
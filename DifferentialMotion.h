@@ -0,0 +1,57 @@
+/*
+ * DifferentialMotion.h
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#ifndef DIFFERENTIAL_MOTION_H_
+#define DIFFERENTIAL_MOTION_H_
+
+#include <cstdlib>
+#include "Motion.h"
+
+/**
+ * This class plans the speeds of the two wheels of a differential drive jointly.
+ * <br/>
+ * The wheel speeds are linear in the translational and rotational velocity of the robot,
+ * so a joint plan of these velocities is a joint plan of the wheel speeds. The wheel speeds
+ * move on a straight line from their actual values to their target values, with a progress
+ * that is planned by a single <code>Motion</code> object. The progress is scaled such that
+ * the wheel with the larger change is driven at its acceleration and jerk limits, and the
+ * other wheel is slowed down in time, so that both wheels reach their targets together.
+ * The wheel with the larger change also selects the acceleration or the deceleration limit.
+ * Target speeds above the velocity limit are scaled down for both wheels with the same
+ * factor. When the robot starts from standstill or stops, the ratio of the wheel speeds,
+ * and therefore the curvature of the path, is preserved during the acceleration.
+ */
+class DifferentialMotion {
+    
+    public:
+        
+                    DifferentialMotion();
+        virtual     ~DifferentialMotion();
+        void        setProfileVelocity(float profileVelocity);
+        void        setProfileAcceleration(float profileAcceleration);
+        void        setProfileDeceleration(float profileDeceleration);
+        void        setProfileJerk(float profileJerk);
+        float       getVelocityLeft();
+        float       getVelocityRight();
+        float       getAccelerationLeft();
+        float       getAccelerationRight();
+        void        incrementToVelocity(float targetVelocityLeft, float targetVelocityRight, float period);
+        
+    private:
+        
+        static const float  MINIMUM_CHANGE; // smallest change of the wheel speeds that is planned
+        
+        float       profileVelocity;        // limit of the speed of each wheel
+        float       profileAcceleration;    // limit of the acceleration of each wheel
+        float       profileDeceleration;    // limit of the deceleration of each wheel
+        float       velocityLeft;
+        float       velocityRight;
+        float       accelerationLeft;
+        float       accelerationRight;
+        Motion      progress;               // motion along the straight line from the actual to the target wheel speeds
+};
+
+#endif /* DIFFERENTIAL_MOTION_H_ */
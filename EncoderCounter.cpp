@@ -143,6 +143,9 @@ EncoderCounter::EncoderCounter(PinName a, PinName b) {
         TIM->ARR = 0xFFFF;          // auto reload register
         TIM->CR1 = TIM_CR1_CEN;     // counter enable
     }
+    
+    count = 0;
+    previousValue = 0;
 }
 
 /**
@@ -155,7 +158,13 @@ EncoderCounter::~EncoderCounter() {}
  */
 void EncoderCounter::reset() {
     
+    core_util_critical_section_enter();
+    
     TIM->CNT = 0x0000;
+    count = 0;
+    previousValue = 0;
+    
+    core_util_critical_section_exit();
 }
 
 /**
@@ -164,7 +173,13 @@ void EncoderCounter::reset() {
  */
 void EncoderCounter::reset(short offset) {
     
+    core_util_critical_section_enter();
+    
     TIM->CNT = -offset;
+    count = offset;
+    previousValue = static_cast<unsigned short>(offset);
+    
+    core_util_critical_section_exit();
 }
 
 /**
@@ -176,6 +191,28 @@ short EncoderCounter::read() {
     return (short)(-TIM->CNT);
 }
 
+/**
+ * Reads the quadrature encoder counter, extended to an absolute 64-bit count.
+ * This method must be called at least once per 32767 counts, to detect every
+ * wrap around of the 16-bit hardware counter.
+ * @return the absolute count since the last reset.
+ */
+int64_t EncoderCounter::readCount() {
+    
+    core_util_critical_section_enter();
+    
+    unsigned short value = static_cast<unsigned short>(-TIM->CNT);
+    
+    count += static_cast<short>(value-previousValue);
+    previousValue = value;
+    
+    int64_t count = this->count;
+    
+    core_util_critical_section_exit();
+    
+    return count;
+}
+
 /**
  * The empty operator is a shorthand notation of the <code>read()</code> method.
  */
@@ -8,11 +8,18 @@
 #define ENCODER_COUNTER_H_
 
 #include <cstdlib>
+#include <stdint.h>
 #include <mbed.h>
 
 /**
  * This class implements a driver to read the quadrature
  * encoder counter of the STM32 microcontroller.
+ * <br/>
+ * The hardware counter has 16 bits. It is extended in software to an absolute
+ * 64-bit count, by adding the signed difference to the previous reading with
+ * every call of <code>readCount()</code>. This is overflow-safe, as long as this
+ * method is called at least once per 32767 counts, i.e. within every period of
+ * the controller.
  */
 class EncoderCounter {
     
@@ -23,11 +30,14 @@ class EncoderCounter {
         void        reset();
         void        reset(short offset);
         short       read();
+        int64_t     readCount();
                     operator short();
         
     private:
         
         TIM_TypeDef*    TIM;
+        int64_t         count;          // extended absolute count
+        unsigned short  previousValue;  // value of the hardware counter at the previous extension of the count
 };
 
 #endif /* ENCODER_COUNTER_H_ */
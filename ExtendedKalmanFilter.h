@@ -0,0 +1,105 @@
+/*
+ * ExtendedKalmanFilter.h
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#ifndef EXTENDED_KALMAN_FILTER_H_
+#define EXTENDED_KALMAN_FILTER_H_
+
+#include <cstdlib>
+#include "Matrix.h"
+
+/**
+ * This class template implements the prediction and correction of an extended
+ * Kalman filter with N states and measurements of M values.
+ * <br/>
+ * The nonlinear models of the process and of the measurements are evaluated by
+ * the user of this filter, which sets the predicted state directly and provides
+ * the innovation, i.e. the difference between the measured and the estimated
+ * values, together with the jacobians of both models.
+ */
+template <unsigned int N, unsigned int M>
+class ExtendedKalmanFilter {
+    
+    public:
+        
+        Matrix<N, 1>    x;  /**< The state vector. */
+        Matrix<N, N>    p;  /**< The covariance matrix of the state. */
+        
+        /**
+         * Creates an extended Kalman filter with a zero state and covariance matrix.
+         */
+        ExtendedKalmanFilter() {}
+        
+        /**
+         * Predicts the covariance matrix with P = F*P*F'+Q.
+         * The state must be predicted by the user of this filter.
+         * @param f the jacobian F of the process model.
+         * @param q the covariance matrix Q of the process noise.
+         */
+        void predict(const Matrix<N, N>& f, const Matrix<N, N>& q) {
+            
+            p = f*p*f.transpose()+q;
+        }
+        
+        /**
+         * Corrects the state and the covariance matrix with a measurement.
+         * The covariance matrix is updated with P = P-K*(P*H')', which is
+         * calculated from P*H' and therefore does not need H*P. Because P and
+         * S = H*P*H'+R are symmetric, only their upper triangles are calculated.
+         * @param innovation the difference between the measured and the estimated values.
+         * @param h the jacobian H of the measurement model.
+         * @param r the covariance matrix R of the measurement noise.
+         * @return <code>true</code> if the measurement was applied, <code>false</code> if the covariance matrix of the innovation is singular.
+         */
+        bool update(const Matrix<M, 1>& innovation, const Matrix<M, N>& h, const Matrix<M, M>& r) {
+            
+            // calculate P*H' without a transposed copy of H
+            
+            Matrix<N, M> ph;
+            
+            for (unsigned int i = 0; i < N; i++) {
+                for (unsigned int j = 0; j < M; j++) {
+                    float sum = 0.0f;
+                    for (unsigned int k = 0; k < N; k++) sum += p.m[i][k]*h.m[j][k];
+                    ph.m[i][j] = sum;
+                }
+            }
+            
+            // calculate the covariance matrix of the innovation S = H*P*H'+R and its inverse
+            
+            Matrix<M, M> s;
+            
+            for (unsigned int i = 0; i < M; i++) {
+                for (unsigned int j = i; j < M; j++) {
+                    float sum = r.m[i][j];
+                    for (unsigned int k = 0; k < N; k++) sum += h.m[i][k]*ph.m[k][j];
+                    s.m[i][j] = sum;
+                    s.m[j][i] = sum;
+                }
+            }
+            
+            Matrix<M, M> inverse;
+            if (!s.inverse(inverse)) return false;
+            
+            // calculate the Kalman matrix K = P*H'*S^-1, and correct the state and the covariance matrix
+            
+            Matrix<N, M> k = ph*inverse;
+            
+            x += k*innovation;
+            
+            for (unsigned int i = 0; i < N; i++) {
+                for (unsigned int j = i; j < N; j++) {
+                    float sum = 0.0f;
+                    for (unsigned int l = 0; l < M; l++) sum += k.m[i][l]*ph.m[j][l];
+                    p.m[i][j] -= sum;
+                    p.m[j][i] = p.m[i][j];
+                }
+            }
+            
+            return true;
+        }
+};
+
+#endif /* EXTENDED_KALMAN_FILTER_H_ */
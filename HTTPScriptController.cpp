@@ -0,0 +1,43 @@
+/*
+ * HTTPScriptController.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include "HTTPScriptController.h"
+
+using namespace std;
+
+inline string int2String(int i) {
+    
+    char buffer[32];
+    sprintf(buffer, "%d", i);
+    
+    return string(buffer);
+}
+
+/**
+ * Create and initialize this http script.
+ * @param controller a reference to the controller to read the runtime of its control loop from.
+ */
+HTTPScriptController::HTTPScriptController(Controller& controller) : controller(controller) {}
+
+HTTPScriptController::~HTTPScriptController() {}
+
+/**
+ * This method gets called by the http server, when an object of this class is
+ * registered with the server, and the corresponding script is called
+ * by an http client. It reports the CPU cycles of the latest period of the
+ * control loop, and the maximum since start up.
+ */
+string HTTPScriptController::call(vector<string> names, vector<string> values) {
+    
+    string response;
+    
+    response += "  <controller>\r\n";
+    response += "    <cycles><int>"+int2String(controller.getCycles())+"</int></cycles>\r\n";
+    response += "    <maximumCycles><int>"+int2String(controller.getMaximumCycles())+"</int></maximumCycles>\r\n";
+    response += "  </controller>\r\n";
+    
+    return response;
+}
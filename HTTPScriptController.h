@@ -0,0 +1,32 @@
+/*
+ * HTTPScriptController.h
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#ifndef HTTP_SCRIPT_CONTROLLER_H_
+#define HTTP_SCRIPT_CONTROLLER_H_
+
+#include <string>
+#include <vector>
+#include "HTTPScript.h"
+#include "Controller.h"
+
+/**
+ * This is a specific http script to read the runtime of the control loop of a controller.
+ * @see HTTPServer
+ */
+class HTTPScriptController : public HTTPScript {
+    
+    public:
+        
+                            HTTPScriptController(Controller& controller);
+        virtual             ~HTTPScriptController();
+        virtual std::string call(std::vector<std::string> names, std::vector<std::string> values);
+        
+    private:
+        
+        Controller&         controller;
+};
+
+#endif /* HTTP_SCRIPT_CONTROLLER_H_ */
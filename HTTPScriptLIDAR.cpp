@@ -4,7 +4,6 @@
  * All rights reserved.
  */
 
-#include <deque>
 #include "HTTPScriptLIDAR.h"
 
 using namespace std;
@@ -28,8 +27,9 @@ inline string float2String(float f) {
 /**
  * Create and initialize this http script.
  * @param lidar a reference to the lidar to read scans from.
+ * @param scanMatcher a reference to the scan matcher that aligns the scans with the map of walls.
  */
-HTTPScriptLIDAR::HTTPScriptLIDAR(LIDAR& lidar) : lidar(lidar) {}
+HTTPScriptLIDAR::HTTPScriptLIDAR(LIDAR& lidar, ScanMatcher& scanMatcher) : lidar(lidar), scanMatcher(scanMatcher) {}
 
 HTTPScriptLIDAR::~HTTPScriptLIDAR() {}
 
@@ -42,22 +42,30 @@ string HTTPScriptLIDAR::call(vector<string> names, vector<string> values) {
     
     string response;
     
-    deque<Point> scan = lidar.getScan();
-    deque<Point> beacons = lidar.getBeacons();
+    lidar.getScan(scan);
+    unsigned short size = lidar.getBeacons(scan, beacons, MAXIMUM_BEACONS);
     
     response += "  <lidar>\r\n";
     response += "    <scan>\r\n";
-    response += "      <size><int>"+int2String(scan.size())+"</int></size>\r\n";
-    for (unsigned short i = 0; i < scan.size(); i++) {
-        response += "      <point><x><float>"+float2String(scan[i].x)+"</float></x><y><float>"+float2String(scan[i].y)+"</float></y></point>\r\n";
+    response += "      <size><int>"+int2String(scan.size)+"</int></size>\r\n";
+    for (unsigned short i = 0; i < scan.size; i++) {
+        response += "      <point><x><float>"+float2String(scan.x[i])+"</float></x><y><float>"+float2String(scan.y[i])+"</float></y></point>\r\n";
     }
     response += "    </scan>\r\n";
     response += "    <beacons>\r\n";
-    response += "      <size><int>"+int2String(beacons.size())+"</int></size>\r\n";
-    for (unsigned short i = 0; i < beacons.size(); i++) {
+    response += "      <size><int>"+int2String(size)+"</int></size>\r\n";
+    for (unsigned short i = 0; i < size; i++) {
         response += "      <point><x><float>"+float2String(beacons[i].x)+"</float></x><y><float>"+float2String(beacons[i].y)+"</float></y></point>\r\n";
     }
     response += "    </beacons>\r\n";
+    response += "    <frames><int>"+int2String(lidar.getFrames())+"</int></frames>\r\n";
+    response += "    <syncErrors><int>"+int2String(lidar.getSyncErrors())+"</int></syncErrors>\r\n";
+    response += "    <checkErrors><int>"+int2String(lidar.getCheckErrors())+"</int></checkErrors>\r\n";
+    response += "    <scanMatcher>\r\n";
+    response += "      <duration><int>"+int2String(scanMatcher.getDuration())+"</int></duration>\r\n";
+    response += "      <iterations><int>"+int2String(scanMatcher.getIterations())+"</int></iterations>\r\n";
+    response += "      <correspondences><int>"+int2String(scanMatcher.getCorrespondences())+"</int></correspondences>\r\n";
+    response += "    </scanMatcher>\r\n";
     response += "  </lidar>\r\n";
     
     return response;
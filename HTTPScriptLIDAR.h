@@ -11,22 +11,29 @@
 #include <vector>
 #include "HTTPScript.h"
 #include "LIDAR.h"
+#include "ScanMatcher.h"
 
 /**
- * This is a specific http script to read scans from a LIDAR.
+ * This is a specific http script to read scans from a LIDAR, together with
+ * the duration, iterations and correspondences of the last match of the scan matcher.
  * @see HTTPServer
  */
 class HTTPScriptLIDAR : public HTTPScript {
     
     public:
         
-                            HTTPScriptLIDAR(LIDAR& lidar);
+                            HTTPScriptLIDAR(LIDAR& lidar, ScanMatcher& scanMatcher);
         virtual             ~HTTPScriptLIDAR();
         virtual std::string call(std::vector<std::string> names, std::vector<std::string> values);
         
     private:
         
-        LIDAR&  lidar;
+        static const unsigned short MAXIMUM_BEACONS = 16;   // maximum number of beacons reported
+        
+        LIDAR&          lidar;
+        ScanMatcher&    scanMatcher;
+        Scan            scan;
+        Beacon          beacons[MAXIMUM_BEACONS];
 };
 
 #endif /* HTTP_SCRIPT_LIDAR_H_ */
@@ -0,0 +1,95 @@
+/*
+ * HTTPScriptOccupancyGrid.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include "HTTPScriptOccupancyGrid.h"
+
+using namespace std;
+
+inline string int2String(int i) {
+    
+    char buffer[32];
+    sprintf(buffer, "%d", i);
+    
+    return string(buffer);
+}
+
+inline string float2String(float f) {
+    
+    char buffer[32];
+    sprintf(buffer, "%.3f", f);
+    
+    return string(buffer);
+}
+
+inline string bytes2Base64(const uint8_t bytes[], unsigned int size) {
+    
+    static const char CHARACTERS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    
+    string base64;
+    base64.reserve((size+2)/3*4);
+    
+    for (unsigned int i = 0; i < size; i += 3) {
+        
+        uint32_t word = static_cast<uint32_t>(bytes[i]) << 16;
+        if (i+1 < size) word |= static_cast<uint32_t>(bytes[i+1]) << 8;
+        if (i+2 < size) word |= static_cast<uint32_t>(bytes[i+2]);
+        
+        base64 += CHARACTERS[(word >> 18) & 0x3F];
+        base64 += CHARACTERS[(word >> 12) & 0x3F];
+        base64 += (i+1 < size) ? CHARACTERS[(word >> 6) & 0x3F] : '=';
+        base64 += (i+2 < size) ? CHARACTERS[word & 0x3F] : '=';
+    }
+    
+    return base64;
+}
+
+/**
+ * Create and initialize this http script.
+ * @param occupancyGrid a reference to the occupancy grid to read tiles from.
+ */
+HTTPScriptOccupancyGrid::HTTPScriptOccupancyGrid(OccupancyGrid& occupancyGrid) : occupancyGrid(occupancyGrid) {}
+
+HTTPScriptOccupancyGrid::~HTTPScriptOccupancyGrid() {}
+
+/**
+ * This method gets called by the http server, when an object of this class is
+ * registered with the server, and the corresponding script is called
+ * by an http client.
+ */
+string HTTPScriptOccupancyGrid::call(vector<string> names, vector<string> values) {
+    
+    string response;
+    
+    for (unsigned short i = 0; i < names.size(); i++) {
+        if (names[i].compare("all") == 0) occupancyGrid.setDirty();
+    }
+    
+    // copy the dirty tiles into the blob, each with its column and row
+    
+    unsigned short size = occupancyGrid.getDirtyTiles(tiles, MAXIMUM_TILES);
+    
+    for (unsigned short i = 0; i < size; i++) {
+        
+        uint8_t* tile = &blob[i*TILE_BYTES];
+        
+        tile[0] = static_cast<uint8_t>(tiles[i]%OccupancyGrid::TILES);
+        tile[1] = static_cast<uint8_t>(tiles[i]/OccupancyGrid::TILES);
+        
+        occupancyGrid.getTile(tiles[i], reinterpret_cast<int8_t*>(&tile[2]));
+    }
+    
+    response += "  <occupancyGrid>\r\n";
+    response += "    <x><float>"+float2String(occupancyGrid.getX())+"</float></x>\r\n";
+    response += "    <y><float>"+float2String(occupancyGrid.getY())+"</float></y>\r\n";
+    response += "    <resolution><float>"+float2String(OccupancyGrid::RESOLUTION)+"</float></resolution>\r\n";
+    response += "    <tileSize><int>"+int2String(OccupancyGrid::TILE_SIZE)+"</int></tileSize>\r\n";
+    response += "    <tiles><int>"+int2String(OccupancyGrid::TILES)+"</int></tiles>\r\n";
+    response += "    <size><int>"+int2String(size)+"</int></size>\r\n";
+    response += "    <blob>"+bytes2Base64(blob, size*TILE_BYTES)+"</blob>\r\n";
+    response += "  </occupancyGrid>\r\n";
+    
+    return response;
+}
@@ -0,0 +1,41 @@
+/*
+ * HTTPScriptOccupancyGrid.h
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#ifndef HTTP_SCRIPT_OCCUPANCY_GRID_H_
+#define HTTP_SCRIPT_OCCUPANCY_GRID_H_
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "HTTPScript.h"
+#include "OccupancyGrid.h"
+
+/**
+ * This is a specific http script to read the tiles of an occupancy grid that changed
+ * since the last call. The tiles are returned as a base64 encoded blob, with the column
+ * and row of every tile as a byte each, followed by the log-odds of its cells as signed
+ * bytes, row by row. The parameter <code>all</code> requests all tiles of the grid.
+ * @see HTTPServer
+ */
+class HTTPScriptOccupancyGrid : public HTTPScript {
+    
+    public:
+        
+                            HTTPScriptOccupancyGrid(OccupancyGrid& occupancyGrid);
+        virtual             ~HTTPScriptOccupancyGrid();
+        virtual std::string call(std::vector<std::string> names, std::vector<std::string> values);
+        
+    private:
+        
+        static const unsigned short MAXIMUM_TILES = 32;     // maximum number of tiles reported per call
+        static const unsigned short TILE_BYTES = 2+OccupancyGrid::TILE_CELLS;   // number of bytes of a tile in the blob
+        
+        OccupancyGrid&  occupancyGrid;
+        unsigned short  tiles[MAXIMUM_TILES];
+        uint8_t         blob[MAXIMUM_TILES*TILE_BYTES];
+};
+
+#endif /* HTTP_SCRIPT_OCCUPANCY_GRID_H_ */
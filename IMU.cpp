@@ -69,6 +69,7 @@ IMU::IMU(SPI& spi, DigitalOut& csAG, DigitalOut& csM) : spi(spi), csAG(csAG), cs
     magnetometerYFilter.filter(readMagnetometerY());
     
     heading = 0.0f;
+    gyroZ = 0.0f;
     
     // start thread and timer interrupt
     
@@ -289,6 +290,16 @@ float IMU::readHeading() {
     return heading;
 }
 
+/**
+ * Gets the angular velocity about the z-axis, that was read in the latest period of this driver.
+ * This method does not access the SPI interface, and can be called by time critical threads.
+ * @return the angular velocity about the z-axis, given in [rad/s].
+ */
+float IMU::getGyroZ() {
+    
+    return gyroZ;
+}
+
 /**
  * This method is called by the ticker timer interrupt service routine.
  * It sends a flag to the thread to make it run again.
@@ -309,6 +320,10 @@ void IMU::run() {
         
         ThisThread::flags_wait_any(threadFlag);
         
+        // read the angular velocity about the z-axis for other threads
+        
+        gyroZ = readGyroZ();
+        
         // read actual measurements from magnetometer registers
         
         float magnetometerX = magnetometerXFilter.filter(readMagnetometerX());
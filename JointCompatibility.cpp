@@ -0,0 +1,245 @@
+/*
+ * JointCompatibility.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include <cmath>
+#include "JointCompatibility.h"
+
+using namespace std;
+
+const float JointCompatibility::GATES[] = {9.21f, 13.28f, 16.81f, 20.09f, 23.21f, 26.22f, 29.14f, 32.00f}; // 99% quantiles of chi-square for 2, 4, ... 16 degrees of freedom
+
+/**
+ * Creates a JointCompatibility object.
+ * @param landmarkMap a reference to the map with the landmarks to associate beacons with.
+ */
+JointCompatibility::JointCompatibility(LandmarkMap& landmarkMap) : landmarkMap(landmarkMap) {
+    
+    size = 0;
+    pairings = 0;
+    bestPairings = 0;
+    bestDistance = 0.0f;
+    nodes = 0;
+    truncated = false;
+}
+
+/**
+ * Deletes this object.
+ */
+JointCompatibility::~JointCompatibility() {}
+
+/**
+ * Associates the beacons of a scan with the landmarks of the map.
+ * Only the first <code>MAXIMUM_BEACONS</code> beacons of a scan are considered.
+ * @param x the x coordinate of the pose of the robot at the time of the scan, given in [m].
+ * @param y the y coordinate of the pose of the robot, given in [m].
+ * @param alpha the orientation of the pose of the robot, given in [rad].
+ * @param p the covariance matrix of the pose of the robot.
+ * @param beacons an array with the beacons of the scan, given in robot coordinates.
+ * @param size the number of beacons.
+ * @param actualBeacons an array that is filled with the positions of the associated landmarks.
+ * @param measuredBeacons an array that is filled with the positions of the associated beacons in map coordinates.
+ * @return the number of associations, which are consistent with each other.
+ */
+unsigned short JointCompatibility::associate(float x, float y, float alpha, const Matrix<3, 3>& p, Beacon beacons[], unsigned short size, Point actualBeacons[], Point measuredBeacons[]) {
+    
+    if (size > MAXIMUM_BEACONS) size = MAXIMUM_BEACONS;
+    
+    this->size = size;
+    
+    float cosAlpha = cos(alpha);
+    float sinAlpha = sin(alpha);
+    
+    Matrix<2, 2> rotation;
+    rotation(0, 0) = cosAlpha;
+    rotation(0, 1) = -sinAlpha;
+    rotation(1, 0) = sinAlpha;
+    rotation(1, 1) = cosAlpha;
+    
+    // transform the beacons into map coordinates, and find their individually compatible landmarks
+    
+    for (unsigned short i = 0; i < size; i++) {
+        
+        xs[i] = cosAlpha*beacons[i].x-sinAlpha*beacons[i].y+x;
+        ys[i] = sinAlpha*beacons[i].x+cosAlpha*beacons[i].y+y;
+        
+        jacobians[i] = Matrix<2, 3>::identity();
+        jacobians[i](0, 2) = y-ys[i];
+        jacobians[i](1, 2) = xs[i]-x;
+        
+        jacobiansP[i] = jacobians[i]*p;
+        
+        Matrix<2, 2> covariance(beacons[i].covariance);
+        covariances[i] = rotation*covariance*rotation.transpose();
+        
+        float distances[MAXIMUM_CANDIDATES];
+        counts[i] = landmarkMap.candidates(xs[i], ys[i], jacobiansP[i]*jacobians[i].transpose()+covariances[i], candidates[i], distances, MAXIMUM_CANDIDATES);
+        
+        hypothesis[i] = -1;
+        best[i] = -1;
+    }
+    
+    // search the jointly compatible hypothesis with the most pairings
+    
+    pairings = 0;
+    bestPairings = 0;
+    bestDistance = 0.0f;
+    nodes = 0;
+    truncated = false;
+    
+    search(0, 0.0f);
+    
+    // copy the pairings of the best hypothesis
+    
+    unsigned short associations = 0;
+    
+    for (unsigned short i = 0; i < size; i++) {
+        if (best[i] >= 0) {
+            actualBeacons[associations].x = landmarkMap.getX(best[i]);
+            actualBeacons[associations].y = landmarkMap.getY(best[i]);
+            measuredBeacons[associations].x = xs[i];
+            measuredBeacons[associations].y = ys[i];
+            associations++;
+        }
+    }
+    
+    return associations;
+}
+
+/**
+ * Gets the number of nodes of the search tree that were expanded in the last association.
+ */
+unsigned int JointCompatibility::getNodes() {
+    
+    return nodes;
+}
+
+/**
+ * Tells if the last association was stopped by the limit of expanded nodes.
+ * The result is then the best hypothesis that was found until that point.
+ */
+bool JointCompatibility::isTruncated() {
+    
+    return truncated;
+}
+
+/**
+ * Searches the hypotheses for the beacons from a given beacon on, recursively.
+ * @param i the index of the beacon to pair.
+ * @param distance the joint squared Mahalanobis distance of the current hypothesis.
+ */
+void JointCompatibility::search(unsigned short i, float distance) {
+    
+    if (i == size) {
+        
+        // a leaf of the search tree, keep the current hypothesis if it is better
+        
+        if ((pairings > bestPairings) || ((pairings == bestPairings) && (pairings > 0) && (distance < bestDistance))) {
+            for (unsigned short k = 0; k < size; k++) best[k] = hypothesis[k];
+            bestPairings = pairings;
+            bestDistance = distance;
+        }
+        
+        return;
+    }
+    
+    if (nodes >= MAXIMUM_NODES) {
+        truncated = true;
+        return;
+    }
+    
+    nodes++;
+    
+    // pair this beacon with all its candidates, that are not paired yet and that are jointly compatible
+    
+    for (unsigned short c = 0; c < counts[i]; c++) {
+        
+        int landmark = candidates[i][c];
+        
+        bool used = false;
+        for (unsigned short k = 0; k < i; k++) used |= (hypothesis[k] == landmark);
+        if (used) continue;
+        
+        float extendedDistance = distance;
+        
+        if (extend(i, landmark, extendedDistance)) {
+            hypothesis[i] = landmark;
+            paired[pairings++] = i;
+            search(i+1, extendedDistance);
+            pairings--;
+            hypothesis[i] = -1;
+        }
+    }
+    
+    // leave this beacon unpaired, when the remaining beacons could still give a better hypothesis
+    
+    if (pairings+size-i-1 > bestPairings) search(i+1, distance);
+}
+
+/**
+ * Extends the cholesky factor of the current hypothesis with a pairing of a beacon and
+ * a landmark, and calculates the joint squared Mahalanobis distance of the extended hypothesis.
+ * @param i the index of the beacon.
+ * @param landmark the index of the landmark.
+ * @param distance a reference to the distance of the current hypothesis, which is extended.
+ * @return <code>true</code> if the extended hypothesis is jointly compatible, <code>false</code> otherwise.
+ */
+bool JointCompatibility::extend(unsigned short i, int landmark, float& distance) {
+    
+    unsigned short n = 2*pairings;
+    
+    // calculate the new rows of the factor, L21 = S21*L11'^-1, with S21 = J2*P*J1'
+    
+    for (unsigned short row = 0; row < 2; row++) {
+        for (unsigned short k = 0; k < pairings; k++) {
+            
+            const Matrix<2, 3>& jacobian = jacobians[paired[k]];
+            
+            for (unsigned short column = 2*k; column < 2*k+2; column++) {
+                
+                float value = jacobiansP[i](row, 0)*jacobian(column-2*k, 0)+jacobiansP[i](row, 1)*jacobian(column-2*k, 1)+jacobiansP[i](row, 2)*jacobian(column-2*k, 2);
+                for (unsigned short t = 0; t < column; t++) value -= l[n+row][t]*l[column][t];
+                
+                l[n+row][column] = value/l[column][column];
+            }
+        }
+    }
+    
+    // calculate the new diagonal block, L22*L22' = S22-L21*L21'
+    
+    Matrix<2, 2> s = jacobiansP[i]*jacobians[i].transpose()+covariances[i];
+    
+    for (unsigned short t = 0; t < n; t++) {
+        s(0, 0) -= l[n][t]*l[n][t];
+        s(0, 1) -= l[n][t]*l[n+1][t];
+        s(1, 1) -= l[n+1][t]*l[n+1][t];
+    }
+    s(1, 0) = s(0, 1);
+    
+    Matrix<2, 2> factor;
+    if (!s.cholesky(factor)) return false;
+    
+    l[n][n] = factor(0, 0);
+    l[n][n+1] = 0.0f;
+    l[n+1][n] = factor(1, 0);
+    l[n+1][n+1] = factor(1, 1);
+    
+    // calculate the new elements of the innovation, v2 = L22^-1*(innovation-L21*v1)
+    
+    float innovationX = landmarkMap.getX(landmark)-xs[i];
+    float innovationY = landmarkMap.getY(landmark)-ys[i];
+    
+    for (unsigned short t = 0; t < n; t++) {
+        innovationX -= l[n][t]*v[t];
+        innovationY -= l[n+1][t]*v[t];
+    }
+    
+    v[n] = innovationX/l[n][n];
+    v[n+1] = (innovationY-l[n+1][n]*v[n])/l[n+1][n+1];
+    
+    distance += v[n]*v[n]+v[n+1]*v[n+1];
+    
+    return distance < GATES[pairings];
+}
@@ -0,0 +1,78 @@
+/*
+ * JointCompatibility.h
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#ifndef JOINT_COMPATIBILITY_H_
+#define JOINT_COMPATIBILITY_H_
+
+#include <cstdlib>
+#include "Matrix.h"
+#include "Point.h"
+#include "Beacon.h"
+#include "LandmarkMap.h"
+
+/**
+ * This class associates the beacons of a scan with the landmarks of a map
+ * with the joint compatibility branch and bound algorithm (JCBB).
+ * <br/>
+ * Every beacon is first paired with the landmarks it is individually compatible
+ * with. The branch and bound search then looks for the hypothesis with the largest
+ * number of pairings that is jointly compatible, i.e. where the squared Mahalanobis
+ * distance of all innovations together, with their correlation through the
+ * uncertain pose of the robot, is below the chi-square gate. Every landmark is
+ * paired with one beacon at most, so clutter near a landmark is rejected.
+ * <br/>
+ * The covariance matrix of the joint innovation is kept as a Cholesky factor,
+ * which is extended by two rows for every pairing of the hypothesis. The search
+ * is limited to a fixed number of nodes, so that the time of an association is
+ * bounded, and the number of expanded nodes is counted for every scan.
+ */
+class JointCompatibility {
+    
+    public:
+        
+        static const unsigned short MAXIMUM_BEACONS = 8;    /**< Maximum number of beacons that are associated per scan. */
+        
+                        JointCompatibility(LandmarkMap& landmarkMap);
+        virtual         ~JointCompatibility();
+        unsigned short  associate(float x, float y, float alpha, const Matrix<3, 3>& p, Beacon beacons[], unsigned short size, Point actualBeacons[], Point measuredBeacons[]);
+        unsigned int    getNodes();
+        bool            isTruncated();
+        
+    private:
+        
+        static const unsigned short MAXIMUM_CANDIDATES = 4;     // maximum number of landmarks per beacon
+        static const unsigned int   MAXIMUM_NODES = 256;        // maximum number of nodes expanded per scan
+        static const float          GATES[MAXIMUM_BEACONS];     // chi-square gates for 2, 4, ... 16 degrees of freedom
+        
+        LandmarkMap&    landmarkMap;
+        
+        unsigned short  size;                                               // number of beacons to associate
+        float           xs[MAXIMUM_BEACONS];                                // x coordinates of the beacons in the map, given in [m]
+        float           ys[MAXIMUM_BEACONS];                                // y coordinates of the beacons in the map, given in [m]
+        Matrix<2, 3>    jacobians[MAXIMUM_BEACONS];                         // jacobians of the beacons with respect to the pose
+        Matrix<2, 3>    jacobiansP[MAXIMUM_BEACONS];                        // jacobians multiplied with the covariance matrix of the pose
+        Matrix<2, 2>    covariances[MAXIMUM_BEACONS];                       // covariance matrices of the beacons in the map, given in [m2]
+        int             candidates[MAXIMUM_BEACONS][MAXIMUM_CANDIDATES];    // individually compatible landmarks of every beacon
+        unsigned short  counts[MAXIMUM_BEACONS];                            // number of compatible landmarks of every beacon
+        
+        int             hypothesis[MAXIMUM_BEACONS];                        // landmark of every beacon in the current hypothesis, or -1
+        unsigned short  pairings;                                           // number of pairings of the current hypothesis
+        unsigned short  paired[MAXIMUM_BEACONS];                            // beacons of the current hypothesis, in order of their rows
+        float           l[2*MAXIMUM_BEACONS][2*MAXIMUM_BEACONS];            // cholesky factor of the covariance matrix of the joint innovation
+        float           v[2*MAXIMUM_BEACONS];                               // joint innovation, multiplied with the inverse cholesky factor
+        
+        int             best[MAXIMUM_BEACONS];                              // landmark of every beacon in the best hypothesis, or -1
+        unsigned short  bestPairings;                                       // number of pairings of the best hypothesis
+        float           bestDistance;                                       // joint squared Mahalanobis distance of the best hypothesis
+        
+        unsigned int    nodes;                                              // number of nodes expanded in the last association
+        bool            truncated;                                          // flag that the search was stopped by the node limit
+        
+        void            search(unsigned short i, float distance);
+        bool            extend(unsigned short i, int landmark, float& distance);
+};
+
+#endif /* JOINT_COMPATIBILITY_H_ */
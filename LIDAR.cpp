@@ -9,39 +9,65 @@
 
 using namespace std;
 
-const float LIDAR::DISTANCE_THRESHOLD = 0.01f;  // threshold for measured distance, given in [m]
-const float LIDAR::DEFAULT_DISTANCE = 10.0f;    // default distance > range of sensor, given in [m]
-const float LIDAR::M_PI = 3.1415926535897932f;  // the mathematical constant PI
+const float LIDAR::PERIOD = 0.01f;               // period of the receiver thread, given in [s]
+const float LIDAR::DISTANCE_THRESHOLD = 0.01f;   // threshold for measured distance, given in [m]
+const float LIDAR::DEFAULT_DISTANCE = 10.0f;     // default distance > range of sensor, given in [m]
+const float LIDAR::M_PI = 3.1415926535897932f;   // the mathematical constant PI
+const float LIDAR::SEGMENT_THRESHOLD = 0.1f;     // range discontinuity that separates two segments of a scan, given in [m]
+const float LIDAR::BEACON_MAXIMUM_RANGE = 3.0f;  // maximum distance of a beacon, given in [m]
+const float LIDAR::BEACON_MAXIMUM_WIDTH = 0.15f; // maximum width of a beacon, given in [m]
+const float LIDAR::BEACON_CLEARANCE = 0.3f;      // minimum distance of a beacon in front of its neighbouring segments, given in [m]
+const float LIDAR::PIPE_RADIUS = 0.055f;         // radius of the pipes that are used as beacons, given in [m]
 const float LIDAR::DISTANCES[] = {10.0f, 10.0f, 10.0f, 10.0f, 10.0f, 10.0f, 10.0f, 10.0f, 10.0f, 10.0f, 10.0f, 10.0f, 10.0f, 10.0f, 10.0f, 10.0f, 10.0f, 1.702465271f, 1.699141254f, 1.69632544f, 1.692140952f, 1.689068974f, 1.68018005f, 1.676267878f, 1.666183663f, 1.671424841f, 1.66193261f, 1.655635528f, 1.653413439f, 1.653517463f, 1.657246512f, 1.655132925f, 1.650946698f, 1.65257254f, 1.66468045f, 1.23646674f, 1.236336928f, 1.251003597f, 1.353653575f, 1.322500662f, 1.304577326f, 1.299988461f, 1.314887448f, 1.320968206f, 1.320374568f, 1.251579003f, 1.235510016f, 1.233241663f, 1.243382483f, 1.314194811f, 1.318788838f, 1.438384163f, 1.419872177f, 1.368804223f, 1.347354445f, 1.342721118f, 1.354318279f, 1.366872708f, 1.369305298f, 1.383822604f, 1.508895291f, 1.493255504f, 1.475824515f, 1.435599178f, 1.445460826f, 1.462035909f, 1.654100964f, 1.644884494f, 1.707480307f, 1.701130213f, 1.660187941f, 1.634974006f, 1.61723344f, 1.620856564f, 1.798737613f, 1.779742116f, 1.77366344f, 1.77661504f, 1.777926039f, 1.920203375f, 1.935389367f, 2.291142292f, 2.328650253f, 2.363611643f, 2.448420103f, 2.487483266f, 2.57330313f, 2.545476969f, 2.040235771f, 2.028301999f, 2.014f, 1.98730823f, 1.972207393f, 1.955661781f, 1.944761168f, 1.923351242f, 1.909502815f, 1.903193369f, 1.875251983f, 1.874046424f, 1.857301806f, 1.845873235f, 1.837153505f, 1.817614371f, 1.803495495f, 1.796232168f, 1.784177401f, 1.781868963f, 1.775984797f, 1.764001134f, 1.761087448f, 1.753326267f, 1.75371748f, 1.745729933f, 1.742740658f, 1.737636613f, 1.741089889f, 1.735240617f, 1.735295076f, 1.728695462f, 1.720377865f, 1.657877257f, 1.727796574f, 1.734111011f, 1.729579429f, 1.736116356f, 1.743193908f, 1.745805545f, 1.750349965f, 1.750429662f, 1.754628166f, 1.760757223f, 1.766661541f, 1.766717012f, 1.776524697f, 1.161069335f, 1.148512081f, 1.14054373f, 1.135753494f, 1.134139321f, 1.147087617f, 1.168199041f, 1.17903223f, 1.18040205f, 1.183327934f, 1.147416228f, 1.210927331f, 1.217378331f, 1.203945597f, 1.227244067f, 1.237879235f, 0.547902364f, 0.544882556f, 0.548745843f, 0.548314691f, 0.553859188f, 0.558237405f, 0.562782374f, 0.572875205f, 0.577382023f, 0.587456381f, 0.593270596f, 0.595157122f, 10.0f, 10.0f, 10.0f, 10.0f, 10.0f, 10.0f, 10.0f, 10.0f, 10.0f, 10.0f, 10.0f, 10.0f, 1.826932128f, 1.764292776f, 1.757409742f, 1.728041956f, 1.704264064f, 1.688f, 1.679250428f, 1.66501051f, 1.644250589f, 1.634979205f, 1.626211548f, 1.608795823f, 1.589880499f, 1.58137788f, 1.575325998f, 1.560708173f, 1.550516043f, 1.54374253f, 1.532342651f, 1.520213472f, 1.512674783f, 1.507533416f, 1.497487229f, 1.494217186f, 1.48919072f, 1.232154617f, 1.358305194f, 1.313616382f, 1.260025397f, 1.133025154f, 1.117565658f, 1.100202254f, 1.100181803f, 1.169824773f, 1.168748476f, 1.164819729f, 1.220040983f, 1.203097669f, 1.200735191f, 1.189294329f, 1.186247866f, 1.195532517f, 1.229603188f, 1.472497538f, 1.474618595f, 1.479985473f, 1.480043918f, 1.484135439f, 1.490767923f, 1.496454476f, 1.501894803f, 1.511313667f, 1.516939682f, 1.525908582f, 1.535359893f, 1.544518695f, 1.549271119f, 1.555904881f, 1.575204114f, 1.580785248f, 0.959320593f, 0.920540059f, 0.905058009f, 0.900680298f, 0.898481497f, 0.902731965f, 0.918059911f, 1.718295085f, 1.721370675f, 1.735719159f, 1.763130455f, 1.775434595f, 1.817423726f, 1.836723441f, 1.847665825f, 1.884798663f, 1.897461462f, 1.83701742f, 1.811276898f, 1.759177649f, 1.740189932f, 1.702600364f, 1.687345845f, 1.637890411f, 1.604450373f, 1.589151031f, 1.55510289f, 1.544042098f, 1.516327801f, 1.502226681f, 1.479634076f, 1.483579792f, 1.518056982f, 1.568964308f, 1.602244675f, 1.663f, 1.700264685f, 1.771085543f, 1.812491379f, 1.888618543f, 1.937385093f, 2.032088827f, 2.089617429f, 2.205471605f, 2.275026373f, 2.345580738f, 2.499928999f, 2.581471286f, 2.784285366f, 2.885689519f, 2.858447306f, 2.850508025f, 2.832713364f, 2.828422882f, 2.812354352f, 2.808188206f, 2.789411407f, 2.789161343f, 2.77675368f, 2.765194568f, 1.967565247f, 1.958f, 2.397585661f, 2.75211991f, 2.743884108f, 2.743676366f, 2.746035688f, 2.735854528f, 10.0f, 10.0f, 10.0f, 2.76492206f, 2.761207888f, 2.762739582f, 2.766510618f, 2.788146338f, 2.786430153f, 2.801847426f, 2.811054073f, 2.691653024f, 2.664378352f, 2.401709391f, 2.204667775f, 2.12351713f, 2.141373625f, 2.14578121f, 2.165700349f, 2.171425799f, 2.185005721f, 2.197850768f, 2.21938122f, 2.229375025f, 2.23809964f, 2.265003532f, 2.644680132f, 2.54522003f, 2.527676008f, 2.480120158f, 2.52638279f, 2.386449455f, 2.36217802f, 2.291129198f, 2.094351451f, 2.007193314f, 2.009421807f, 2.047382719f, 2.035974951f, 1.865168089f, 1.820468346f, 1.800660157f, 1.80447721f, 1.836480329f, 1.730293906f, 1.678679541f, 1.66250203f, 1.677434052f, 1.719175675f, 1.720679226f, 1.622129465f, 1.618845576f, 1.634181141f, 10.0f, 10.0f, 10.0f, 10.0f};
 
+/**
+ * Creates a LIDAR object that operates the laser scanner with a standard scan.
+ * @param stream a reference to a byte stream to communicate with the laser scanner.
+ */
+LIDAR::LIDAR(ByteStream& stream) : LIDAR(stream, STANDARD) {}
+
 /**
  * Creates a LIDAR object.
- * @param serial a reference to a serial interface to communicate with the laser scanner.
+ * @param stream a reference to a byte stream to communicate with the laser scanner.
+ * @param mode the scan mode of the laser scanner, either <code>LIDAR::STANDARD</code> or <code>LIDAR::EXPRESS</code>.
  */
-LIDAR::LIDAR(UnbufferedSerial& serial) : serial(serial) {
-    
-    // initialize serial interface
-    
-    serial.baud(115200);
-    serial.format(8, SerialBase::None, 1);
+LIDAR::LIDAR(ByteStream& stream, int mode) : stream(stream), thread(osPriorityBelowNormal, STACK_SIZE) {
     
     // initialize local values
     
-    headerCounter = 0;
-    dataCounter = 0;
+    for (unsigned short i = 0; i < SCAN_BUFFERS; i++) {
+        sizes[i] = 0;
+        timestamps[i] = 0;
+    }
+    
+    for (unsigned short i = 0; i < 360; i++) {
+        cosines[i] = cos((float)i*M_PI/180.0f);
+        sines[i] = sin((float)i*M_PI/180.0f);
+    }
     
-    for (unsigned short i = 0; i < 360; i++) distances[i] = DEFAULT_DISTANCE;
+    revolution = 0;
+    batchTime = 0;
     
     simulation = true;
     
-    // start serial interrupt
+    // start thread and timer interrupt
     
-    serial.attach(callback(this, &LIDAR::receive), UnbufferedSerial::RxIrq);
+    thread.start(callback(this, &LIDAR::run));
+    ticker.attach(callback(this, &LIDAR::sendThreadFlag), PERIOD);
     
     // start the continuous operation of the LIDAR
     
-    char bytes[] = {START_FLAG, SCAN};
-    serial.write(&bytes, 2);
+    if (mode == EXPRESS) {
+        
+        char bytes[] = {START_FLAG, EXPRESS_SCAN, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+        for (unsigned short i = 0; i < 8; i++) bytes[8] ^= bytes[i];
+        stream.write(bytes, 9);
+        
+    } else {
+        
+        char bytes[] = {START_FLAG, SCAN};
+        stream.write(bytes, 2);
+    }
 }
 
 /**
@@ -49,165 +75,332 @@ LIDAR::LIDAR(UnbufferedSerial& serial) : serial(serial) {
  */
 LIDAR::~LIDAR() {
     
+    ticker.detach(); // stop the timer interrupt
+    
     // stop the LIDAR
     
     char bytes[] = {START_FLAG, STOP};
-    serial.write(&bytes, 2);
+    stream.write(bytes, 2);
 }
 
 /**
- * Get a list of points of a full 360 degree scan.
- * @return a deque vector of 360 point objects.
+ * Gets the number of full revolutions the LIDAR has completed so far.
+ * This allows to skip the processing of scans when no new revolution has been
+ * received. While the scans are only simulated, this method always returns 0.
+ * @return the number of completed revolutions.
  */
-deque<Point> LIDAR::getScan() {
+unsigned int LIDAR::getRevolution() {
     
-    deque<Point> scan;
+    return core_util_atomic_load_u32(&revolution);
+}
+
+/**
+ * Gets the number of valid measurement frames received from the LIDAR.
+ */
+unsigned int LIDAR::getFrames() {
     
-    for (unsigned short i = 0; i < 360; i++) {
+    return parser.getFrames();
+}
+
+/**
+ * Gets the number of received bytes that were discarded because of invalid start bits.
+ */
+unsigned int LIDAR::getSyncErrors() {
+    
+    return parser.getSyncErrors();
+}
+
+/**
+ * Gets the number of received bytes that were discarded because of an invalid check bit.
+ */
+unsigned int LIDAR::getCheckErrors() {
+    
+    return parser.getCheckErrors();
+}
+
+/**
+ * Gets the points of the latest complete 360 degree scan.
+ * The scan is read without locks from a buffer that the receiver does not write into.
+ * If the receiver completes so many revolutions while the scan is read that it reuses
+ * this buffer, the scan is read again from the latest buffer.
+ * <br/>
+ * The cosine and sine of every angle are taken from tables with one entry per degree,
+ * corrected for the fraction of a degree with a small angle approximation.
+ * @param scan a reference to a scan object that is filled with the points of the scan,
+ * in the order of the measurements. This scan also gets the number of the revolution
+ * and the time when this revolution was completed.
+ */
+void LIDAR::getScan(Scan& scan) {
+    
+    if (simulation) {
+        
+        // use simulated distances, because LIDAR is not available
+        
+        scan.clear();
+        scan.timestamp = us_ticker_read();
+        
+        for (unsigned short i = 0; i < 360; i++) {
+            scan.add(DISTANCES[i]-0.002f*(rand()%10), (float)i*M_PI/180.0f, cosines[i], sines[i], scan.timestamp);
+        }
         
-        if (simulation) {
+    } else {
+        
+        // use latest complete revolution from actual LIDAR
+        
+        do {
             
-            // use simulated distances, because LIDAR is not available
+            scan.clear();
             
-            scan.push_back(Point(DISTANCES[i]-0.002f*(rand()%10), (float)i*M_PI/180.0f));
+            scan.revolution = core_util_atomic_load_u32(&revolution);
+            unsigned short buffer = scan.revolution%SCAN_BUFFERS;
+            scan.timestamp = timestamps[buffer];
             
-        } else {
+            for (unsigned short i = 0; i < sizes[buffer]; i++) {
+                
+                float distance = (distances[buffer][i] > 0) ? (float)distances[buffer][i]/4000.0f : DEFAULT_DISTANCE;
+                
+                // mirror the angle, because the LIDAR turns clockwise, and split it into degrees and a fraction
+                
+                unsigned short angle = (FULL_ANGLE-angles[buffer][i])%FULL_ANGLE;
+                unsigned short degree = angle/64;
+                float fraction = (float)(angle%64)*M_PI/180.0f/64.0f;
+                
+                float cosFraction = 1.0f-0.5f*fraction*fraction;
+                float cosAlpha = cosines[degree]*cosFraction-sines[degree]*fraction;
+                float sinAlpha = sines[degree]*cosFraction+cosines[degree]*fraction;
+                
+                scan.add(distance, (float)angle*M_PI/180.0f/64.0f, cosAlpha, sinAlpha, times[buffer][i]);
+            }
             
-            // use latest measurements from actual LIDAR
+        } while (core_util_atomic_load_u32(&revolution)-scan.revolution > SCAN_BUFFERS-2);
+    }
+}
+
+/**
+ * Gets the points of the latest complete 360 degree scan, compensated for the motion
+ * of the robot during this scan. Every point is transformed from the pose of the robot
+ * at the time of its measurement into the pose of the robot at the time when the
+ * revolution was completed, i.e. at the timestamp of the scan.
+ * Points measured earlier than the poses in the given history, and points without a valid
+ * measurement, are not compensated.
+ * <br/>
+ * The poses during this scan are copied from the history once, so that the history
+ * is not read for every point, while the controller adds poses to it.
+ * @param scan a reference to a scan object that is filled with the points of the scan.
+ * @param poseHistory a reference to a history of the poses of the robot.
+ */
+void LIDAR::getScan(Scan& scan, PoseHistory& poseHistory) {
+    
+    getScan(scan);
+    
+    if (scan.size == 0) return;
+    if (!poseHistory.getSpan(scan.time[0], scan.timestamp, span)) return;
+    
+    float x0 = 0.0f;
+    float y0 = 0.0f;
+    float alpha0 = 0.0f;
+    
+    if (!span.get(scan.timestamp, x0, y0, alpha0)) return;
+    
+    float cosAlpha0 = cos(alpha0);
+    float sinAlpha0 = sin(alpha0);
+    
+    for (unsigned short i = 0; i < scan.size; i++) {
+        
+        float x = 0.0f;
+        float y = 0.0f;
+        float alpha = 0.0f;
+        
+        if ((scan.r[i] < DEFAULT_DISTANCE) && span.get(scan.time[i], x, y, alpha)) {
+            
+            // calculate the pose of the robot at the time of this measurement relative to the reference pose
+            
+            float deltaX = cosAlpha0*(x-x0)+sinAlpha0*(y-y0);
+            float deltaY = -sinAlpha0*(x-x0)+cosAlpha0*(y-y0);
+            float deltaAlpha = alpha-alpha0;
+            
+            // transform the point into the reference pose
             
-            scan.push_back(Point(distances[i], (float)i*M_PI/180.0f));
+            float cosDeltaAlpha = cos(deltaAlpha);
+            float sinDeltaAlpha = sin(deltaAlpha);
+            
+            float pointX = cosDeltaAlpha*scan.x[i]-sinDeltaAlpha*scan.y[i]+deltaX;
+            float pointY = sinDeltaAlpha*scan.x[i]+cosDeltaAlpha*scan.y[i]+deltaY;
+            
+            scan.x[i] = pointX;
+            scan.y[i] = pointY;
+            scan.r[i] = sqrt(pointX*pointX+pointY*pointY);
+            scan.alpha[i] = atan2(pointY, pointX);
         }
     }
-    
-    return scan;
 }
 
 /**
- * Get a list of points which are part of beacons.
- * @return a deque vector of points that are beacons.
+ * Gets the beacons in a scan, i.e. the centers of pipes.
+ * The scan is split into segments at range discontinuities between neighbouring angles.
+ * Segments that are narrow, close enough and stand out in front of both of their
+ * neighbours are classified as beacons. This requires only a single pass over the scan.
+ * The center of every beacon is obtained by fitting a circle with the radius of a pipe
+ * to the points of the segment.
+ * @param scan a reference to a scan, as obtained with the <code>getScan()</code> method.
+ * @param beacons an array that is filled with one beacon object per pipe.
+ * @param capacity the size of the array of beacons.
+ * @return the number of beacons found, at most the given capacity.
  */
-deque<Point> LIDAR::getBeacons() {
-    deque<Point> scan = getScan();
-    deque<Point> beacons;
-
+unsigned short LIDAR::getBeacons(Scan& scan, Beacon beacons[], unsigned short capacity) {
     
-    // check the points of a scan for beacons
+    unsigned short size = scan.size;
+    unsigned short n = 0;
     
-    for (unsigned short i = 0; i < scan.size(); i++) {
-        
-        bool beacon = true; // flag to check if this point is possibly a beacon
-        int counter = 0;
+    if (size < BEACON_MINIMUM_SIZE) return n;
+    
+    float* r = scan.r;
+    
+    // start at a range discontinuity, so that no segment is split at the end of the scan
+    
+    unsigned short start = 0;
+    for (unsigned short i = 0; i < size; i++) {
+        if (fabs(r[i]-r[(i+size-1)%size]) > SEGMENT_THRESHOLD) {
+            start = i;
+            break;
+        }
+    }
+    
+    // walk through the scan once and classify every segment
+    
+    unsigned short first = start;
+    
+    for (unsigned short k = 1; (k <= size) && (n < capacity); k++) {
         
-        // check distance to other points
+        unsigned short i = (start+k)%size;
+        unsigned short previous = (i+size-1)%size;
         
-        for (unsigned short j = 0; beacon && (j < scan.size()); j++) {
+        if ((k == size) || (fabs(r[i]-r[previous]) > SEGMENT_THRESHOLD)) {
             
-            float distance = scan[i].manhattanDistance(scan[j]);
-            if (distance < 0.1f) {
+            // the segment from 'first' to 'previous' is complete
+            
+            unsigned short last = previous;
+            unsigned short count = (last+size-first)%size+1;
+            
+            float rangeBefore = r[(first+size-1)%size];
+            float rangeAfter = r[(last+1)%size];
+            
+            float width = sqrt((scan.x[first]-scan.x[last])*(scan.x[first]-scan.x[last])+(scan.y[first]-scan.y[last])*(scan.y[first]-scan.y[last]));
+            
+            if ((count >= BEACON_MINIMUM_SIZE) && (count <= BEACON_MAXIMUM_SIZE)
+                    && (r[first] < BEACON_MAXIMUM_RANGE) && (r[last] < BEACON_MAXIMUM_RANGE)
+                    && (rangeBefore-r[first] > BEACON_CLEARANCE) && (rangeAfter-r[last] > BEACON_CLEARANCE)
+                    && (width < BEACON_MAXIMUM_WIDTH)) {
                 
-                counter++; // another point which may be part of this beacon
+                float x[BEACON_MAXIMUM_SIZE];
+                float y[BEACON_MAXIMUM_SIZE];
                 
-            } else if (distance < 0.5f) {
+                for (unsigned short j = 0; j < count; j++) {
+                    x[j] = scan.x[(first+j)%size];
+                    y[j] = scan.y[(first+j)%size];
+                }
                 
-                beacon = false; // this point cannot be part of a beacon
+                if (beacons[n].fit(x, y, count, PIPE_RADIUS)) n++;
             }
+            
+            first = i;
         }
-        
-        if (beacon && (counter > 1)) beacons.push_back(scan[i]);
     }
     
+    return n;
+}
 
+/**
+ * This method is called by the ticker timer interrupt service routine.
+ * It sends a flag to the thread to make it run again.
+ */
+void LIDAR::sendThreadFlag() {
+    
+    thread.flags_set(threadFlag);
+}
 
-    // Durchlaufe den Scan und identifiziere potenzielle Beacons
-    for (size_t i = 1; i < scan.size() - 1; ++i) {
-        Point current = scan[i];
-        Point prev = scan[i - 1];
-        Point next = scan[i + 1];
-
-        // Überprüfe, ob der Abstand des aktuellen Punktes innerhalb der Grenzwerte liegt
-        if (current.distance() <= 3.0f) {
-            // Überprüfe, ob es mindestens einen weiteren Punkt weniger als 0.1 Meter entfernt gibt
-            bool nearbyPointFound = false;
-            for (size_t j = i + 1; j < scan.size(); ++j) {
-                if (abs(scan[j].distance() - current.distance()) <= 0.1f) {
-                    nearbyPointFound = true;
-                    break;
-                }
-            }
-
-            // Überprüfe, ob der Punkt Teil des Rohrs ist
-            if (nearbyPointFound) {
-                // Überprüfe, ob andere Punkte entweder auf demselben Rohr oder ganz woanders liegen
-                bool isolated = true;
-                for (size_t j = 0; j < scan.size(); ++j) {
-                    if (j != i && abs(scan[j].distance() - current.distance()) <= 0.1f) {
-                        isolated = false;
-                        break;
-                    }
-                    if (j != i && abs(scan[j].distance() - current.distance()) > 0.5f) {
-                        isolated = false;
-                        break;
-                    }
-                }
-
-                // Füge den Punkt als Beacon hinzu, wenn er die Bedingungen erfüllt
-                if (isolated) {
-                    beacons.push_back(current);
-                }
-            }
-        }
+/**
+ * This is an internal method of the LIDAR that is running periodically.
+ * It reads all bytes that were received since its last run.
+ */
+void LIDAR::run() {
+    
+    while (true) {
+        
+        // wait for the periodic thread flag
+        
+        ThisThread::flags_wait_any(threadFlag);
+        
+        // read received bytes in bulk until the stream is empty
+        
+        char bytes[READ_SIZE];
+        int size = 0;
+        
+        do {
+            
+            // estimate the time of reception of every byte, assuming the last byte was just received
+            
+            uint32_t time = us_ticker_read();
+            size = stream.read(bytes, READ_SIZE);
+            
+            for (int i = 0; i < size; i++) receive(bytes[i], time-(uint32_t)(size-1-i)*BYTE_TIME);
+            
+        } while (size == READ_SIZE);
     }
-
-    return beacons;
 }
 
-
-
 /**
- * This method is called by the serial interrupt service routine.
- * It handles the reception of measurements from the LIDAR.
+ * Handles the reception of measurements from the LIDAR.
+ * The measurements of an express scan packet were taken during the interval
+ * between the previous and this packet, so their times are spread over this interval.
+ * @param byte a byte that was received from the LIDAR.
+ * @param time the estimated time of reception of this byte, given in [us].
  */
-void LIDAR::receive() {
+void LIDAR::receive(char byte, uint32_t time) {
     
-    // read received characters while input buffer is full
+    // parse this byte and process all measurements it completed
     
-    if (serial.readable()) {
+    unsigned short measurements = parser.parse(byte);
+    if (measurements == 0) return;
+    
+    uint32_t interval = (measurements > 1) ? time-batchTime : 0;
+    if (interval > MAXIMUM_INTERVAL) interval = 0;  // a packet was lost, the interval is unknown
+    batchTime = time;
+    
+    for (unsigned short j = 0; j < measurements; j++) {
         
-        // read single character from serial interface
+        uint32_t measurementTime = time-interval-(uint32_t)(measurements-1-j)*interval/measurements;
         
-        char byte = 0;
-        serial.read(&byte, 1);
+        char quality = parser.getQuality(j);
+        unsigned short angle = parser.getAngle(j);
+        unsigned short distance = parser.getDistance(j);
         
-        // add this character to the header or to the data buffer
+        if ((quality < QUALITY_THRESHOLD) || ((float)distance/4000.0f < DISTANCE_THRESHOLD)) distance = 0;
         
-        if (headerCounter < HEADER_SIZE) {
-            headerCounter++;
-        } else {
-            if (dataCounter < DATA_SIZE) {
-                data[dataCounter] = byte;
-                dataCounter++;
-            }
-            if (dataCounter >= DATA_SIZE) {
-                
-                // data buffer is full, process measurement
-                
-                char quality = data[0] >> 2;
-                short angle = 360-(((unsigned short)data[1] | ((unsigned short)data[2] << 8)) >> 1)/64;
-                float distance = (float)((unsigned short)data[3] | ((unsigned short)data[4] << 8))/4000.0f;
-                
-                if ((quality < QUALITY_THRESHOLD) || (distance < DISTANCE_THRESHOLD)) distance = DEFAULT_DISTANCE;
-                
-                // store distance in [m] into array of full scan
-                
-                while (angle < 0) angle += 360;
-                while (angle >= 360) angle -= 360;
-                distances[angle] = distance;
-                
-                // reset data counter and simulation flag
-                
-                dataCounter = 0;
-                simulation = false;
-            }
+        // publish the completed revolution when a new scan starts
+        
+        unsigned short buffer = (revolution+1)%SCAN_BUFFERS;
+        
+        if (parser.getStart(j)) {
+            
+            timestamps[buffer] = measurementTime;
+            core_util_atomic_store_u32(&revolution, revolution+1);
+            
+            buffer = (revolution+1)%SCAN_BUFFERS;
+            sizes[buffer] = 0;
+        }
+        
+        // append measurement to the scan that is received
+        
+        if (sizes[buffer] < SCAN_CAPACITY) {
+            angles[buffer][sizes[buffer]] = angle;
+            distances[buffer][sizes[buffer]] = distance;
+            times[buffer][sizes[buffer]] = measurementTime;
+            sizes[buffer]++;
         }
+        
+        // reset simulation flag
+        
+        simulation = false;
     }
 }
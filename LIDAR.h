@@ -8,46 +8,93 @@
 #define LIDAR_H_
 
 #include <cstdlib>
-#include <deque>
 #include <mbed.h>
 #include "Point.h"
+#include "Beacon.h"
+#include "Scan.h"
+#include "PoseHistory.h"
+#include "ByteStream.h"
+#include "LIDARParser.h"
+#include "ThreadFlag.h"
 
 /**
  * This is a device driver class for the Slamtec RP LIDAR A1.
+ * The LIDAR can be operated with a standard scan, which delivers about 2000
+ * measurements per second, or with an express scan, which delivers about 4000
+ * measurements per second and thus a finer angular resolution.
+ * <br/>
+ * The received bytes are read in bulk from a byte stream by a periodic thread with
+ * a lower priority than the controller, and not by an interrupt for every byte.
  */
 class LIDAR {
     
     public:
         
-                        LIDAR(UnbufferedSerial& serial);
+        static const int    STANDARD = 0;       /**< Mode for a standard scan. */
+        static const int    EXPRESS = 1;        /**< Mode for an express scan. */
+        static const float  DEFAULT_DISTANCE;   /**< Distance of points without a valid measurement, given in [m]. */
+        
+                        LIDAR(ByteStream& stream);
+                        LIDAR(ByteStream& stream, int mode);
         virtual         ~LIDAR();
-        deque<Point>    getScan();
-        deque<Point>    getBeacons();
+        unsigned int    getFrames();
+        unsigned int    getSyncErrors();
+        unsigned int    getCheckErrors();
+        unsigned int    getRevolution();
+        void            getScan(Scan& scan);
+        void            getScan(Scan& scan, PoseHistory& poseHistory);
+        unsigned short  getBeacons(Scan& scan, Beacon beacons[], unsigned short capacity);
         
     private:
         
-        static const unsigned short HEADER_SIZE = 7;
-        static const unsigned short DATA_SIZE = 5;
+        static const unsigned int   STACK_SIZE = 4096;  // stack size of thread, given in [bytes]
+        static const unsigned short READ_SIZE = 256;    // maximum number of bytes read from the stream at once
+        static const float          PERIOD;             // period of the receiver thread, given in [s]
+        static const uint32_t       BYTE_TIME = 87;     // time to receive one byte with 115200 baud, given in [us]
+        static const uint32_t       MAXIMUM_INTERVAL = 20000;   // maximum interval between two express scan packets, given in [us]
+        
+        static const unsigned short SCAN_BUFFERS = 4;   // number of scan buffers, the receiver writes into one while the others can be read
+        static const unsigned short SCAN_CAPACITY = Scan::CAPACITY; // maximum number of measurements of a scan
+        static const unsigned short FULL_ANGLE = 360*64;    // full revolution, given in [1/64 deg]
         
         static const char   START_FLAG = 0xA5;
         static const char   SCAN = 0x20;
         static const char   STOP = 0x25;
         static const char   RESET = 0x40;
+        static const char   EXPRESS_SCAN = 0x82;
         
         static const char   QUALITY_THRESHOLD = 10;     // quality threshold used for accepting measurements
+        static const unsigned short BEACON_MINIMUM_SIZE = 2;    // minimum number of points of a beacon
+        static const unsigned short BEACON_MAXIMUM_SIZE = 64;   // maximum number of points of a beacon
         static const float  DISTANCE_THRESHOLD;         // threshold for measured distance, given in [m]
-        static const float  DEFAULT_DISTANCE;           // default distance > range of sensor, given in [m]
         static const float  M_PI;                       // the mathematical constant PI
+        static const float  SEGMENT_THRESHOLD;          // range discontinuity that separates two segments of a scan, given in [m]
+        static const float  BEACON_MAXIMUM_RANGE;       // maximum distance of a beacon, given in [m]
+        static const float  BEACON_MAXIMUM_WIDTH;       // maximum width of a beacon, given in [m]
+        static const float  BEACON_CLEARANCE;           // minimum distance of a beacon in front of its neighbouring segments, given in [m]
+        static const float  PIPE_RADIUS;                // radius of the pipes that are used as beacons, given in [m]
         static const float  DISTANCES[];                // simulated distance for every angle value, given in [m]
         
-        UnbufferedSerial&   serial;             // reference to serial interface for communication
-        char                headerCounter;
-        char                dataCounter;
-        char                data[DATA_SIZE];
-        float               distances[360];     // measured distance for every angle value, given in [m]
+        ByteStream&         stream;             // reference to byte stream for communication
+        LIDARParser         parser;             // parser for the responses of the LIDAR
+        unsigned short      angles[SCAN_BUFFERS][SCAN_CAPACITY];    // measured angles in the order of reception, given in [1/64 deg]
+        unsigned short      distances[SCAN_BUFFERS][SCAN_CAPACITY]; // measured distances, or 0 for invalid measurements, given in [1/4 mm]
+        uint32_t            times[SCAN_BUFFERS][SCAN_CAPACITY];     // estimated times of the measurements, given in [us]
+        unsigned short      sizes[SCAN_BUFFERS];            // number of measurements in every scan buffer
+        uint32_t            batchTime;          // time when the latest measurements were decoded, given in [us]
+        float               cosines[360];       // cosine for every degree
+        float               sines[360];         // sine for every degree
+        uint32_t            timestamps[SCAN_BUFFERS];       // time when a revolution was completed, given in [us]
+        volatile uint32_t   revolution;                     // number of completed revolutions, the latest is in buffer 'revolution%SCAN_BUFFERS'
         bool                simulation;         // flag to indicate if scans are only simulated
+        PoseHistory         span;               // poses of the robot during the latest scan, copied from the pose history
+        ThreadFlag          threadFlag;
+        Thread              thread;
+        Ticker              ticker;
         
-        void    receive();
+        void    sendThreadFlag();
+        void    run();
+        void    receive(char byte, uint32_t time);
 };
 
 #endif /* LIDAR_H_ */
@@ -0,0 +1,340 @@
+/*
+ * LIDARParser.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include "LIDARParser.h"
+
+using namespace std;
+
+const unsigned char LIDARParser::DESCRIPTOR[] = {0xA5, 0x5A, 0x05, 0x00, 0x00, 0x40, 0x81};
+
+/**
+ * Creates a LIDARParser object.
+ */
+LIDARParser::LIDARParser() {
+    
+    frames = 0;
+    syncErrors = 0;
+    checkErrors = 0;
+    
+    express = false;
+    
+    reset();
+}
+
+/**
+ * Deletes this object.
+ */
+LIDARParser::~LIDARParser() {}
+
+/**
+ * Resets the state of this parser, but not its error counters.
+ */
+void LIDARParser::reset() {
+    
+    descriptorCounter = 0;
+    descriptorLength = 0;
+    counter = 0;
+    previousValid = false;
+    
+    for (unsigned short i = 0; i < MAXIMUM_MEASUREMENTS; i++) {
+        quality[i] = 0;
+        angle[i] = 0;
+        distance[i] = 0;
+        start[i] = false;
+    }
+}
+
+/**
+ * Parses a byte that was received from the LIDAR.
+ * @param byte the received byte.
+ * @return the number of measurements that were completed by this byte.
+ */
+unsigned short LIDARParser::parse(char byte) {
+    
+    unsigned char value = (unsigned char)byte;
+    
+    if (parseDescriptor(value)) return 0;
+    
+    return express ? parsePacket(value) : parseFrame(value);
+}
+
+/**
+ * Gets the quality of a measurement that was completed by the latest byte.
+ * @param i the index of the measurement.
+ * @return the quality of the measurement, a value between 0 and 63.
+ */
+char LIDARParser::getQuality(unsigned short i) {
+    
+    return quality[i];
+}
+
+/**
+ * Gets the angle of a measurement that was completed by the latest byte.
+ * @param i the index of the measurement.
+ * @return the angle of the measurement, given in [1/64 deg], always less than 360 deg.
+ */
+unsigned short LIDARParser::getAngle(unsigned short i) {
+    
+    return angle[i];
+}
+
+/**
+ * Gets the distance of a measurement that was completed by the latest byte.
+ * @param i the index of the measurement.
+ * @return the distance of the measurement, given in [1/4 mm].
+ */
+unsigned short LIDARParser::getDistance(unsigned short i) {
+    
+    return distance[i];
+}
+
+/**
+ * Checks if a measurement that was completed by the latest byte is the first of a new scan.
+ * @param i the index of the measurement.
+ * @return <code>true</code> if a new scan started, <code>false</code> otherwise.
+ */
+bool LIDARParser::getStart(unsigned short i) {
+    
+    return start[i];
+}
+
+/**
+ * Gets the number of valid frames or packets that were received.
+ */
+unsigned int LIDARParser::getFrames() {
+    
+    return frames;
+}
+
+/**
+ * Gets the number of bytes that were discarded because of invalid start bits or sync nibbles.
+ */
+unsigned int LIDARParser::getSyncErrors() {
+    
+    return syncErrors;
+}
+
+/**
+ * Gets the number of bytes that were discarded because of an invalid check bit or checksum.
+ */
+unsigned int LIDARParser::getCheckErrors() {
+    
+    return checkErrors;
+}
+
+/**
+ * Looks for a response descriptor of a standard or an express scan.
+ * When a descriptor is complete, the frames or packets are aligned with its end.
+ * @param value the received byte.
+ * @return <code>true</code> if this byte completed a response descriptor, <code>false</code> otherwise.
+ */
+bool LIDARParser::parseDescriptor(unsigned char value) {
+    
+    bool match = false;
+    
+    if (descriptorCounter == 2) {
+        match = (value == DESCRIPTOR[2]) || (value == EXPRESS_LENGTH);
+        descriptorLength = value;
+    } else if (descriptorCounter == DESCRIPTOR_SIZE-1) {
+        match = (value == ((descriptorLength == EXPRESS_LENGTH) ? EXPRESS_TYPE : DESCRIPTOR[DESCRIPTOR_SIZE-1]));
+    } else {
+        match = (value == DESCRIPTOR[descriptorCounter]);
+    }
+    
+    if (match) {
+        descriptorCounter++;
+    } else {
+        descriptorCounter = (value == DESCRIPTOR[0]) ? 1 : 0;
+    }
+    
+    if (descriptorCounter >= DESCRIPTOR_SIZE) {
+        
+        express = (descriptorLength == EXPRESS_LENGTH);
+        
+        descriptorCounter = 0;
+        counter = 0;
+        previousValid = false;
+        
+        return true;
+    }
+    
+    return false;
+}
+
+/**
+ * Parses a byte of a standard scan measurement frame.
+ * @param value the received byte.
+ * @return the number of measurements that were completed by this byte, either 0 or 1.
+ */
+unsigned short LIDARParser::parseFrame(unsigned char value) {
+    
+    // add this byte to the frame buffer and check the frame as early as possible,
+    // bytes that may be part of a response descriptor are discarded without counting an error
+    
+    buffer[counter++] = value;
+    
+    if ((counter == 1) && !validStartBits(buffer[0])) {
+        
+        if (descriptorCounter == 0) syncErrors++;
+        counter = 0;
+        
+    } else if ((counter == 2) && ((buffer[1] & 0x01) == 0)) {
+        
+        // discard first byte and check if the second byte may start a frame
+        
+        if (descriptorCounter == 0) checkErrors++;
+        buffer[0] = buffer[1];
+        counter = validStartBits(buffer[0]) ? 1 : 0;
+        
+    } else if ((counter >= FRAME_SIZE) && (descriptorCounter >= 2)) {
+        
+        // frame is part of a response descriptor, discard it
+        
+        counter = 0;
+        
+    } else if (counter >= FRAME_SIZE) {
+        
+        // frame is complete, decode measurement, and reduce the angle of 15 bits to one revolution,
+        // because a corrupted frame may still pass the check bit
+        
+        quality[0] = (char)(buffer[0] >> 2);
+        angle[0] = (((unsigned short)buffer[1] | ((unsigned short)buffer[2] << 8)) >> 1)%FULL_ANGLE;
+        distance[0] = (unsigned short)buffer[3] | ((unsigned short)buffer[4] << 8);
+        start[0] = (buffer[0] & 0x01) > 0;
+        
+        frames++;
+        counter = 0;
+        
+        return 1;
+    }
+    
+    return 0;
+}
+
+/**
+ * Parses a byte of an express scan packet.
+ * @param value the received byte.
+ * @return the number of measurements that were completed by this byte, either 0 or 32.
+ */
+unsigned short LIDARParser::parsePacket(unsigned char value) {
+    
+    // add this byte to the packet buffer and check the sync nibbles, a discarded byte
+    // may belong to a lost packet, so the previous packet cannot be decoded anymore
+    
+    buffer[counter++] = value;
+    
+    if ((counter == 1) && ((buffer[0] >> 4) != 0xA)) {
+        
+        syncErrors++;
+        counter = 0;
+        previousValid = false;
+        
+    } else if ((counter == 2) && ((buffer[1] >> 4) != 0x5)) {
+        
+        syncErrors++;
+        buffer[0] = buffer[1];
+        counter = ((buffer[0] >> 4) == 0xA) ? 1 : 0;
+        previousValid = false;
+        
+    } else if (counter >= PACKET_SIZE) {
+        
+        // packet is complete, verify the checksum
+        
+        unsigned char checksum = 0;
+        for (unsigned short i = 2; i < PACKET_SIZE; i++) checksum ^= buffer[i];
+        
+        if (checksum != ((buffer[0] & 0x0F) | ((buffer[1] & 0x0F) << 4))) {
+            
+            // discard the packet up to the next pair of sync nibbles
+            
+            checkErrors++;
+            
+            unsigned short next = 1;
+            while ((next < PACKET_SIZE-1) && (((buffer[next] >> 4) != 0xA) || ((buffer[next+1] >> 4) != 0x5))) next++;
+            if ((next == PACKET_SIZE-1) && ((buffer[next] >> 4) != 0xA)) next = PACKET_SIZE;
+            
+            for (unsigned short i = next; i < PACKET_SIZE; i++) buffer[i-next] = buffer[i];
+            counter = PACKET_SIZE-next;
+            previousValid = false;
+            
+            return 0;
+        }
+        
+        frames++;
+        counter = 0;
+        
+        // decode the previous packet, unless this packet starts a new scan
+        
+        unsigned short measurements = 0;
+        
+        if (buffer[3] & 0x80) {
+            previousValid = false;
+        } else if (previousValid) {
+            measurements = decodePacket();
+        }
+        
+        for (unsigned short i = 0; i < PACKET_SIZE; i++) previous[i] = buffer[i];
+        previousValid = true;
+        
+        return measurements;
+    }
+    
+    return 0;
+}
+
+/**
+ * Decodes the measurements of the previous express scan packet.
+ * The angles are interpolated between the start angle of the previous packet
+ * and the start angle of the packet in the buffer.
+ * @return the number of decoded measurements.
+ */
+unsigned short LIDARParser::decodePacket() {
+    
+    int startAngle = ((int)previous[2] | ((int)previous[3] << 8)) & 0x7FFF;
+    int nextAngle = ((int)buffer[2] | ((int)buffer[3] << 8)) & 0x7FFF;
+    
+    int difference = nextAngle-startAngle;
+    if (difference < 0) difference += FULL_ANGLE;
+    
+    int increment = difference << 5;    // angle increment per measurement, given in [1/65536 deg]
+    int actualAngle = startAngle << 10; // actual angle, given in [1/65536 deg]
+    
+    unsigned short n = 0;
+    
+    for (unsigned short cabin = 0; cabin < CABINS; cabin++) {
+        
+        const unsigned char* data = &previous[4+5*cabin];
+        
+        for (unsigned short j = 0; j < 2; j++) {
+            
+            unsigned short value = (unsigned short)data[2*j] | ((unsigned short)data[2*j+1] << 8);
+            int offset = (j == 0) ? ((data[4] & 0x0F) | ((value & 0x03) << 4)) : ((data[4] >> 4) | ((value & 0x03) << 4));
+            
+            int measuredAngle = (actualAngle-(offset << 13)) >> 10;
+            while (measuredAngle < 0) measuredAngle += FULL_ANGLE;
+            while (measuredAngle >= FULL_ANGLE) measuredAngle -= FULL_ANGLE;
+            
+            distance[n] = value & 0xFFFC;
+            quality[n] = (distance[n] > 0) ? 0x2F : 0;
+            angle[n] = (unsigned short)measuredAngle;
+            start[n] = ((actualAngle+increment)%(FULL_ANGLE << 10)) < increment;
+            
+            actualAngle += increment;
+            n++;
+        }
+    }
+    
+    return n;
+}
+
+/**
+ * Checks if the start bit S and the inverted start bit !S of the first byte of a frame are valid.
+ * @param byte the first byte of a frame.
+ */
+bool LIDARParser::validStartBits(unsigned char byte) {
+    
+    return (byte & 0x01) != ((byte >> 1) & 0x01);
+}
@@ -0,0 +1,83 @@
+/*
+ * LIDARParser.h
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#ifndef LIDAR_PARSER_H_
+#define LIDAR_PARSER_H_
+
+#include <cstdlib>
+
+/**
+ * This class implements a parser for the responses of the Slamtec RP LIDAR A1.
+ * It decodes the stream of bytes that the LIDAR sends during a scan, byte by byte.
+ * The response descriptor at the beginning of a scan tells the parser if the LIDAR
+ * sends standard scan frames or express scan packets.
+ * <br/>
+ * Every measurement of a standard scan is a frame of 5 bytes. The parser checks the
+ * start bits S and !S and the check bit C of every frame. When these bits are invalid,
+ * the parser discards the first byte of the frame and tries to resynchronize on the
+ * following bytes. This allows to recover the alignment within one frame after bytes
+ * got lost or corrupted.
+ * <br/>
+ * An express scan packet of 84 bytes contains 32 measurements in 16 cabins. The angles
+ * of these measurements are interpolated between the start angle of this packet and the
+ * start angle of the next packet. Therefore the measurements of a packet are decoded
+ * when the next packet was received. The parser checks the sync nibbles and the checksum
+ * of every packet, and searches the next sync nibbles when a packet is invalid.
+ * <br/>
+ * This parser does not depend on any hardware, so it can be used with any source of bytes.
+ */
+class LIDARParser {
+    
+    public:
+        
+        static const unsigned short MAXIMUM_MEASUREMENTS = 32;  /**< Maximum number of measurements decoded from one byte. */
+        
+                        LIDARParser();
+        virtual         ~LIDARParser();
+        void            reset();
+        unsigned short  parse(char byte);
+        char            getQuality(unsigned short i);
+        unsigned short  getAngle(unsigned short i);
+        unsigned short  getDistance(unsigned short i);
+        bool            getStart(unsigned short i);
+        unsigned int    getFrames();
+        unsigned int    getSyncErrors();
+        unsigned int    getCheckErrors();
+        
+    private:
+        
+        static const unsigned short DESCRIPTOR_SIZE = 7;    // size of a response descriptor, given in [bytes]
+        static const unsigned short FRAME_SIZE = 5;         // size of a standard scan measurement frame, given in [bytes]
+        static const unsigned short PACKET_SIZE = 84;       // size of an express scan packet, given in [bytes]
+        static const unsigned short CABINS = 16;            // number of cabins in an express scan packet
+        static const unsigned char  DESCRIPTOR[];           // response descriptor of a standard scan request
+        static const unsigned char  EXPRESS_LENGTH = 0x54;  // length of an express scan packet in the response descriptor
+        static const unsigned char  EXPRESS_TYPE = 0x82;    // data type of an express scan response
+        static const int            FULL_ANGLE = 360*64;    // full revolution, given in [1/64 deg]
+        
+        bool            express;                    // flag that indicates if the LIDAR sends express scan packets
+        unsigned short  descriptorCounter;          // number of bytes that matched the response descriptor
+        unsigned char   descriptorLength;           // length of the data in the actual response descriptor
+        unsigned short  counter;                    // number of bytes in the buffer
+        unsigned char   buffer[PACKET_SIZE];        // buffer with the bytes of the actual frame or packet
+        unsigned char   previous[PACKET_SIZE];      // the previous express scan packet
+        bool            previousValid;              // flag that indicates if the previous packet can be decoded
+        char            quality[MAXIMUM_MEASUREMENTS];          // quality of the latest measurements
+        unsigned short  angle[MAXIMUM_MEASUREMENTS];            // angle of the latest measurements, given in [1/64 deg]
+        unsigned short  distance[MAXIMUM_MEASUREMENTS];         // distance of the latest measurements, given in [1/4 mm]
+        bool            start[MAXIMUM_MEASUREMENTS];            // flags that indicate if a measurement starts a new scan
+        unsigned int    frames;                     // number of valid frames or packets
+        unsigned int    syncErrors;                 // number of discarded bytes with invalid start bits or sync nibbles
+        unsigned int    checkErrors;                // number of discarded bytes with an invalid check bit or checksum
+        
+        bool            parseDescriptor(unsigned char value);
+        unsigned short  parseFrame(unsigned char value);
+        unsigned short  parsePacket(unsigned char value);
+        unsigned short  decodePacket();
+        bool            validStartBits(unsigned char byte);
+};
+
+#endif /* LIDAR_PARSER_H_ */
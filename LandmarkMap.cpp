@@ -0,0 +1,321 @@
+/*
+ * LandmarkMap.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include "LandmarkMap.h"
+
+using namespace std;
+
+const float LandmarkMap::CELL_SIZE = 0.5f;      // width of a grid cell, given in [m]
+const float LandmarkMap::GATE = 9.21f;          // threshold of the squared Mahalanobis distance, 99% quantile of chi-square with 2 degrees of freedom
+const float LandmarkMap::MAXIMUM_RANGE = 1.0f;  // maximum search range around a beacon, given in [m]
+
+/**
+ * Creates an empty LandmarkMap object.
+ */
+LandmarkMap::LandmarkMap() {
+    
+    size = 0;
+    xs = NULL;
+    ys = NULL;
+    buckets = 0;
+    starts = NULL;
+}
+
+/**
+ * Deletes this object.
+ */
+LandmarkMap::~LandmarkMap() {
+    
+    clear();
+}
+
+/**
+ * Loads the landmarks of this map from a file, for example from the SD card with
+ * the filename <code>/fs/landmarks.txt</code>. The map is only replaced, when the
+ * file could be read and contains at least one landmark.
+ * @param filename the name of the file to read.
+ * @return <code>true</code> if the map was loaded, <code>false</code> otherwise.
+ */
+bool LandmarkMap::load(const char* filename) {
+    
+    FILE* file = fopen(filename, "r");
+    if (file == NULL) return false;
+    
+    // count the landmarks of the file, and read them in a second pass
+    
+    char line[128];
+    unsigned int size = 0;
+    
+    while (fgets(line, sizeof(line), file) != NULL) {
+        float x, y;
+        if ((line[0] != '#') && (sscanf(line, "%f %f", &x, &y) == 2)) size++;
+    }
+    
+    if (size == 0) {
+        fclose(file);
+        return false;
+    }
+    
+    float* x = new float[size];
+    float* y = new float[size];
+    unsigned int n = 0;
+    
+    fseek(file, 0, SEEK_SET);
+    
+    while ((n < size) && (fgets(line, sizeof(line), file) != NULL)) {
+        if ((line[0] != '#') && (sscanf(line, "%f %f", &x[n], &y[n]) == 2)) n++;
+    }
+    
+    fclose(file);
+    
+    bool success = set(x, y, n);
+    
+    delete[] x;
+    delete[] y;
+    
+    return success;
+}
+
+/**
+ * Sets the landmarks of this map, and builds the spatial index of the landmarks.
+ * @param x an array with the x coordinates of the landmarks, given in [m].
+ * @param y an array with the y coordinates of the landmarks, given in [m].
+ * @param size the number of landmarks.
+ * @return <code>true</code> if the map was set, <code>false</code> if the map would be empty.
+ */
+bool LandmarkMap::set(const float x[], const float y[], unsigned int size) {
+    
+    if (size == 0) return false;
+    
+    clear();
+    
+    // choose a table with at least twice as many buckets as landmarks
+    
+    buckets = MINIMUM_BUCKETS;
+    while (buckets < 2*size) buckets <<= 1;
+    
+    this->size = size;
+    xs = new float[size];
+    ys = new float[size];
+    starts = new unsigned int[buckets+1];
+    
+    // sort the landmarks by their buckets with a counting sort
+    
+    unsigned int* keys = new unsigned int[size];
+    
+    for (unsigned int i = 0; i <= buckets; i++) starts[i] = 0;
+    
+    for (unsigned int i = 0; i < size; i++) {
+        keys[i] = bucket(cell(x[i]), cell(y[i]));
+        starts[keys[i]+1]++;
+    }
+    
+    for (unsigned int i = 0; i < buckets; i++) starts[i+1] += starts[i];
+    
+    unsigned int* next = new unsigned int[buckets];
+    
+    for (unsigned int i = 0; i < buckets; i++) next[i] = starts[i];
+    
+    for (unsigned int i = 0; i < size; i++) {
+        unsigned int index = next[keys[i]]++;
+        xs[index] = x[i];
+        ys[index] = y[i];
+    }
+    
+    delete[] next;
+    delete[] keys;
+    
+    return true;
+}
+
+/**
+ * Gets the number of landmarks of this map.
+ */
+unsigned int LandmarkMap::getSize() {
+    
+    return size;
+}
+
+/**
+ * Gets the x coordinate of a landmark.
+ * @param index the index of the landmark.
+ * @return the x coordinate, given in [m].
+ */
+float LandmarkMap::getX(unsigned int index) {
+    
+    return (index < size) ? xs[index] : 0.0f;
+}
+
+/**
+ * Gets the y coordinate of a landmark.
+ * @param index the index of the landmark.
+ * @return the y coordinate, given in [m].
+ */
+float LandmarkMap::getY(unsigned int index) {
+    
+    return (index < size) ? ys[index] : 0.0f;
+}
+
+/**
+ * Finds the landmark that is nearest to a given position, within a given radius.
+ * @param x the x coordinate of the position, given in [m].
+ * @param y the y coordinate of the position, given in [m].
+ * @param radius the maximum distance of the landmark, given in [m]. Larger values are limited
+ * to the search range of the map of 1 m, which bounds the number of cells that are searched.
+ * @return the index of the nearest landmark, or -1 if there is no landmark within the radius.
+ */
+int LandmarkMap::nearest(float x, float y, float radius) {
+    
+    if (size == 0) return -1;
+    if (radius > MAXIMUM_RANGE) radius = MAXIMUM_RANGE;
+    
+    int nearest = -1;
+    float minimum = radius*radius;
+    
+    for (int row = cell(y-radius); row <= cell(y+radius); row++) {
+        for (int column = cell(x-radius); column <= cell(x+radius); column++) {
+            
+            unsigned int key = bucket(column, row);
+            
+            for (unsigned int i = starts[key]; i < starts[key+1]; i++) {
+                float dx = xs[i]-x;
+                float dy = ys[i]-y;
+                float distance = dx*dx+dy*dy;
+                if (distance <= minimum) {
+                    minimum = distance;
+                    nearest = i;
+                }
+            }
+        }
+    }
+    
+    return nearest;
+}
+
+/**
+ * Associates a measured beacon with the landmark of this map that has the
+ * smallest Mahalanobis distance to the beacon. Only landmarks within the gate,
+ * i.e. with a squared Mahalanobis distance below the 99% quantile, are considered.
+ * @param x the x coordinate of the measured beacon, given in [m].
+ * @param y the y coordinate of the measured beacon, given in [m].
+ * @param covariance the covariance matrix of the measured beacon in map coordinates,
+ * including the uncertainty of the pose of the robot, given in [m2].
+ * @param distance a reference to a variable that is set to the squared Mahalanobis distance.
+ * @return the index of the associated landmark, or -1 if no landmark is within the gate.
+ */
+int LandmarkMap::associate(float x, float y, const Matrix<2, 2>& covariance, float& distance) {
+    
+    int landmark = -1;
+    distance = GATE;
+    
+    candidates(x, y, covariance, &landmark, &distance, 1);
+    
+    return landmark;
+}
+
+/**
+ * Gets all landmarks of this map that are individually compatible with a measured
+ * beacon, i.e. that have a squared Mahalanobis distance to the beacon below the gate.
+ * The landmarks are sorted by their distance. If there are more compatible landmarks
+ * than the given capacity, only the nearest landmarks are returned.
+ * @param x the x coordinate of the measured beacon, given in [m].
+ * @param y the y coordinate of the measured beacon, given in [m].
+ * @param covariance the covariance matrix of the measured beacon in map coordinates,
+ * including the uncertainty of the pose of the robot, given in [m2].
+ * @param landmarks an array that is filled with the indices of the compatible landmarks.
+ * @param distances an array that is filled with the squared Mahalanobis distances.
+ * @param capacity the size of the arrays of landmarks and distances.
+ * @return the number of compatible landmarks.
+ */
+unsigned short LandmarkMap::candidates(float x, float y, const Matrix<2, 2>& covariance, int landmarks[], float distances[], unsigned short capacity) {
+    
+    Matrix<2, 2> inverse;
+    if ((size == 0) || (capacity == 0) || !covariance.inverse(inverse)) return 0;
+    
+    // the gate is an ellipse, search the cells of its bounding box
+    
+    float rangeX = sqrt(fabs(GATE*covariance(0, 0)));
+    float rangeY = sqrt(fabs(GATE*covariance(1, 1)));
+    
+    if (rangeX > MAXIMUM_RANGE) rangeX = MAXIMUM_RANGE;
+    if (rangeY > MAXIMUM_RANGE) rangeY = MAXIMUM_RANGE;
+    
+    unsigned short count = 0;
+    
+    for (int row = cell(y-rangeY); row <= cell(y+rangeY); row++) {
+        for (int column = cell(x-rangeX); column <= cell(x+rangeX); column++) {
+            
+            unsigned int key = bucket(column, row);
+            
+            for (unsigned int i = starts[key]; i < starts[key+1]; i++) {
+                
+                float dx = xs[i]-x;
+                float dy = ys[i]-y;
+                float mahalanobis = dx*(inverse(0, 0)*dx+inverse(0, 1)*dy)+dy*(inverse(1, 0)*dx+inverse(1, 1)*dy);
+                
+                if (mahalanobis >= GATE) continue;
+                if ((count == capacity) && (mahalanobis >= distances[count-1])) continue;
+                
+                // different cells may share a bucket, skip landmarks that were already found
+                
+                bool found = false;
+                for (unsigned short k = 0; k < count; k++) found |= (landmarks[k] == static_cast<int>(i));
+                if (found) continue;
+                
+                // insert the landmark into the sorted list
+                
+                unsigned short k = (count < capacity) ? count++ : count-1;
+                
+                while ((k > 0) && (distances[k-1] > mahalanobis)) {
+                    landmarks[k] = landmarks[k-1];
+                    distances[k] = distances[k-1];
+                    k--;
+                }
+                
+                landmarks[k] = i;
+                distances[k] = mahalanobis;
+            }
+        }
+    }
+    
+    return count;
+}
+
+/**
+ * Gets the grid cell of a coordinate.
+ */
+int LandmarkMap::cell(float coordinate) {
+    
+    return static_cast<int>(floor(coordinate/CELL_SIZE));
+}
+
+/**
+ * Gets the bucket of the hash table for a grid cell.
+ */
+unsigned int LandmarkMap::bucket(int column, int row) {
+    
+    uint32_t hash = static_cast<uint32_t>(column)*73856093u^static_cast<uint32_t>(row)*19349663u;
+    
+    return hash & (buckets-1);
+}
+
+/**
+ * Removes all landmarks and the spatial index of this map.
+ */
+void LandmarkMap::clear() {
+    
+    delete[] xs;
+    delete[] ys;
+    delete[] starts;
+    
+    size = 0;
+    xs = NULL;
+    ys = NULL;
+    buckets = 0;
+    starts = NULL;
+}
@@ -0,0 +1,60 @@
+/*
+ * LandmarkMap.h
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#ifndef LANDMARK_MAP_H_
+#define LANDMARK_MAP_H_
+
+#include <cstdlib>
+#include <stdint.h>
+#include "Matrix.h"
+
+/**
+ * This class stores a map with the positions of landmarks, like the pipes of an arena,
+ * and associates measured beacons with these landmarks.
+ * <br/>
+ * The landmarks are indexed with a spatial hash of a uniform grid: every landmark
+ * is assigned to a square grid cell, and the cells are hashed into a table of buckets.
+ * The landmarks are sorted by their buckets, so that the landmarks of a cell are
+ * found with a single table lookup. The cost of an association therefore only depends
+ * on the density of the landmarks, and not on the total number of landmarks of the map.
+ * <br/>
+ * A map file contains one landmark per line, given as x and y coordinates in [m],
+ * separated by white space. Empty lines and lines starting with '#' are ignored.
+ */
+class LandmarkMap {
+    
+    public:
+        
+                        LandmarkMap();
+        virtual         ~LandmarkMap();
+        bool            load(const char* filename);
+        bool            set(const float x[], const float y[], unsigned int size);
+        unsigned int    getSize();
+        float           getX(unsigned int index);
+        float           getY(unsigned int index);
+        int             nearest(float x, float y, float radius);
+        int             associate(float x, float y, const Matrix<2, 2>& covariance, float& distance);
+        unsigned short  candidates(float x, float y, const Matrix<2, 2>& covariance, int landmarks[], float distances[], unsigned short capacity);
+        
+    private:
+        
+        static const unsigned int   MINIMUM_BUCKETS = 16;   // minimum number of buckets of the hash table
+        static const float          CELL_SIZE;              // width of a grid cell, given in [m]
+        static const float          GATE;                   // threshold of the squared Mahalanobis distance
+        static const float          MAXIMUM_RANGE;          // maximum search range around a beacon, given in [m]
+        
+        unsigned int    size;       // number of landmarks
+        float*          xs;         // x coordinates of the landmarks, sorted by bucket, given in [m]
+        float*          ys;         // y coordinates of the landmarks, sorted by bucket, given in [m]
+        unsigned int    buckets;    // number of buckets of the hash table, a power of 2
+        unsigned int*   starts;     // index of the first landmark of every bucket, and the size of the map
+        
+        int             cell(float coordinate);
+        unsigned int    bucket(int column, int row);
+        void            clear();
+};
+
+#endif /* LANDMARK_MAP_H_ */
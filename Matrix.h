@@ -0,0 +1,351 @@
+/*
+ * Matrix.h
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#ifndef MATRIX_H_
+#define MATRIX_H_
+
+#include <cstdlib>
+#include <cmath>
+
+template <unsigned int N> class MatrixInverse;
+
+/**
+ * This class template implements a matrix of floats with a fixed size of R rows and C columns.
+ * The size is known at compile time, so all loops have constant bounds and can be unrolled
+ * by the compiler, and a matrix never allocates memory on the heap. This is intended
+ * for the small matrices of Kalman filters.
+ */
+template <unsigned int R, unsigned int C>
+class Matrix {
+    
+    public:
+        
+        float   m[R][C];    /**< The elements of this matrix, given as m[row][column]. */
+        
+        /**
+         * Creates a matrix with all elements set to zero.
+         */
+        Matrix() {
+            
+            for (unsigned int i = 0; i < R; i++) {
+                for (unsigned int j = 0; j < C; j++) {
+                    m[i][j] = 0.0f;
+                }
+            }
+        }
+        
+        /**
+         * Creates a matrix from a two dimensional array.
+         * @param values the elements of this matrix, given as values[row][column].
+         */
+        Matrix(const float values[R][C]) {
+            
+            for (unsigned int i = 0; i < R; i++) {
+                for (unsigned int j = 0; j < C; j++) {
+                    m[i][j] = values[i][j];
+                }
+            }
+        }
+        
+        /**
+         * Creates an identity matrix.
+         */
+        static Matrix identity() {
+            
+            Matrix result;
+            for (unsigned int i = 0; (i < R) && (i < C); i++) result.m[i][i] = 1.0f;
+            
+            return result;
+        }
+        
+        /**
+         * Gets a reference to an element of this matrix.
+         */
+        float& operator()(unsigned int i, unsigned int j) {
+            
+            return m[i][j];
+        }
+        
+        /**
+         * Gets an element of this matrix.
+         */
+        float operator()(unsigned int i, unsigned int j) const {
+            
+            return m[i][j];
+        }
+        
+        /**
+         * Adds a matrix to this matrix.
+         */
+        Matrix operator+(const Matrix& matrix) const {
+            
+            Matrix result;
+            for (unsigned int i = 0; i < R; i++) {
+                for (unsigned int j = 0; j < C; j++) {
+                    result.m[i][j] = m[i][j]+matrix.m[i][j];
+                }
+            }
+            
+            return result;
+        }
+        
+        /**
+         * Subtracts a matrix from this matrix.
+         */
+        Matrix operator-(const Matrix& matrix) const {
+            
+            Matrix result;
+            for (unsigned int i = 0; i < R; i++) {
+                for (unsigned int j = 0; j < C; j++) {
+                    result.m[i][j] = m[i][j]-matrix.m[i][j];
+                }
+            }
+            
+            return result;
+        }
+        
+        /**
+         * Multiplies this matrix with a scalar value.
+         */
+        Matrix operator*(float value) const {
+            
+            Matrix result;
+            for (unsigned int i = 0; i < R; i++) {
+                for (unsigned int j = 0; j < C; j++) {
+                    result.m[i][j] = m[i][j]*value;
+                }
+            }
+            
+            return result;
+        }
+        
+        /**
+         * Multiplies this matrix with another matrix.
+         */
+        template <unsigned int K>
+        Matrix<R, K> operator*(const Matrix<C, K>& matrix) const {
+            
+            Matrix<R, K> result;
+            for (unsigned int i = 0; i < R; i++) {
+                for (unsigned int j = 0; j < K; j++) {
+                    float sum = 0.0f;
+                    for (unsigned int k = 0; k < C; k++) sum += m[i][k]*matrix.m[k][j];
+                    result.m[i][j] = sum;
+                }
+            }
+            
+            return result;
+        }
+        
+        /**
+         * Adds a matrix to this matrix in place.
+         */
+        Matrix& operator+=(const Matrix& matrix) {
+            
+            for (unsigned int i = 0; i < R; i++) {
+                for (unsigned int j = 0; j < C; j++) {
+                    m[i][j] += matrix.m[i][j];
+                }
+            }
+            
+            return *this;
+        }
+        
+        /**
+         * Subtracts a matrix from this matrix in place.
+         */
+        Matrix& operator-=(const Matrix& matrix) {
+            
+            for (unsigned int i = 0; i < R; i++) {
+                for (unsigned int j = 0; j < C; j++) {
+                    m[i][j] -= matrix.m[i][j];
+                }
+            }
+            
+            return *this;
+        }
+        
+        /**
+         * Gets the transpose of this matrix.
+         */
+        Matrix<C, R> transpose() const {
+            
+            Matrix<C, R> result;
+            for (unsigned int i = 0; i < R; i++) {
+                for (unsigned int j = 0; j < C; j++) {
+                    result.m[j][i] = m[i][j];
+                }
+            }
+            
+            return result;
+        }
+        
+        /**
+         * Makes this square matrix exactly symmetric, by averaging it with its transpose.
+         */
+        void symmetrize() {
+            
+            for (unsigned int i = 0; i < R; i++) {
+                for (unsigned int j = i+1; j < C; j++) {
+                    float value = 0.5f*(m[i][j]+m[j][i]);
+                    m[i][j] = value;
+                    m[j][i] = value;
+                }
+            }
+        }
+        
+        /**
+         * Calculates the Cholesky decomposition L*L' of this symmetric, positive definite matrix.
+         * @param l a reference to a matrix that is set to the lower triangular matrix L.
+         * @return <code>true</code> if the decomposition succeeded, <code>false</code> if this matrix is not positive definite.
+         */
+        bool cholesky(Matrix& l) const {
+            
+            l = Matrix();
+            
+            for (unsigned int j = 0; j < C; j++) {
+                
+                float sum = m[j][j];
+                for (unsigned int k = 0; k < j; k++) sum -= l.m[j][k]*l.m[j][k];
+                if (sum <= 0.0f) return false;
+                
+                l.m[j][j] = sqrt(sum);
+                
+                for (unsigned int i = j+1; i < R; i++) {
+                    float value = m[i][j];
+                    for (unsigned int k = 0; k < j; k++) value -= l.m[i][k]*l.m[j][k];
+                    l.m[i][j] = value/l.m[j][j];
+                }
+            }
+            
+            return true;
+        }
+        
+        /**
+         * Calculates the inverse of this square matrix. Matrices with up to 3 rows are
+         * inverted with their adjugate, larger matrices must be symmetric and positive
+         * definite, and are inverted with a Cholesky decomposition.
+         * @param inverse a reference to a matrix that is set to the inverse.
+         * @return <code>true</code> if the inverse exists, <code>false</code> otherwise.
+         */
+        bool inverse(Matrix& inverse) const {
+            
+            return MatrixInverse<R>::invert(*this, inverse);
+        }
+};
+
+/**
+ * This class template inverts symmetric, positive definite matrices of any size
+ * with a Cholesky decomposition. It is specialized for small matrices below.
+ */
+template <unsigned int N>
+class MatrixInverse {
+    
+    public:
+        
+        static bool invert(const Matrix<N, N>& a, Matrix<N, N>& inverse) {
+            
+            // invert L*L' column by column, with forward and backward substitution
+            
+            Matrix<N, N> l;
+            if (!a.cholesky(l)) return false;
+            
+            for (unsigned int c = 0; c < N; c++) {
+                
+                float y[N];
+                for (unsigned int i = 0; i < N; i++) {
+                    float value = (i == c) ? 1.0f : 0.0f;
+                    for (unsigned int k = 0; k < i; k++) value -= l.m[i][k]*y[k];
+                    y[i] = value/l.m[i][i];
+                }
+                
+                for (unsigned int i = N; i-- > 0;) {
+                    float value = y[i];
+                    for (unsigned int k = i+1; k < N; k++) value -= l.m[k][i]*inverse.m[k][c];
+                    inverse.m[i][c] = value/l.m[i][i];
+                }
+            }
+            
+            return true;
+        }
+};
+
+/**
+ * Inverts a 1x1 matrix.
+ */
+template <>
+class MatrixInverse<1> {
+    
+    public:
+        
+        static bool invert(const Matrix<1, 1>& a, Matrix<1, 1>& inverse) {
+            
+            if (a.m[0][0] == 0.0f) return false;
+            
+            inverse.m[0][0] = 1.0f/a.m[0][0];
+            
+            return true;
+        }
+};
+
+/**
+ * Inverts a 2x2 matrix with its adjugate.
+ */
+template <>
+class MatrixInverse<2> {
+    
+    public:
+        
+        static bool invert(const Matrix<2, 2>& a, Matrix<2, 2>& inverse) {
+            
+            float determinant = a.m[0][0]*a.m[1][1]-a.m[0][1]*a.m[1][0];
+            if (determinant == 0.0f) return false;
+            
+            float reciprocal = 1.0f/determinant;
+            
+            inverse.m[0][0] = a.m[1][1]*reciprocal;
+            inverse.m[0][1] = -a.m[0][1]*reciprocal;
+            inverse.m[1][0] = -a.m[1][0]*reciprocal;
+            inverse.m[1][1] = a.m[0][0]*reciprocal;
+            
+            return true;
+        }
+};
+
+/**
+ * Inverts a 3x3 matrix with its adjugate.
+ */
+template <>
+class MatrixInverse<3> {
+    
+    public:
+        
+        static bool invert(const Matrix<3, 3>& a, Matrix<3, 3>& inverse) {
+            
+            float c00 = a.m[1][1]*a.m[2][2]-a.m[1][2]*a.m[2][1];
+            float c01 = a.m[1][2]*a.m[2][0]-a.m[1][0]*a.m[2][2];
+            float c02 = a.m[1][0]*a.m[2][1]-a.m[1][1]*a.m[2][0];
+            
+            float determinant = a.m[0][0]*c00+a.m[0][1]*c01+a.m[0][2]*c02;
+            if (determinant == 0.0f) return false;
+            
+            float reciprocal = 1.0f/determinant;
+            
+            inverse.m[0][0] = c00*reciprocal;
+            inverse.m[1][0] = c01*reciprocal;
+            inverse.m[2][0] = c02*reciprocal;
+            inverse.m[0][1] = (a.m[0][2]*a.m[2][1]-a.m[0][1]*a.m[2][2])*reciprocal;
+            inverse.m[1][1] = (a.m[0][0]*a.m[2][2]-a.m[0][2]*a.m[2][0])*reciprocal;
+            inverse.m[2][1] = (a.m[0][1]*a.m[2][0]-a.m[0][0]*a.m[2][1])*reciprocal;
+            inverse.m[0][2] = (a.m[0][1]*a.m[1][2]-a.m[0][2]*a.m[1][1])*reciprocal;
+            inverse.m[1][2] = (a.m[0][2]*a.m[1][0]-a.m[0][0]*a.m[1][2])*reciprocal;
+            inverse.m[2][2] = (a.m[0][0]*a.m[1][1]-a.m[0][1]*a.m[1][0])*reciprocal;
+            
+            return true;
+        }
+};
+
+#endif /* MATRIX_H_ */
@@ -12,6 +12,7 @@ using namespace std;
 
 const float Motion::DEFAULT_LIMIT = 1.0f;       // default value for limits
 const float Motion::MINIMUM_LIMIT = 1.0e-9f;    // smallest value allowed for limits
+const float Motion::STOP_TIME = 1.0e9f;         // time period to increment a motion until it stops, given in [s]
 
 /**
  * Creates a <code>Motion</code> object.
@@ -21,10 +22,12 @@ Motion::Motion() {
     
     position = 0.0;
     velocity = 0.0f;
+    acceleration = 0.0f;
     
     profileVelocity = DEFAULT_LIMIT;
     profileAcceleration = DEFAULT_LIMIT;
     profileDeceleration = DEFAULT_LIMIT;
+    profileJerk = 0.0f;
 }
 
 /**
@@ -36,10 +39,12 @@ Motion::Motion(double position, float velocity) {
     
     this->position = position;
     this->velocity = velocity;
+    acceleration = 0.0f;
     
     profileVelocity = DEFAULT_LIMIT;
     profileAcceleration = DEFAULT_LIMIT;
     profileDeceleration = DEFAULT_LIMIT;
+    profileJerk = 0.0f;
 }
 
 /**
@@ -50,10 +55,12 @@ Motion::Motion(const Motion& motion) {
     
     position = motion.position;
     velocity = motion.velocity;
+    acceleration = motion.acceleration;
     
     profileVelocity = motion.profileVelocity;
     profileAcceleration = motion.profileAcceleration;
     profileDeceleration = motion.profileDeceleration;
+    profileJerk = motion.profileJerk;
 }
 
 /**
@@ -62,7 +69,7 @@ Motion::Motion(const Motion& motion) {
 Motion::~Motion() {}
 
 /**
- * Sets the values for position and velocity.
+ * Sets the values for position and velocity. The acceleration is set to 0.
  * @param position the desired position value of this motion, given in [m] or [rad].
  * @param velocity the desired velocity value of this motion, given in [m/s] or [rad/s].
  */
@@ -70,6 +77,7 @@ void Motion::set(double position, float velocity) {
     
     this->position = position;
     this->velocity = velocity;
+    this->acceleration = 0.0f;
 }
 
 /**
@@ -80,6 +88,7 @@ void Motion::set(const Motion& motion) {
     
     position = motion.position;
     velocity = motion.velocity;
+    acceleration = motion.acceleration;
 }
 
 /**
@@ -118,6 +127,16 @@ float Motion::getVelocity() {
     return velocity;
 }
 
+/**
+ * Gets the acceleration value. With the 2nd order motion planner, this is the mean
+ * acceleration of the last increment.
+ * @return the acceleration value of this motion, given in [m/s2] or [rad/s2].
+ */
+float Motion::getAcceleration() {
+    
+    return acceleration;
+}
+
 /**
  * Sets the limit for the velocity value.
  * @param profileVelocity the limit of the velocity.
@@ -145,6 +164,15 @@ void Motion::setProfileDeceleration(float profileDeceleration) {
     if (profileDeceleration > MINIMUM_LIMIT) this->profileDeceleration = profileDeceleration; else this->profileDeceleration = MINIMUM_LIMIT;
 }
 
+/**
+ * Sets the limit for the jerk value. With a jerk limit, the 3rd order motion planner is used.
+ * @param profileJerk the limit of the jerk, or 0 to use the 2nd order motion planner.
+ */
+void Motion::setProfileJerk(float profileJerk) {
+    
+    if (profileJerk > MINIMUM_LIMIT) this->profileJerk = profileJerk; else this->profileJerk = 0.0f;
+}
+
 /**
  * Sets the limits for velocity, acceleration and deceleration values.
  * @param profileVelocity the limit of the velocity.
@@ -165,6 +193,8 @@ void Motion::setLimits(float profileVelocity, float profileAcceleration, float p
  */
 float Motion::getTimeToPosition(double targetPosition) {
     
+    if (profileJerk > 0.0f) return getTimeToPositionWithJerk(targetPosition);
+    
     // calculate position, when velocity is reduced to zero
     
     double stopPosition = (velocity > 0.0f) ? position+(double)(velocity*velocity/profileDeceleration*0.5f) : position-(double)(velocity*velocity/profileDeceleration*0.5f);
@@ -262,6 +292,13 @@ float Motion::getTimeToPosition(double targetPosition) {
  */
 void Motion::incrementToVelocity(float targetVelocity, float period) {
     
+    if (profileJerk > 0.0f) {
+        incrementToVelocityWithJerk(targetVelocity, period);
+        return;
+    }
+    
+    float previousVelocity = velocity;
+    
     if (targetVelocity < -profileVelocity) targetVelocity = -profileVelocity;
     else if (targetVelocity > profileVelocity) targetVelocity = profileVelocity;
     
@@ -365,6 +402,8 @@ void Motion::incrementToVelocity(float targetVelocity, float period) {
             }
         }
     }
+    
+    acceleration = (velocity-previousVelocity)/period;
 }
 
 /**
@@ -374,6 +413,13 @@ void Motion::incrementToVelocity(float targetVelocity, float period) {
  */
 void Motion::incrementToPosition(double targetPosition, float period) {
     
+    if (profileJerk > 0.0f) {
+        incrementToPositionWithJerk(targetPosition, period);
+        return;
+    }
+    
+    float previousVelocity = velocity;
+    
     // calculate position, when velocity is reduced to zero
     
     double stopPosition = (velocity > 0.0f) ? position+(double)(velocity*velocity/profileDeceleration*0.5f) : position-(double)(velocity*velocity/profileDeceleration*0.5f);
@@ -598,4 +644,202 @@ void Motion::incrementToPosition(double targetPosition, float period) {
             }
         }
     }
+    
+    acceleration = (velocity-previousVelocity)/period;
+}
+
+/**
+ * Gets the duration of a jerk limited change of the velocity, that starts and ends with zero acceleration.
+ * @param deltaVelocity the absolute change of the velocity.
+ * @param peakAcceleration the limit of the acceleration during the change.
+ * @return the duration of the change, given in [s].
+ */
+float Motion::getRampTime(float deltaVelocity, float peakAcceleration) {
+    
+    if (deltaVelocity*profileJerk > peakAcceleration*peakAcceleration) {
+        return deltaVelocity/peakAcceleration+peakAcceleration/profileJerk;
+    } else {
+        return 2.0f*sqrt(deltaVelocity/profileJerk);
+    }
+}
+
+/**
+ * Gets the distance of a jerk limited change of the velocity, that starts and ends with zero acceleration.
+ * The velocity of such a change is point symmetric, so the distance is the mean velocity times the duration.
+ * @param velocity1 the velocity at the start of the change.
+ * @param velocity2 the velocity at the end of the change.
+ * @param peakAcceleration the limit of the acceleration during the change.
+ * @return the signed distance of the change, given in [m] or [rad].
+ */
+float Motion::getRampDistance(float velocity1, float velocity2, float peakAcceleration) {
+    
+    return (velocity1+velocity2)*0.5f*getRampTime(fabs(velocity2-velocity1), peakAcceleration);
+}
+
+/**
+ * Gets the time needed to move to a given target position with the 3rd order motion planner.
+ * The acceleration is first ramped to zero. Then the motion speeds up to the profile velocity
+ * or a lower peak velocity, which is found by bisection, and slows down to the target position.
+ * This time is exact for a motion that starts with zero acceleration in the direction of the
+ * target position, otherwise it is an upper bound, because the ramps are not merged.
+ * @param targetPosition the desired target position given in [m] or [rad].
+ * @return the time to move to the target position, given in [s].
+ */
+float Motion::getTimeToPositionWithJerk(double targetPosition) {
+    
+    // ramp the acceleration to zero
+    
+    float time = fabs(acceleration)/profileJerk;
+    float jerk = (acceleration > 0.0f) ? -profileJerk : profileJerk;
+    float velocity = this->velocity+acceleration*0.5f*time;
+    double position = this->position+(double)((this->velocity+(acceleration*0.5f+jerk*time/6.0f)*time)*time);
+    
+    // calculate position, when velocity is reduced to zero, and mirror the motion to a positive direction
+    
+    double stopPosition = position+(double)getRampDistance(velocity, 0.0f, profileDeceleration);
+    float direction = (targetPosition > stopPosition) ? 1.0f : -1.0f;
+    float distance = direction*(float)(targetPosition-position);
+    velocity *= direction;
+    
+    if (velocity < 0.0f) { // slow down to zero first
+        
+        time += getRampTime(-velocity, profileDeceleration);
+        distance -= getRampDistance(velocity, 0.0f, profileDeceleration);
+        velocity = 0.0f;
+    }
+    
+    if (velocity > profileVelocity) { // slow down to profile velocity first
+        
+        float t1 = getRampTime(velocity-profileVelocity, profileDeceleration);
+        float t3 = getRampTime(profileVelocity, profileDeceleration);
+        float t2 = (distance-getRampDistance(velocity, profileVelocity, profileDeceleration)-getRampDistance(profileVelocity, 0.0f, profileDeceleration))/profileVelocity;
+        
+        return time+t1+max(t2, 0.0f)+t3;
+    }
+    
+    // speed up to profile velocity, or to the highest velocity that allows to stop at the target position
+    
+    float peakVelocity = profileVelocity;
+    float rampDistance = getRampDistance(velocity, profileVelocity, profileAcceleration)+getRampDistance(profileVelocity, 0.0f, profileDeceleration);
+    
+    if (rampDistance > distance) {
+        
+        float minVelocity = velocity;
+        float maxVelocity = profileVelocity;
+        
+        for (unsigned short i = 0; i < ITERATIONS; i++) {
+            
+            peakVelocity = 0.5f*(minVelocity+maxVelocity);
+            
+            if (getRampDistance(velocity, peakVelocity, profileAcceleration)+getRampDistance(peakVelocity, 0.0f, profileDeceleration) > distance) maxVelocity = peakVelocity; else minVelocity = peakVelocity;
+        }
+        
+        peakVelocity = minVelocity;
+        rampDistance = getRampDistance(velocity, peakVelocity, profileAcceleration)+getRampDistance(peakVelocity, 0.0f, profileDeceleration);
+    }
+    
+    float t1 = getRampTime(peakVelocity-velocity, profileAcceleration);
+    float t2 = (peakVelocity > MINIMUM_LIMIT) ? max(distance-rampDistance, 0.0f)/peakVelocity : 0.0f;
+    float t3 = getRampTime(peakVelocity, profileDeceleration);
+    
+    return time+t1+t2+t3;
+}
+
+/**
+ * Integrates the motion values with a constant jerk over a phase of the motion.
+ * @param jerk the jerk during the phase.
+ * @param duration the duration of the phase, given in [s].
+ * @param time the time left in the period, which is reduced by the integrated time, given in [s].
+ */
+void Motion::integrate(float jerk, float duration, float& time) {
+    
+    float t = (duration < time) ? duration : time;
+    
+    if (t > 0.0f) {
+        
+        position += (double)((velocity+(acceleration*0.5f+jerk*t/6.0f)*t)*t);
+        velocity += (acceleration+jerk*0.5f*t)*t;
+        acceleration += jerk*t;
+        time -= t;
+    }
+}
+
+/**
+ * Increments the current motion towards a given target velocity with the 3rd order motion planner.
+ * The acceleration is ramped to a peak acceleration, held, and ramped back to zero, such that the
+ * target velocity is reached with zero acceleration. The profile acceleration is used to speed up,
+ * and the profile deceleration to slow down, or to change the direction.
+ * @param targetVelocity the desired target velocity given in [m/s] or [rad/s].
+ * @param period the time period to increment the motion values for, given in [s].
+ */
+void Motion::incrementToVelocityWithJerk(float targetVelocity, float period) {
+    
+    if (targetVelocity < -profileVelocity) targetVelocity = -profileVelocity;
+    else if (targetVelocity > profileVelocity) targetVelocity = profileVelocity;
+    
+    // calculate velocity, when acceleration is ramped to zero, and mirror the motion to a positive change of the velocity
+    
+    float zeroVelocity = velocity+acceleration*fabs(acceleration)*0.5f/profileJerk;
+    float direction = (targetVelocity >= zeroVelocity) ? 1.0f : -1.0f;
+    float peakAcceleration = (velocity*direction >= 0.0f) ? profileAcceleration : profileDeceleration;
+    float acceleration = direction*this->acceleration;
+    float deltaVelocity = direction*(targetVelocity-velocity);
+    
+    // calculate the durations of the phases with increasing, constant and decreasing acceleration
+    
+    float t1 = fabs(peakAcceleration-acceleration)/profileJerk;
+    float t3 = peakAcceleration/profileJerk;
+    float t2 = (deltaVelocity-(acceleration+peakAcceleration)*0.5f*t1-peakAcceleration*0.5f*t3)/peakAcceleration;
+    
+    if (t2 < 0.0f) { // the peak acceleration is not reached
+        peakAcceleration = sqrt(max(profileJerk*deltaVelocity+acceleration*acceleration*0.5f, 0.0f));
+        t1 = fabs(peakAcceleration-acceleration)/profileJerk;
+        t2 = 0.0f;
+        t3 = peakAcceleration/profileJerk;
+    }
+    
+    // increment the motion values through the phases
+    
+    float time = period;
+    
+    integrate((peakAcceleration > acceleration) ? direction*profileJerk : -direction*profileJerk, t1, time);
+    integrate(0.0f, t2, time);
+    integrate(-direction*profileJerk, t3, time);
+    
+    if (time > 0.0f) {
+        this->acceleration = 0.0f;
+        velocity = targetVelocity;
+        position += (double)(velocity*time);
+    }
+}
+
+/**
+ * Increments the current motion towards a given target position with the 3rd order motion planner.
+ * The motion speeds up towards the profile velocity, as long as it can still stop at the target
+ * position after this increment with a jerk limited deceleration, and slows down otherwise.
+ * @param targetPosition the desired target position given in [m] or [rad].
+ * @param period the time period to increment the motion values for, given in [s].
+ */
+void Motion::incrementToPositionWithJerk(double targetPosition, float period) {
+    
+    // calculate position, when velocity is reduced to zero
+    
+    Motion stop(*this);
+    stop.incrementToVelocityWithJerk(0.0f, STOP_TIME);
+    
+    float direction = (targetPosition > stop.position) ? 1.0f : -1.0f;
+    
+    // speed up, if the motion can still stop at the target position after this increment
+    
+    Motion motion(*this);
+    motion.incrementToVelocityWithJerk(direction*profileVelocity, period);
+    
+    stop.set(motion);
+    stop.incrementToVelocityWithJerk(0.0f, STOP_TIME);
+    
+    if (direction*(targetPosition-stop.position) >= 0.0) {
+        set(motion);
+    } else {
+        incrementToVelocityWithJerk(0.0f, period);
+    }
 }
@@ -10,13 +10,20 @@
 #include <cstdlib>
 
 /**
- * This class keeps the motion values <code>position</code> and <code>velocity</code>, and
- * offers methods to increment these values towards a desired target position or velocity.
+ * This class keeps the motion values <code>position</code>, <code>velocity</code> and <code>acceleration</code>,
+ * and offers methods to increment these values towards a desired target position or velocity.
  * <br/>
  * To increment the current motion values, this class uses a simple 2nd order motion planner.
  * This planner calculates the motion to the target position or velocity with the various motion
  * phases, based on given limits for the profile velocity, acceleration and deceleration.
  * <br/>
+ * When a limit for the profile jerk is set, this class uses a 3rd order motion planner instead,
+ * which ramps the acceleration with the profile jerk, so that the velocity follows an S-curve.
+ * The phases of the velocity change are calculated in closed form: the acceleration is ramped
+ * to a peak value, held, and ramped back to zero when the target velocity is reached. To move
+ * to a target position, the target velocity is the highest velocity from which the motion can
+ * still stop at the target position with a jerk limited deceleration.
+ * <br/>
  * Note that the trajectory is calculated every time the motion state is incremented.
  * This allows to change the target position or velocity, as well as the limits for profile
  * velocity, acceleration and deceleration at any time.
@@ -27,6 +34,7 @@ class Motion {
         
         double      position;       /**< The position value of this motion, given in [m] or [rad]. */
         float       velocity;       /**< The velocity value of this motion, given in [m/s] or [rad/s]. */
+        float       acceleration;   /**< The acceleration value of this motion, given in [m/s2] or [rad/s2]. */
         
                     Motion();
                     Motion(double position, float velocity);
@@ -38,9 +46,11 @@ class Motion {
         double      getPosition();
         void        setVelocity(float velocity);
         float       getVelocity();
+        float       getAcceleration();
         void        setProfileVelocity(float profileVelocity);
         void        setProfileAcceleration(float profileAcceleration);
         void        setProfileDeceleration(float profileDeceleration);
+        void        setProfileJerk(float profileJerk);
         void        setLimits(float profileVelocity, float profileAcceleration, float profileDeceleration);
         float       getTimeToPosition(double targetPosition);
         void        incrementToVelocity(float targetVelocity, float period);
@@ -50,10 +60,20 @@ class Motion {
         
         static const float  DEFAULT_LIMIT;  // default value for limits
         static const float  MINIMUM_LIMIT;  // smallest value allowed for limits
+        static const float  STOP_TIME;      // time period to increment a motion until it stops, given in [s]
+        static const unsigned short ITERATIONS = 16;    // number of bisections to find the peak velocity of a jerk limited motion
         
         float       profileVelocity;
         float       profileAcceleration;
         float       profileDeceleration;
+        float       profileJerk;    // limit of the jerk, or zero for the 2nd order motion planner
+        
+        float       getRampTime(float deltaVelocity, float peakAcceleration);
+        float       getRampDistance(float velocity1, float velocity2, float peakAcceleration);
+        float       getTimeToPositionWithJerk(double targetPosition);
+        void        integrate(float jerk, float duration, float& time);
+        void        incrementToVelocityWithJerk(float targetVelocity, float period);
+        void        incrementToPositionWithJerk(double targetPosition, float period);
 };
 
 #endif /* MOTION_H_ */
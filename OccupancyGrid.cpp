@@ -0,0 +1,275 @@
+/*
+ * OccupancyGrid.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include <cmath>
+#include <cstring>
+#include "OccupancyGrid.h"
+#include "LIDAR.h"
+
+using namespace std;
+
+const float OccupancyGrid::RESOLUTION = 0.05f;      // width of a cell, given in [m]
+const float OccupancyGrid::MINIMUM_RANGE = 0.1f;    // minimum distance of a point, given in [m]
+const float OccupancyGrid::MAXIMUM_RANGE = 6.0f;    // maximum distance of a ray, given in [m]
+
+/**
+ * Creates an OccupancyGrid object with all cells unknown.
+ * @param x the x coordinate of the lower left corner of the grid, given in [m].
+ * @param y the y coordinate of the lower left corner of the grid, given in [m].
+ */
+OccupancyGrid::OccupancyGrid(float x, float y) {
+    
+    this->x = x;
+    this->y = y;
+    
+    clear();
+}
+
+/**
+ * Deletes this object.
+ */
+OccupancyGrid::~OccupancyGrid() {}
+
+/**
+ * Sets all cells of this grid to unknown.
+ */
+void OccupancyGrid::clear() {
+    
+    mutex.lock();
+    
+    memset(cells, 0, sizeof(cells));
+    memset(dirty, 0xFF, sizeof(dirty));
+    
+    mutex.unlock();
+}
+
+/**
+ * Updates this grid with the points of a scan. Points without a valid measurement,
+ * i.e. with the default distance of the LIDAR, are skipped, because they may be obstacles
+ * that are too dark or too close to be measured.
+ * @param scan a reference to the scan, with points given in the coordinates of the robot.
+ * @param x the x coordinate of the pose of the robot at the time of the scan, given in [m].
+ * @param y the y coordinate of the pose of the robot, given in [m].
+ * @param alpha the orientation of the pose of the robot, given in [rad].
+ */
+void OccupancyGrid::update(Scan& scan, float x, float y, float alpha) {
+    
+    int column0 = static_cast<int>(floor((x-this->x)/RESOLUTION));
+    int row0 = static_cast<int>(floor((y-this->y)/RESOLUTION));
+    
+    if ((column0 < 0) || (column0 >= SIZE) || (row0 < 0) || (row0 >= SIZE)) return;
+    
+    float cosAlpha = cos(alpha);
+    float sinAlpha = sin(alpha);
+    
+    int previousColumn = -1;
+    int previousRow = -1;
+    
+    mutex.lock();
+    
+    for (unsigned short i = 0; i < scan.size; i++) {
+        
+        // skip points without a valid measurement, because their rays tell nothing about free space
+        
+        if (scan.r[i] >= LIDAR::DEFAULT_DISTANCE) continue;
+        
+        float pointX = scan.x[i];
+        float pointY = scan.y[i];
+        float distance = sqrt(pointX*pointX+pointY*pointY);
+        
+        if (distance < MINIMUM_RANGE) continue;
+        
+        // shorten rays without a point within the range to the maximum range
+        
+        bool hit = distance < MAXIMUM_RANGE;
+        
+        if (!hit) {
+            pointX *= MAXIMUM_RANGE/distance;
+            pointY *= MAXIMUM_RANGE/distance;
+        }
+        
+        int column1 = static_cast<int>(floor((x+cosAlpha*pointX-sinAlpha*pointY-this->x)/RESOLUTION));
+        int row1 = static_cast<int>(floor((y+sinAlpha*pointX+cosAlpha*pointY-this->y)/RESOLUTION));
+        
+        // neighbouring points at short range often end in the same cell, trace only one of these rays
+        
+        if ((column1 == previousColumn) && (row1 == previousRow)) continue;
+        
+        previousColumn = column1;
+        previousRow = row1;
+        
+        trace(column0, row0, column1, row1, hit);
+    }
+    
+    mutex.unlock();
+}
+
+/**
+ * Gets the log-odds of the occupancy of the cell at a given position.
+ * @param x the x coordinate of the position, given in [m].
+ * @param y the y coordinate of the position, given in [m].
+ * @return the log-odds, or 0 if the position is outside of this grid.
+ */
+int8_t OccupancyGrid::getLogOdds(float x, float y) {
+    
+    int column = static_cast<int>(floor((x-this->x)/RESOLUTION));
+    int row = static_cast<int>(floor((y-this->y)/RESOLUTION));
+    
+    if ((column < 0) || (column >= SIZE) || (row < 0) || (row >= SIZE)) return 0;
+    
+    return cells[index(column, row)];
+}
+
+/**
+ * Tells if the cell at a given position is occupied.
+ * @param x the x coordinate of the position, given in [m].
+ * @param y the y coordinate of the position, given in [m].
+ */
+bool OccupancyGrid::isOccupied(float x, float y) {
+    
+    return getLogOdds(x, y) > LOG_ODDS_OCCUPIED;
+}
+
+/**
+ * Gets the x coordinate of the lower left corner of this grid.
+ * @return the x coordinate, given in [m].
+ */
+float OccupancyGrid::getX() {
+    
+    return x;
+}
+
+/**
+ * Gets the y coordinate of the lower left corner of this grid.
+ * @return the y coordinate, given in [m].
+ */
+float OccupancyGrid::getY() {
+    
+    return y;
+}
+
+/**
+ * Marks all tiles as dirty, for example for a client that reads the whole grid.
+ */
+void OccupancyGrid::setDirty() {
+    
+    mutex.lock();
+    
+    memset(dirty, 0xFF, sizeof(dirty));
+    
+    mutex.unlock();
+}
+
+/**
+ * Gets the indices of the tiles that changed since they were read the last time.
+ * A tile has the index <code>row*TILES+column</code>.
+ * @param tiles an array that is filled with the indices of the dirty tiles.
+ * @param capacity the size of the array of tiles.
+ * @return the number of dirty tiles, but at most the capacity.
+ */
+unsigned short OccupancyGrid::getDirtyTiles(unsigned short tiles[], unsigned short capacity) {
+    
+    unsigned short size = 0;
+    
+    mutex.lock();
+    
+    for (unsigned short tile = 0; (tile < TILES*TILES) && (size < capacity); tile++) {
+        if (dirty[tile/32] & (1u << (tile%32))) tiles[size++] = tile;
+    }
+    
+    mutex.unlock();
+    
+    return size;
+}
+
+/**
+ * Reads the cells of a tile, and clears its dirty flag.
+ * @param tile the index of the tile.
+ * @param cells an array with <code>TILE_CELLS</code> elements, which is filled with the log-odds
+ * of the cells of the tile, row by row.
+ */
+void OccupancyGrid::getTile(unsigned short tile, int8_t cells[]) {
+    
+    if (tile >= TILES*TILES) return;
+    
+    mutex.lock();
+    
+    memcpy(cells, &this->cells[tile*TILE_CELLS], TILE_CELLS);
+    dirty[tile/32] &= ~(1u << (tile%32));
+    
+    mutex.unlock();
+}
+
+/**
+ * Gets the index of a cell in the array of cells.
+ */
+unsigned int OccupancyGrid::index(int column, int row) {
+    
+    return ((row/TILE_SIZE)*TILES+column/TILE_SIZE)*TILE_CELLS+(row%TILE_SIZE)*TILE_SIZE+column%TILE_SIZE;
+}
+
+/**
+ * Changes the log-odds of a cell, and marks its tile as dirty when the value changed.
+ */
+void OccupancyGrid::change(int column, int row, int8_t delta) {
+    
+    int8_t& cell = cells[index(column, row)];
+    
+    int value = cell+delta;
+    
+    if (value > LOG_ODDS_MAXIMUM) value = LOG_ODDS_MAXIMUM;
+    if (value < LOG_ODDS_MINIMUM) value = LOG_ODDS_MINIMUM;
+    
+    if (value != cell) {
+        
+        cell = static_cast<int8_t>(value);
+        
+        unsigned short tile = (row/TILE_SIZE)*TILES+column/TILE_SIZE;
+        dirty[tile/32] |= 1u << (tile%32);
+    }
+}
+
+/**
+ * Traces a ray with the Bresenham algorithm, and updates the cells along the ray.
+ * The cells of the ray are updated as free, and the last cell as occupied, when the ray
+ * ends at a point. The ray ends early, when it leaves this grid.
+ * @param column0 the column of the start of the ray, which must be within this grid.
+ * @param row0 the row of the start of the ray, which must be within this grid.
+ * @param column1 the column of the end of the ray.
+ * @param row1 the row of the end of the ray.
+ * @param hit a flag that the ray ends at a point.
+ */
+void OccupancyGrid::trace(int column0, int row0, int column1, int row1, bool hit) {
+    
+    int deltaColumn = abs(column1-column0);
+    int deltaRow = -abs(row1-row0);
+    int stepColumn = (column0 < column1) ? 1 : -1;
+    int stepRow = (row0 < row1) ? 1 : -1;
+    int error = deltaColumn+deltaRow;
+    
+    int column = column0;
+    int row = row0;
+    
+    while ((column != column1) || (row != row1)) {
+        
+        change(column, row, LOG_ODDS_MISS);
+        
+        int error2 = 2*error;
+        
+        if (error2 >= deltaRow) {
+            error += deltaRow;
+            column += stepColumn;
+        }
+        if (error2 <= deltaColumn) {
+            error += deltaColumn;
+            row += stepRow;
+        }
+        
+        if ((column < 0) || (column >= SIZE) || (row < 0) || (row >= SIZE)) return;
+    }
+    
+    change(column, row, hit ? LOG_ODDS_HIT : LOG_ODDS_MISS);
+}
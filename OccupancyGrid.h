@@ -0,0 +1,72 @@
+/*
+ * OccupancyGrid.h
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#ifndef OCCUPANCY_GRID_H_
+#define OCCUPANCY_GRID_H_
+
+#include <cstdlib>
+#include <stdint.h>
+#include <mbed.h>
+#include "Scan.h"
+
+/**
+ * This class builds an occupancy grid map from the scans of a LIDAR.
+ * <br/>
+ * Every cell stores the log-odds of its occupancy as a signed byte. The rays of
+ * a scan are traced with the Bresenham algorithm from the position of the robot
+ * to the measured points: the cells along a ray are updated as free, and the
+ * cell of the point as occupied. A ray ends early at the border of the grid, and
+ * a ray to the same cell as the previous ray is not traced again.
+ * <br/>
+ * The grid has a fixed size and is stored in square tiles, with the cells of a tile
+ * in contiguous memory. A tile is marked as dirty when one of its cells changed,
+ * so that a client only needs to read the tiles that changed since its last read.
+ * The grid is updated by one thread and can be read by other threads.
+ */
+class OccupancyGrid {
+    
+    public:
+        
+        static const unsigned short TILE_SIZE = 16;                     /**< Number of cells of a tile in each direction. */
+        static const unsigned short TILES = 16;                         /**< Number of tiles of the grid in each direction. */
+        static const unsigned short TILE_CELLS = TILE_SIZE*TILE_SIZE;   /**< Number of cells of a tile. */
+        static const float          RESOLUTION;                         /**< Width of a cell, given in [m]. */
+        
+                        OccupancyGrid(float x, float y);
+        virtual         ~OccupancyGrid();
+        void            clear();
+        void            update(Scan& scan, float x, float y, float alpha);
+        int8_t          getLogOdds(float x, float y);
+        bool            isOccupied(float x, float y);
+        float           getX();
+        float           getY();
+        void            setDirty();
+        unsigned short  getDirtyTiles(unsigned short tiles[], unsigned short capacity);
+        void            getTile(unsigned short tile, int8_t cells[]);
+        
+    private:
+        
+        static const unsigned short SIZE = TILES*TILE_SIZE;     // number of cells of the grid in each direction
+        static const int8_t         LOG_ODDS_HIT = 20;          // change of the log-odds of a cell with a point
+        static const int8_t         LOG_ODDS_MISS = -5;         // change of the log-odds of a cell that a ray passes through
+        static const int8_t         LOG_ODDS_MAXIMUM = 100;     // upper limit of the log-odds of a cell
+        static const int8_t         LOG_ODDS_MINIMUM = -100;    // lower limit of the log-odds of a cell
+        static const int8_t         LOG_ODDS_OCCUPIED = 40;     // log-odds above which a cell is occupied
+        static const float          MINIMUM_RANGE;              // minimum distance of a point, given in [m]
+        static const float          MAXIMUM_RANGE;              // maximum distance of a ray, given in [m]
+        
+        float           x;                                  // x coordinate of the lower left corner of the grid, given in [m]
+        float           y;                                  // y coordinate of the lower left corner of the grid, given in [m]
+        int8_t          cells[TILES*TILES*TILE_CELLS];      // log-odds of the cells, stored tile by tile
+        uint32_t        dirty[(TILES*TILES+31)/32];         // bit flags of the tiles that changed
+        Mutex           mutex;                              // mutex to lock critical sections
+        
+        unsigned int    index(int column, int row);
+        void            change(int column, int row, int8_t delta);
+        void            trace(int column0, int row0, int column1, int row1, bool hit);
+};
+
+#endif /* OCCUPANCY_GRID_H_ */
@@ -0,0 +1,472 @@
+/*
+ * ParticleFilter.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include <cmath>
+#include "ParticleFilter.h"
+
+using namespace std;
+
+const float ParticleFilter::M_PI = 3.14159265358979323846f;     // the mathematical constant PI
+const float ParticleFilter::RESOLUTION = 0.05f;                 // minimum width of a cell of the likelihood field, given in [m]
+const float ParticleFilter::MARGIN = 1.0f;                      // margin of the likelihood field around the landmarks, given in [m]
+const float ParticleFilter::SIGMA_HIT = 0.15f;                  // standard deviation of the position of a beacon, given in [m]
+const float ParticleFilter::Z_HIT = 0.9f;                       // probability that a beacon is measured at a landmark
+const float ParticleFilter::Z_RANDOM = 0.05f;                   // probability that a beacon is clutter
+const float ParticleFilter::TRANSLATION_NOISE = 0.1f;           // standard deviation of the translation, relative to the translation
+const float ParticleFilter::ROTATION_NOISE = 0.1f;              // standard deviation of the rotation, relative to the rotation
+const float ParticleFilter::MINIMUM_POSITION_NOISE = 0.01f;     // minimum standard deviation of the position per update, given in [m]
+const float ParticleFilter::MINIMUM_ORIENTATION_NOISE = 0.01f;  // minimum standard deviation of the orientation per update, given in [rad]
+const float ParticleFilter::CONVERGED_POSITION = 0.1f;          // maximum standard deviation of a converged position, given in [m]
+const float ParticleFilter::CONVERGED_ORIENTATION = 0.1f;       // maximum standard deviation of a converged orientation, given in [rad]
+
+/**
+ * Creates a ParticleFilter object, and spreads the particles over the area of the landmark map.
+ * @param landmarkMap a reference to the map with the landmarks, which must be loaded already.
+ */
+ParticleFilter::ParticleFilter(LandmarkMap& landmarkMap) : landmarkMap(landmarkMap) {
+    
+    seed = 0x2545F491;
+    
+    createField();
+    reset();
+}
+
+/**
+ * Deletes this object.
+ */
+ParticleFilter::~ParticleFilter() {}
+
+/**
+ * Spreads the particles uniformly over the area of the landmark map, with random orientations.
+ * This starts a new global localization. The particles are spread again with the first
+ * scan that contains beacons, see <code>spreadWithBeacons()</code>.
+ */
+void ParticleFilter::reset() {
+    
+    for (unsigned short i = 0; i < PARTICLES; i++) {
+        xs[i] = fieldX+uniform()*fieldColumns*fieldResolution;
+        ys[i] = fieldY+uniform()*fieldRows*fieldResolution;
+        alphas[i] = (2.0f*uniform()-1.0f)*M_PI;
+        weights[i] = 1.0f/PARTICLES;
+    }
+    
+    initialized = false;
+    spread = false;
+    convergedUpdates = 0;
+    
+    estimate();
+}
+
+/**
+ * Updates the particles with the odometry of the robot and the beacons of a scan.
+ * @param x the x coordinate of the pose of the robot from odometry at the time of the scan, given in [m].
+ * @param y the y coordinate of the pose of the robot from odometry, given in [m].
+ * @param alpha the orientation of the pose of the robot from odometry, given in [rad].
+ * @param beacons an array with the beacons of the scan, given in robot coordinates.
+ * @param size the number of beacons.
+ */
+void ParticleFilter::update(float x, float y, float alpha, Beacon beacons[], unsigned short size) {
+    
+    // move the particles with the motion since the previous update, given in the robot coordinates of the previous pose
+    
+    if (initialized) {
+        
+        float deltaX = x-previousX;
+        float deltaY = y-previousY;
+        float deltaAlpha = alpha-previousAlpha;
+        
+        while (deltaAlpha > M_PI) deltaAlpha -= 2.0f*M_PI;
+        while (deltaAlpha < -M_PI) deltaAlpha += 2.0f*M_PI;
+        
+        float cosAlpha = cos(previousAlpha);
+        float sinAlpha = sin(previousAlpha);
+        
+        move(cosAlpha*deltaX+sinAlpha*deltaY, -sinAlpha*deltaX+cosAlpha*deltaY, deltaAlpha);
+    }
+    
+    previousX = x;
+    previousY = y;
+    previousAlpha = alpha;
+    initialized = true;
+    
+    // weight and resample the particles with the beacons of this scan
+    
+    if (size > 0) {
+        if (!spread) spreadWithBeacons(beacons, size);
+        weight(beacons, size);
+        resample();
+    }
+    
+    estimate();
+}
+
+/**
+ * Tells if the particles have converged to a single pose.
+ */
+bool ParticleFilter::isConverged() {
+    
+    return convergedUpdates >= CONVERGED_UPDATES;
+}
+
+/**
+ * Gets the x coordinate of the estimated pose of the robot at the time of the last update.
+ * @return the x coordinate, given in [m].
+ */
+float ParticleFilter::getX() {
+    
+    return x;
+}
+
+/**
+ * Gets the y coordinate of the estimated pose of the robot at the time of the last update.
+ * @return the y coordinate, given in [m].
+ */
+float ParticleFilter::getY() {
+    
+    return y;
+}
+
+/**
+ * Gets the orientation of the estimated pose of the robot at the time of the last update.
+ * @return the orientation, given in [rad].
+ */
+float ParticleFilter::getAlpha() {
+    
+    return alpha;
+}
+
+/**
+ * Gets the covariance matrix of the estimated pose, calculated from the spread of the particles.
+ */
+Matrix<3, 3> ParticleFilter::getCovariance() {
+    
+    return p;
+}
+
+/**
+ * Gets the effective number of particles, given by the inverse sum of the squared weights.
+ * It is equal to the number of particles after a resampling, when all particles have the same
+ * weight, and the particles are resampled when it drops below half of the particles.
+ */
+float ParticleFilter::getEffectiveParticles() {
+    
+    float sum = 0.0f;
+    for (unsigned short i = 0; i < PARTICLES; i++) sum += weights[i]*weights[i];
+    
+    return 1.0f/sum;
+}
+
+/**
+ * Creates the likelihood field from the landmarks of the map.
+ * The field covers the landmarks with a margin, with at most FIELD_SIZE cells in each direction.
+ */
+void ParticleFilter::createField() {
+    
+    float minimumX = 0.0f;
+    float maximumX = 0.0f;
+    float minimumY = 0.0f;
+    float maximumY = 0.0f;
+    
+    for (unsigned int i = 0; i < landmarkMap.getSize(); i++) {
+        float x = landmarkMap.getX(i);
+        float y = landmarkMap.getY(i);
+        if ((i == 0) || (x < minimumX)) minimumX = x;
+        if ((i == 0) || (x > maximumX)) maximumX = x;
+        if ((i == 0) || (y < minimumY)) minimumY = y;
+        if ((i == 0) || (y > maximumY)) maximumY = y;
+    }
+    
+    fieldX = minimumX-MARGIN;
+    fieldY = minimumY-MARGIN;
+    
+    float width = maximumX-minimumX+2.0f*MARGIN;
+    float height = maximumY-minimumY+2.0f*MARGIN;
+    
+    fieldResolution = RESOLUTION;
+    if (width > FIELD_SIZE*fieldResolution) fieldResolution = width/FIELD_SIZE;
+    if (height > FIELD_SIZE*fieldResolution) fieldResolution = height/FIELD_SIZE;
+    
+    fieldColumns = static_cast<unsigned short>(ceil(width/fieldResolution));
+    fieldRows = static_cast<unsigned short>(ceil(height/fieldResolution));
+    
+    if (fieldColumns > FIELD_SIZE) fieldColumns = FIELD_SIZE;
+    if (fieldRows > FIELD_SIZE) fieldRows = FIELD_SIZE;
+    
+    // store the probability density of the distance to the nearest landmark in every cell
+    
+    for (unsigned short row = 0; row < fieldRows; row++) {
+        for (unsigned short column = 0; column < fieldColumns; column++) {
+            
+            float x = fieldX+(column+0.5f)*fieldResolution;
+            float y = fieldY+(row+0.5f)*fieldResolution;
+            
+            int landmark = landmarkMap.nearest(x, y, 3.0f*SIGMA_HIT);
+            
+            if (landmark >= 0) {
+                float dx = landmarkMap.getX(landmark)-x;
+                float dy = landmarkMap.getY(landmark)-y;
+                field[row][column] = static_cast<uint8_t>(255.0f*exp(-(dx*dx+dy*dy)/(2.0f*SIGMA_HIT*SIGMA_HIT))+0.5f);
+            } else {
+                field[row][column] = 0;
+            }
+        }
+    }
+}
+
+/**
+ * Spreads the particles over the poses, where the measured beacons are at the positions of landmarks.
+ * A uniform distribution of a few hundred particles over the whole area and all orientations
+ * rarely contains a particle close enough to the true pose. Instead, pairs of beacons are
+ * matched with pairs of landmarks at the same distance, and every match gives a full pose.
+ * When there are not enough matches, for example with a single beacon, the remaining particles
+ * are spread over the poses, where one beacon is at a landmark, with a random orientation.
+ * @param beacons an array with the beacons of the scan, given in robot coordinates.
+ * @param size the number of beacons.
+ */
+void ParticleFilter::spreadWithBeacons(Beacon beacons[], unsigned short size) {
+    
+    unsigned int landmarks = landmarkMap.getSize();
+    if (landmarks == 0) return;
+    
+    unsigned short i = 0;
+    
+    for (unsigned int attempt = 0; (attempt < SPREAD_ATTEMPTS) && (i < PARTICLES) && (size > 1) && (landmarks > 1); attempt++) {
+        
+        // draw two beacons and two landmarks, and compare their distances
+        
+        unsigned short beacon1 = random(size);
+        unsigned short beacon2 = random(size);
+        unsigned int landmark1 = random(landmarks);
+        unsigned int landmark2 = random(landmarks);
+        
+        if ((beacon1 == beacon2) || (landmark1 == landmark2)) continue;
+        
+        float beaconX = beacons[beacon2].x-beacons[beacon1].x;
+        float beaconY = beacons[beacon2].y-beacons[beacon1].y;
+        float landmarkX = landmarkMap.getX(landmark2)-landmarkMap.getX(landmark1);
+        float landmarkY = landmarkMap.getY(landmark2)-landmarkMap.getY(landmark1);
+        
+        if (fabs(sqrt(beaconX*beaconX+beaconY*beaconY)-sqrt(landmarkX*landmarkX+landmarkY*landmarkY)) > 2.0f*SIGMA_HIT) continue;
+        
+        // calculate the pose, that puts both beacons at their landmarks
+        
+        float alpha = atan2(landmarkY, landmarkX)-atan2(beaconY, beaconX)+SIGMA_HIT*gaussian()/sqrt(beaconX*beaconX+beaconY*beaconY);
+        float cosAlpha = cos(alpha);
+        float sinAlpha = sin(alpha);
+        
+        xs[i] = landmarkMap.getX(landmark1)-cosAlpha*beacons[beacon1].x+sinAlpha*beacons[beacon1].y+SIGMA_HIT*gaussian();
+        ys[i] = landmarkMap.getY(landmark1)-sinAlpha*beacons[beacon1].x-cosAlpha*beacons[beacon1].y+SIGMA_HIT*gaussian();
+        alphas[i] = atan2(sinAlpha, cosAlpha);
+        i++;
+    }
+    
+    for (; i < PARTICLES; i++) {
+        
+        // put a random beacon at a random landmark, with a random orientation
+        
+        unsigned short beacon = random(size);
+        unsigned int landmark = random(landmarks);
+        
+        float alpha = (2.0f*uniform()-1.0f)*M_PI;
+        float cosAlpha = cos(alpha);
+        float sinAlpha = sin(alpha);
+        
+        xs[i] = landmarkMap.getX(landmark)-cosAlpha*beacons[beacon].x+sinAlpha*beacons[beacon].y;
+        ys[i] = landmarkMap.getY(landmark)-sinAlpha*beacons[beacon].x-cosAlpha*beacons[beacon].y;
+        alphas[i] = alpha;
+    }
+    
+    for (i = 0; i < PARTICLES; i++) weights[i] = 1.0f/PARTICLES;
+    
+    spread = true;
+}
+
+/**
+ * Moves the particles with a given motion, and adds noise proportional to the motion.
+ * @param deltaX the translation in forward direction of the robot, given in [m].
+ * @param deltaY the translation to the left of the robot, given in [m].
+ * @param deltaAlpha the rotation, given in [rad].
+ */
+void ParticleFilter::move(float deltaX, float deltaY, float deltaAlpha) {
+    
+    float sigmaTranslation = TRANSLATION_NOISE*sqrt(deltaX*deltaX+deltaY*deltaY)+MINIMUM_POSITION_NOISE;
+    float sigmaRotation = ROTATION_NOISE*fabs(deltaAlpha)+MINIMUM_ORIENTATION_NOISE;
+    
+    for (unsigned short i = 0; i < PARTICLES; i++) {
+        
+        float translationX = deltaX+sigmaTranslation*gaussian();
+        float translationY = deltaY+sigmaTranslation*gaussian();
+        
+        float cosAlpha = cos(alphas[i]);
+        float sinAlpha = sin(alphas[i]);
+        
+        xs[i] += cosAlpha*translationX-sinAlpha*translationY;
+        ys[i] += sinAlpha*translationX+cosAlpha*translationY;
+        alphas[i] += deltaAlpha+sigmaRotation*gaussian();
+        
+        while (alphas[i] > M_PI) alphas[i] -= 2.0f*M_PI;
+        while (alphas[i] < -M_PI) alphas[i] += 2.0f*M_PI;
+    }
+}
+
+/**
+ * Weights the particles with the likelihood of the beacons of a scan.
+ * @param beacons an array with the beacons, given in robot coordinates.
+ * @param size the number of beacons.
+ */
+void ParticleFilter::weight(Beacon beacons[], unsigned short size) {
+    
+    float sum = 0.0f;
+    
+    for (unsigned short i = 0; i < PARTICLES; i++) {
+        
+        float cosAlpha = cos(alphas[i]);
+        float sinAlpha = sin(alphas[i]);
+        
+        float weight = weights[i];
+        
+        for (unsigned short j = 0; j < size; j++) {
+            
+            float x = cosAlpha*beacons[j].x-sinAlpha*beacons[j].y+xs[i];
+            float y = sinAlpha*beacons[j].x+cosAlpha*beacons[j].y+ys[i];
+            
+            int column = static_cast<int>(floor((x-fieldX)/fieldResolution));
+            int row = static_cast<int>(floor((y-fieldY)/fieldResolution));
+            
+            float likelihood = ((column >= 0) && (column < fieldColumns) && (row >= 0) && (row < fieldRows)) ? field[row][column]/255.0f : 0.0f;
+            
+            weight *= Z_HIT*likelihood+Z_RANDOM;
+        }
+        
+        weights[i] = weight;
+        sum += weight;
+    }
+    
+    // normalize the weights, or start with equal weights when all weights underflowed
+    
+    for (unsigned short i = 0; i < PARTICLES; i++) {
+        weights[i] = (sum > 0.0f) ? weights[i]/sum : 1.0f/PARTICLES;
+    }
+}
+
+/**
+ * Resamples the particles with a low variance sampler, when the effective number
+ * of particles dropped below half of the particles.
+ */
+void ParticleFilter::resample() {
+    
+    float sum = 0.0f;
+    for (unsigned short i = 0; i < PARTICLES; i++) sum += weights[i]*weights[i];
+    
+    if (sum*PARTICLES < 2.0f) return;
+    
+    // draw the particles with a single random number and equal steps
+    
+    float step = 1.0f/PARTICLES;
+    float threshold = uniform()*step;
+    float cumulative = weights[0];
+    unsigned short j = 0;
+    
+    for (unsigned short i = 0; i < PARTICLES; i++) {
+        
+        while ((threshold > cumulative) && (j < PARTICLES-1)) cumulative += weights[++j];
+        
+        resampledXs[i] = xs[j];
+        resampledYs[i] = ys[j];
+        resampledAlphas[i] = alphas[j];
+        
+        threshold += step;
+    }
+    
+    for (unsigned short i = 0; i < PARTICLES; i++) {
+        xs[i] = resampledXs[i];
+        ys[i] = resampledYs[i];
+        alphas[i] = resampledAlphas[i];
+        weights[i] = step;
+    }
+}
+
+/**
+ * Estimates the pose of the robot and its covariance matrix from the weighted particles.
+ */
+void ParticleFilter::estimate() {
+    
+    float sumX = 0.0f;
+    float sumY = 0.0f;
+    float sumCos = 0.0f;
+    float sumSin = 0.0f;
+    
+    for (unsigned short i = 0; i < PARTICLES; i++) {
+        sumX += weights[i]*xs[i];
+        sumY += weights[i]*ys[i];
+        sumCos += weights[i]*cos(alphas[i]);
+        sumSin += weights[i]*sin(alphas[i]);
+    }
+    
+    x = sumX;
+    y = sumY;
+    alpha = atan2(sumSin, sumCos);
+    
+    p = Matrix<3, 3>();
+    
+    for (unsigned short i = 0; i < PARTICLES; i++) {
+        
+        float deltaAlpha = alphas[i]-alpha;
+        
+        while (deltaAlpha > M_PI) deltaAlpha -= 2.0f*M_PI;
+        while (deltaAlpha < -M_PI) deltaAlpha += 2.0f*M_PI;
+        
+        float delta[] = {xs[i]-x, ys[i]-y, deltaAlpha};
+        
+        for (unsigned short j = 0; j < 3; j++) {
+            for (unsigned short k = 0; k < 3; k++) {
+                p(j, k) += weights[i]*delta[j]*delta[k];
+            }
+        }
+    }
+    
+    // the particles must stay together for a number of updates, so that ambiguous poses can die out
+    
+    if ((p(0, 0) < CONVERGED_POSITION*CONVERGED_POSITION) && (p(1, 1) < CONVERGED_POSITION*CONVERGED_POSITION) && (p(2, 2) < CONVERGED_ORIENTATION*CONVERGED_ORIENTATION)) {
+        if (convergedUpdates < CONVERGED_UPDATES) convergedUpdates++;
+    } else {
+        convergedUpdates = 0;
+    }
+}
+
+/**
+ * Gets a uniformly distributed random number in the range [0, 1), from a xorshift generator.
+ */
+float ParticleFilter::uniform() {
+    
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    
+    return static_cast<float>(seed >> 8)/16777216.0f;
+}
+
+/**
+ * Gets a uniformly distributed random index in the range [0, size).
+ */
+unsigned int ParticleFilter::random(unsigned int size) {
+    
+    unsigned int index = static_cast<unsigned int>(uniform()*size);
+    
+    return (index < size) ? index : size-1;
+}
+
+/**
+ * Gets a normally distributed random number with a standard deviation of 1,
+ * approximated with the sum of 12 uniformly distributed random numbers.
+ */
+float ParticleFilter::gaussian() {
+    
+    float sum = 0.0f;
+    for (unsigned short i = 0; i < 12; i++) sum += uniform();
+    
+    return sum-6.0f;
+}
@@ -0,0 +1,106 @@
+/*
+ * ParticleFilter.h
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#ifndef PARTICLE_FILTER_H_
+#define PARTICLE_FILTER_H_
+
+#include <cstdlib>
+#include <stdint.h>
+#include "Matrix.h"
+#include "Beacon.h"
+#include "LandmarkMap.h"
+
+/**
+ * This class implements a Monte Carlo localization of the robot with a particle filter.
+ * It estimates the pose of the robot without an initial pose, for example at start up
+ * or after the robot was moved by hand, and hands its estimate over to the Kalman
+ * filter of the controller, when the particles have converged.
+ * <br/>
+ * The particles are stored in separate arrays for every coordinate. They are moved
+ * with the odometry of the robot, weighted with the beacons of every scan, and
+ * resampled with a low variance sampler. The weights are taken from a likelihood
+ * field, a grid that is precomputed from the landmark map and stores the probability
+ * to measure a beacon in every cell, so that weighting a particle needs no search
+ * of the nearest landmark.
+ */
+class ParticleFilter {
+    
+    public:
+        
+        static const unsigned short PARTICLES = 300;    /**< Number of particles of this filter. */
+        
+                        ParticleFilter(LandmarkMap& landmarkMap);
+        virtual         ~ParticleFilter();
+        void            reset();
+        void            update(float x, float y, float alpha, Beacon beacons[], unsigned short size);
+        bool            isConverged();
+        float           getX();
+        float           getY();
+        float           getAlpha();
+        Matrix<3, 3>    getCovariance();
+        float           getEffectiveParticles();
+        
+    private:
+        
+        static const unsigned short FIELD_SIZE = 128;   // maximum number of cells of the likelihood field in each direction
+        static const unsigned short CONVERGED_UPDATES = 5;  // number of updates the particles must stay converged
+        static const unsigned int   SPREAD_ATTEMPTS = 4096; // maximum number of pairs of beacons and landmarks to compare
+        static const float          M_PI;               // the mathematical constant PI
+        static const float          RESOLUTION;         // minimum width of a cell of the likelihood field, given in [m]
+        static const float          MARGIN;             // margin of the likelihood field around the landmarks, given in [m]
+        static const float          SIGMA_HIT;          // standard deviation of the position of a beacon, given in [m]
+        static const float          Z_HIT;              // probability that a beacon is measured at a landmark
+        static const float          Z_RANDOM;           // probability that a beacon is clutter
+        static const float          TRANSLATION_NOISE;  // standard deviation of the translation, relative to the translation
+        static const float          ROTATION_NOISE;     // standard deviation of the rotation, relative to the rotation
+        static const float          MINIMUM_POSITION_NOISE;     // minimum standard deviation of the position per update, given in [m]
+        static const float          MINIMUM_ORIENTATION_NOISE;  // minimum standard deviation of the orientation per update, given in [rad]
+        static const float          CONVERGED_POSITION;         // maximum standard deviation of a converged position, given in [m]
+        static const float          CONVERGED_ORIENTATION;      // maximum standard deviation of a converged orientation, given in [rad]
+        
+        LandmarkMap&    landmarkMap;
+        
+        float           xs[PARTICLES];          // x coordinates of the particles, given in [m]
+        float           ys[PARTICLES];          // y coordinates of the particles, given in [m]
+        float           alphas[PARTICLES];      // orientations of the particles, given in [rad]
+        float           weights[PARTICLES];     // normalized weights of the particles
+        float           resampledXs[PARTICLES];         // x coordinates of the resampled particles, given in [m]
+        float           resampledYs[PARTICLES];         // y coordinates of the resampled particles, given in [m]
+        float           resampledAlphas[PARTICLES];     // orientations of the resampled particles, given in [rad]
+        
+        uint8_t         field[FIELD_SIZE][FIELD_SIZE];  // likelihood field, with the probability density scaled to 255
+        float           fieldX;                 // x coordinate of the origin of the likelihood field, given in [m]
+        float           fieldY;                 // y coordinate of the origin of the likelihood field, given in [m]
+        float           fieldResolution;        // width of a cell of the likelihood field, given in [m]
+        unsigned short  fieldColumns;           // number of columns of the likelihood field
+        unsigned short  fieldRows;              // number of rows of the likelihood field
+        
+        bool            initialized;            // flag that the odometry pose of the previous update is known
+        bool            spread;                 // flag that the particles were spread with the beacons of a scan
+        float           previousX;              // x coordinate of the odometry pose of the previous update, given in [m]
+        float           previousY;              // y coordinate of the odometry pose of the previous update, given in [m]
+        float           previousAlpha;          // orientation of the odometry pose of the previous update, given in [rad]
+        
+        float           x;                      // x coordinate of the estimated pose, given in [m]
+        float           y;                      // y coordinate of the estimated pose, given in [m]
+        float           alpha;                  // orientation of the estimated pose, given in [rad]
+        Matrix<3, 3>    p;                      // covariance matrix of the estimated pose
+        unsigned short  convergedUpdates;       // number of consecutive updates with converged particles
+        
+        uint32_t        seed;                   // state of the random number generator
+        
+        void            createField();
+        void            spreadWithBeacons(Beacon beacons[], unsigned short size);
+        void            move(float deltaX, float deltaY, float deltaAlpha);
+        void            weight(Beacon beacons[], unsigned short size);
+        void            resample();
+        void            estimate();
+        float           uniform();
+        unsigned int    random(unsigned int size);
+        float           gaussian();
+};
+
+#endif /* PARTICLE_FILTER_H_ */
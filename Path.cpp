@@ -0,0 +1,291 @@
+/*
+ * Path.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include <cmath>
+#include <algorithm>
+#include "Path.h"
+
+using namespace std;
+
+const float Path::M_PI = 3.14159265f;           // the mathematical constant PI
+const float Path::MINIMUM_DISTANCE = 0.001f;    // smallest distance between two waypoints, given in [m]
+
+/**
+ * Creates an empty path.
+ */
+Path::Path() {}
+
+/**
+ * Deletes this object.
+ */
+Path::~Path() {}
+
+/**
+ * Compiles a list of waypoints into a path. The velocity profile is not limited,
+ * until the <code>limitVelocity()</code> method is called.
+ * @param x an array with the x coordinates of the waypoints, given in [m].
+ * @param y an array with the y coordinates of the waypoints, given in [m].
+ * @param size the number of waypoints, at least 2.
+ * @param spline <code>true</code> to connect the waypoints with a spline, or <code>false</code> for straight lines.
+ * @return <code>true</code> if the path was compiled, <code>false</code> otherwise.
+ */
+bool Path::compile(const float x[], const float y[], unsigned short size, bool spline) {
+    
+    points.clear();
+    
+    // copy the waypoints without duplicates, and extend them with a phantom point at both ends
+    
+    vector<float> pointX;
+    vector<float> pointY;
+    
+    for (unsigned short i = 0; i < size; i++) {
+        if (pointX.empty() || (sqrt((x[i]-pointX.back())*(x[i]-pointX.back())+(y[i]-pointY.back())*(y[i]-pointY.back())) > MINIMUM_DISTANCE)) {
+            pointX.push_back(x[i]);
+            pointY.push_back(y[i]);
+        }
+    }
+    
+    unsigned int waypoints = pointX.size();
+    
+    if (waypoints < 2) return false;
+    
+    pointX.insert(pointX.begin(), 2.0f*pointX[0]-pointX[1]);
+    pointY.insert(pointY.begin(), 2.0f*pointY[0]-pointY[1]);
+    pointX.push_back(2.0f*pointX[waypoints]-pointX[waypoints-1]);
+    pointY.push_back(2.0f*pointY[waypoints]-pointY[waypoints-1]);
+    
+    // subdivide every segment into straight lines, or sample its centripetal Catmull-Rom spline
+    
+    PathPoint point = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+    
+    for (unsigned int i = 1; i < waypoints; i++) {
+        
+        float t0 = 0.0f;
+        float t1 = t0+sqrt(sqrt((pointX[i]-pointX[i-1])*(pointX[i]-pointX[i-1])+(pointY[i]-pointY[i-1])*(pointY[i]-pointY[i-1])));
+        float t2 = t1+sqrt(sqrt((pointX[i+1]-pointX[i])*(pointX[i+1]-pointX[i])+(pointY[i+1]-pointY[i])*(pointY[i+1]-pointY[i])));
+        float t3 = t2+sqrt(sqrt((pointX[i+2]-pointX[i+1])*(pointX[i+2]-pointX[i+1])+(pointY[i+2]-pointY[i+1])*(pointY[i+2]-pointY[i+1])));
+        
+        for (unsigned short j = 0; j < SUBDIVISIONS; j++) {
+            
+            if (spline) {
+                
+                float t = t1+(t2-t1)*j/SUBDIVISIONS;
+                
+                float a1x = ((t1-t)*pointX[i-1]+(t-t0)*pointX[i])/(t1-t0);
+                float a1y = ((t1-t)*pointY[i-1]+(t-t0)*pointY[i])/(t1-t0);
+                float a2x = ((t2-t)*pointX[i]+(t-t1)*pointX[i+1])/(t2-t1);
+                float a2y = ((t2-t)*pointY[i]+(t-t1)*pointY[i+1])/(t2-t1);
+                float a3x = ((t3-t)*pointX[i+1]+(t-t2)*pointX[i+2])/(t3-t2);
+                float a3y = ((t3-t)*pointY[i+1]+(t-t2)*pointY[i+2])/(t3-t2);
+                
+                float b1x = ((t2-t)*a1x+(t-t0)*a2x)/(t2-t0);
+                float b1y = ((t2-t)*a1y+(t-t0)*a2y)/(t2-t0);
+                float b2x = ((t3-t)*a2x+(t-t1)*a3x)/(t3-t1);
+                float b2y = ((t3-t)*a2y+(t-t1)*a3y)/(t3-t1);
+                
+                point.x = ((t2-t)*b1x+(t-t1)*b2x)/(t2-t1);
+                point.y = ((t2-t)*b1y+(t-t1)*b2y)/(t2-t1);
+                
+            } else {
+                
+                float r = static_cast<float>(j)/SUBDIVISIONS;
+                
+                point.x = pointX[i]+r*(pointX[i+1]-pointX[i]);
+                point.y = pointY[i]+r*(pointY[i+1]-pointY[i]);
+            }
+            
+            points.push_back(point);
+        }
+    }
+    
+    point.x = pointX[waypoints];
+    point.y = pointY[waypoints];
+    
+    points.push_back(point);
+    
+    unsigned int n = points.size();
+    
+    // calculate the arc length, the orientation and the curvature of every point
+    
+    for (unsigned int k = 1; k < n; k++) {
+        points[k].distance = points[k-1].distance+sqrt((points[k].x-points[k-1].x)*(points[k].x-points[k-1].x)+(points[k].y-points[k-1].y)*(points[k].y-points[k-1].y));
+    }
+    
+    for (unsigned int k = 0; k < n; k++) {
+        
+        unsigned int k0 = (k > 0) ? k-1 : k;
+        unsigned int k1 = (k < n-1) ? k+1 : k;
+        
+        points[k].alpha = atan2(points[k1].y-points[k0].y, points[k1].x-points[k0].x);
+        
+        // unwrap the orientation, so that it can be interpolated
+        
+        if (k > 0) {
+            while (points[k].alpha-points[k-1].alpha > M_PI) points[k].alpha -= 2.0f*M_PI;
+            while (points[k].alpha-points[k-1].alpha < -M_PI) points[k].alpha += 2.0f*M_PI;
+        }
+    }
+    
+    for (unsigned int k = 1; k < n-1; k++) {
+        points[k].curvature = (points[k+1].alpha-points[k-1].alpha)/(points[k+1].distance-points[k-1].distance);
+    }
+    
+    return true;
+}
+
+/**
+ * Calculates the velocity profile of this path, that starts and ends with zero velocity.
+ * @param velocity the maximum translational velocity, given in [m/s].
+ * @param acceleration the maximum translational acceleration and deceleration, given in [m/s2].
+ * @param lateralAcceleration the maximum lateral acceleration in curves, given in [m/s2].
+ */
+void Path::limitVelocity(float velocity, float acceleration, float lateralAcceleration) {
+    
+    unsigned int n = points.size();
+    
+    if (n < 2) return;
+    
+    for (unsigned int k = 0; k < n; k++) {
+        points[k].velocity = (fabs(points[k].curvature)*velocity*velocity > lateralAcceleration) ? sqrt(lateralAcceleration/fabs(points[k].curvature)) : velocity;
+    }
+    
+    points[0].velocity = 0.0f;
+    points[n-1].velocity = 0.0f;
+    
+    for (unsigned int k = 1; k < n; k++) {
+        points[k].velocity = min(points[k].velocity, sqrt(points[k-1].velocity*points[k-1].velocity+2.0f*acceleration*(points[k].distance-points[k-1].distance)));
+    }
+    
+    for (unsigned int k = n-1; k > 0; k--) {
+        points[k-1].velocity = min(points[k-1].velocity, sqrt(points[k].velocity*points[k].velocity+2.0f*acceleration*(points[k].distance-points[k-1].distance)));
+    }
+}
+
+/**
+ * Gets the number of points of this path.
+ */
+unsigned int Path::getSize() {
+    
+    return points.size();
+}
+
+/**
+ * Gets the length of this path.
+ * @return the length, given in [m].
+ */
+float Path::getLength() {
+    
+    return points.empty() ? 0.0f : points.back().distance;
+}
+
+/**
+ * Gets the x coordinate of a point of this path.
+ * @param index the index of the point, which must be smaller than the size of the path.
+ * @return the x coordinate, given in [m].
+ */
+float Path::getX(unsigned int index) {
+    
+    return points[index].x;
+}
+
+/**
+ * Gets the y coordinate of a point of this path.
+ * @param index the index of the point, which must be smaller than the size of the path.
+ * @return the y coordinate, given in [m].
+ */
+float Path::getY(unsigned int index) {
+    
+    return points[index].y;
+}
+
+/**
+ * Gets the arc length from the start of this path to a point.
+ * @param index the index of the point, which must be smaller than the size of the path.
+ * @return the arc length, given in [m].
+ */
+float Path::getDistance(unsigned int index) {
+    
+    return points[index].distance;
+}
+
+/**
+ * Gets the orientation of this path at a point. The orientation is unwrapped along the path,
+ * so that it can be interpolated between points.
+ * @param index the index of the point, which must be smaller than the size of the path.
+ * @return the orientation, given in [rad].
+ */
+float Path::getAlpha(unsigned int index) {
+    
+    return points[index].alpha;
+}
+
+/**
+ * Gets the curvature of this path at a point.
+ * @param index the index of the point, which must be smaller than the size of the path.
+ * @return the curvature, positive to the left, given in [1/m].
+ */
+float Path::getCurvature(unsigned int index) {
+    
+    return points[index].curvature;
+}
+
+/**
+ * Gets the maximum velocity of the velocity profile at a point.
+ * @param index the index of the point, which must be smaller than the size of the path.
+ * @return the velocity, given in [m/s].
+ */
+float Path::getVelocity(unsigned int index) {
+    
+    return points[index].velocity;
+}
+
+/**
+ * Searches the point of this path that is closest to a given position, starting from the
+ * index of a previous search. The search advances along the path, as long as the distance
+ * to the position decreases, so it finds the next local minimum of the distance.
+ * @param x the x coordinate of the position, given in [m].
+ * @param y the y coordinate of the position, given in [m].
+ * @param index the index of the point to start the search from.
+ * @return the index of the closest point.
+ */
+unsigned int Path::findClosestPoint(float x, float y, unsigned int index) {
+    
+    unsigned int n = points.size();
+    
+    if (index >= n) return (n > 0) ? n-1 : 0;
+    
+    float distance = (points[index].x-x)*(points[index].x-x)+(points[index].y-y)*(points[index].y-y);
+    
+    while (index < n-1) {
+        
+        float nextDistance = (points[index+1].x-x)*(points[index+1].x-x)+(points[index+1].y-y)*(points[index+1].y-y);
+        
+        if (nextDistance > distance) break;
+        
+        distance = nextDistance;
+        index++;
+    }
+    
+    return index;
+}
+
+/**
+ * Searches the first point of this path with at least a given arc length,
+ * starting from the index of a previous search.
+ * @param distance the arc length from the start of the path, given in [m].
+ * @param index the index of the point to start the search from.
+ * @return the index of the point, or the index of the last point.
+ */
+unsigned int Path::findPoint(float distance, unsigned int index) {
+    
+    unsigned int n = points.size();
+    
+    if (n == 0) return 0;
+    
+    while ((index < n-1) && (points[index].distance < distance)) index++;
+    
+    return index;
+}
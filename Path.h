@@ -0,0 +1,62 @@
+/*
+ * Path.h
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#ifndef PATH_H_
+#define PATH_H_
+
+#include <cstdlib>
+#include <vector>
+
+/**
+ * This class stores a geometric path through a list of waypoints, with a velocity profile.
+ * <br/>
+ * The waypoints are connected either with straight lines, or with a centripetal Catmull-Rom
+ * spline, which passes through every waypoint without loops or cusps. Every segment is
+ * subdivided into points with their arc length, orientation and curvature. A velocity profile
+ * along the arc length is limited by a maximum velocity, a maximum lateral acceleration in
+ * curves, and a maximum acceleration and deceleration, and is zero at the end of the path.
+ * <br/>
+ * Points on the path are searched incrementally, starting from the index of a previous search,
+ * so that a task that follows the path does not need to scan the whole path in every period.
+ */
+class Path {
+    
+    public:
+        
+                        Path();
+        virtual         ~Path();
+        bool            compile(const float x[], const float y[], unsigned short size, bool spline);
+        void            limitVelocity(float velocity, float acceleration, float lateralAcceleration);
+        unsigned int    getSize();
+        float           getLength();
+        float           getX(unsigned int index);
+        float           getY(unsigned int index);
+        float           getDistance(unsigned int index);
+        float           getAlpha(unsigned int index);
+        float           getCurvature(unsigned int index);
+        float           getVelocity(unsigned int index);
+        unsigned int    findClosestPoint(float x, float y, unsigned int index);
+        unsigned int    findPoint(float distance, unsigned int index);
+        
+    private:
+        
+        static const unsigned short SUBDIVISIONS = 32;  // number of points per segment
+        static const float          M_PI;               // the mathematical constant PI
+        static const float          MINIMUM_DISTANCE;   // smallest distance between two waypoints, given in [m]
+        
+        struct PathPoint {
+            float   x;              // x coordinate, given in [m]
+            float   y;              // y coordinate, given in [m]
+            float   distance;       // arc length from the start of the path, given in [m]
+            float   alpha;          // orientation of the path, unwrapped along the path, given in [rad]
+            float   curvature;      // curvature of the path, given in [1/m]
+            float   velocity;       // maximum translational velocity, given in [m/s]
+        };
+        
+        std::vector<PathPoint>  points;         // points of the path
+};
+
+#endif /* PATH_H_ */
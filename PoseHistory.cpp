@@ -0,0 +1,208 @@
+/*
+ * PoseHistory.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include "PoseHistory.h"
+
+using namespace std;
+
+const float PoseHistory::M_PI = 3.14159265f;    // the mathematical constant PI
+
+/**
+ * Creates an empty PoseHistory object.
+ */
+PoseHistory::PoseHistory() {
+    
+    size = 0;
+    next = 0;
+    sequence = 0;
+}
+
+/**
+ * Deletes this object.
+ */
+PoseHistory::~PoseHistory() {}
+
+/**
+ * Adds a pose to this history. The poses must be added in chronological order.
+ * When the history is full, the oldest pose is overwritten. This method never
+ * blocks, and it must only be called by one thread.
+ * @param time the time of this pose, given in [us].
+ * @param x the x coordinate of the robot, given in [m].
+ * @param y the y coordinate of the robot, given in [m].
+ * @param alpha the orientation of the robot, given in [rad].
+ */
+void PoseHistory::add(uint32_t time, float x, float y, float alpha) {
+    
+    uint32_t sequence = this->sequence;
+    
+    core_util_atomic_store_u32(&this->sequence, sequence+1);
+    
+    times[next] = time;
+    xs[next] = x;
+    ys[next] = y;
+    alphas[next] = alpha;
+    
+    next = (next+1)%CAPACITY;
+    if (size < CAPACITY) size++;
+    
+    core_util_atomic_store_u32(&this->sequence, sequence+2);
+}
+
+/**
+ * Gets the pose of the robot at a given time.
+ * The pose is interpolated linearly between the two poses of this history
+ * before and after the given time. If the given time is later than the
+ * latest pose, the latest pose is returned.
+ * <br/>
+ * The pose is read again, if a pose was added while it was read. This method
+ * must not be called from a thread with a higher priority than the thread that
+ * adds the poses.
+ * @param time the time to get the pose for, given in [us].
+ * @param x a reference to a variable that is set to the x coordinate of the robot, given in [m].
+ * @param y a reference to a variable that is set to the y coordinate of the robot, given in [m].
+ * @param alpha a reference to a variable that is set to the orientation of the robot, given in [rad].
+ * @return <code>true</code> if a pose was found, <code>false</code> if the given time is older than this history.
+ */
+bool PoseHistory::get(uint32_t time, float& x, float& y, float& alpha) {
+    
+    bool found = false;
+    uint32_t sequence = 0;
+    
+    do {
+        sequence = core_util_atomic_load_u32(&this->sequence);
+        found = interpolate(time, x, y, alpha);
+    } while ((sequence & 1) || (sequence != core_util_atomic_load_u32(&this->sequence)));
+    
+    return found;
+}
+
+/**
+ * Copies the poses of this history that are needed to interpolate the poses within a given
+ * time interval into another history, which is then read without competing with the writer.
+ * The copy starts with the latest pose not later than the start of the interval, or with the
+ * oldest pose, and it ends with the earliest pose not earlier than the end of the interval, or
+ * with the latest pose. Like <code>get()</code>, this method must not be called from a thread
+ * with a higher priority than the thread that adds the poses.
+ * @param start the start of the time interval, given in [us].
+ * @param end the end of the time interval, given in [us].
+ * @param span a reference to a history that is owned by the calling thread, and that is
+ * overwritten with the copied poses.
+ * @return <code>true</code> if poses were copied, <code>false</code> if this history is empty.
+ */
+bool PoseHistory::getSpan(uint32_t start, uint32_t end, PoseHistory& span) {
+    
+    uint32_t sequence = 0;
+    uint32_t spanSequence = span.sequence;
+    
+    core_util_atomic_store_u32(&span.sequence, spanSequence+1);
+    
+    do {
+        
+        sequence = core_util_atomic_load_u32(&this->sequence);
+        
+        span.size = 0;
+        span.next = 0;
+        
+        if (size > 0) {
+            
+            // find the first and the last pose to copy, given as offsets from the oldest pose
+            
+            unsigned short oldest = (next+CAPACITY-size)%CAPACITY;
+            
+            unsigned short first = ((int32_t)(start-times[oldest]) < 0) ? 0 : search(start);
+            unsigned short last = ((int32_t)(end-times[oldest]) < 0) ? 0 : search(end);
+            
+            if ((last < size-1) && (times[(oldest+last)%CAPACITY] != end)) last++;
+            
+            for (unsigned short i = first; i <= last; i++) {
+                
+                unsigned short j = (oldest+i)%CAPACITY;
+                
+                span.times[span.next] = times[j];
+                span.xs[span.next] = xs[j];
+                span.ys[span.next] = ys[j];
+                span.alphas[span.next] = alphas[j];
+                
+                span.next++;
+            }
+            
+            span.size = span.next;
+            span.next %= CAPACITY;
+        }
+        
+    } while ((sequence & 1) || (sequence != core_util_atomic_load_u32(&this->sequence)));
+    
+    core_util_atomic_store_u32(&span.sequence, spanSequence+2);
+    
+    return span.size > 0;
+}
+
+/**
+ * Searches the latest pose that is not later than a given time, with a binary search.
+ * The differences of times are signed to handle the overflow of the time. This method
+ * assumes that this history is not empty, and that the given time is not older than it.
+ * @return the offset of the pose from the oldest pose of this history.
+ */
+unsigned short PoseHistory::search(uint32_t time) {
+    
+    unsigned short oldest = (next+CAPACITY-size)%CAPACITY;
+    
+    unsigned short low = 0;
+    unsigned short high = size-1;
+    
+    while (low < high) {
+        unsigned short middle = (low+high+1)/2;
+        if ((int32_t)(time-times[(oldest+middle)%CAPACITY]) >= 0) low = middle; else high = middle-1;
+    }
+    
+    return low;
+}
+
+/**
+ * Interpolates the pose of the robot at a given time, without checking the sequence counter.
+ * @return <code>true</code> if a pose was found, <code>false</code> if the given time is older than this history.
+ */
+bool PoseHistory::interpolate(uint32_t time, float& x, float& y, float& alpha) {
+    
+    if (size == 0) return false;
+    
+    unsigned short oldest = (next+CAPACITY-size)%CAPACITY;
+    
+    if ((int32_t)(time-times[oldest]) < 0) return false;
+    
+    unsigned short low = search(time);
+    unsigned short i = (oldest+low)%CAPACITY;
+    
+    if (low == size-1) {
+        
+        // the given time is later than the latest pose
+        
+        x = xs[i];
+        y = ys[i];
+        alpha = alphas[i];
+        
+    } else {
+        
+        // interpolate between this pose and the next pose
+        
+        unsigned short j = (i+1)%CAPACITY;
+        
+        float fraction = (times[j] != times[i]) ? (float)(time-times[i])/(float)(times[j]-times[i]) : 0.0f;
+        
+        float deltaAlpha = alphas[j]-alphas[i];
+        while (deltaAlpha > M_PI) deltaAlpha -= 2.0f*M_PI;
+        while (deltaAlpha < -M_PI) deltaAlpha += 2.0f*M_PI;
+        
+        x = xs[i]+fraction*(xs[j]-xs[i]);
+        y = ys[i]+fraction*(ys[j]-ys[i]);
+        alpha = alphas[i]+fraction*deltaAlpha;
+        
+        while (alpha > M_PI) alpha -= 2.0f*M_PI;
+        while (alpha < -M_PI) alpha += 2.0f*M_PI;
+    }
+    
+    return true;
+}
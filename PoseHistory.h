@@ -0,0 +1,53 @@
+/*
+ * PoseHistory.h
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#ifndef POSE_HISTORY_H_
+#define POSE_HISTORY_H_
+
+#include <cstdlib>
+#include <mbed.h>
+
+/**
+ * This class stores a short history of poses of the robot in a ring buffer.
+ * It allows to get the pose of the robot at a given time in the recent past,
+ * for example to compensate the motion of the robot during a scan of a LIDAR.
+ * The poses are added by one thread, like the controller, and can be read
+ * by other threads.
+ * <br/>
+ * The history is written without a mutex, so that adding a pose never blocks.
+ * A sequence counter is odd while a pose is added, and readers repeat their
+ * reading, when the counter was odd or changed while they read. A reader that
+ * needs many poses, like the de-skewing of a scan, should copy the span of
+ * poses it needs once with <code>getSpan()</code>, and then read the copy.
+ */
+class PoseHistory {
+    
+    public:
+        
+                        PoseHistory();
+        virtual         ~PoseHistory();
+        void            add(uint32_t time, float x, float y, float alpha);
+        bool            get(uint32_t time, float& x, float& y, float& alpha);
+        bool            getSpan(uint32_t start, uint32_t end, PoseHistory& span);
+        
+    private:
+        
+        static const unsigned short CAPACITY = 128; // number of poses in the ring buffer
+        static const float          M_PI;           // the mathematical constant PI
+        
+        uint32_t        times[CAPACITY];    // times of the poses, given in [us]
+        float           xs[CAPACITY];       // x coordinates of the poses, given in [m]
+        float           ys[CAPACITY];       // y coordinates of the poses, given in [m]
+        float           alphas[CAPACITY];   // orientations of the poses, given in [rad]
+        unsigned short  size;               // number of poses in the ring buffer
+        unsigned short  next;               // index of the next pose to write
+        volatile uint32_t sequence;         // sequence counter, odd while a pose is added
+        
+        unsigned short  search(uint32_t time);
+        bool            interpolate(uint32_t time, float& x, float& y, float& alpha);
+};
+
+#endif /* POSE_HISTORY_H_ */
@@ -0,0 +1,28 @@
+/*
+ * PoseSnapshot.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include "PoseSnapshot.h"
+
+using namespace std;
+
+/**
+ * Creates a PoseSnapshot object with a zero pose and covariance matrix.
+ */
+PoseSnapshot::PoseSnapshot() {
+    
+    x = 0.0f;
+    y = 0.0f;
+    alpha = 0.0f;
+    cosAlpha = 1.0f;
+    sinAlpha = 0.0f;
+    
+    time = 0;
+}
+
+/**
+ * Deletes this object.
+ */
+PoseSnapshot::~PoseSnapshot() {}
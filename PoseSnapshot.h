@@ -0,0 +1,34 @@
+/*
+ * PoseSnapshot.h
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#ifndef POSE_SNAPSHOT_H_
+#define POSE_SNAPSHOT_H_
+
+#include <cstdlib>
+#include <stdint.h>
+#include "Matrix.h"
+
+/**
+ * This class stores a consistent copy of the pose of the robot
+ * and its covariance matrix, as estimated by the controller.
+ */
+class PoseSnapshot {
+    
+    public:
+        
+        float           x;          /**< X coordinate of the position, given in [m]. */
+        float           y;          /**< Y coordinate of the position, given in [m]. */
+        float           alpha;      /**< Orientation, given in [rad]. */
+        float           cosAlpha;   /**< Cosine of the orientation. */
+        float           sinAlpha;   /**< Sine of the orientation. */
+        Matrix<3, 3>    p;          /**< Covariance matrix of the pose. */
+        uint32_t        time;       /**< Time of this pose, given in [us]. */
+        
+                        PoseSnapshot();
+        virtual         ~PoseSnapshot();
+};
+
+#endif /* POSE_SNAPSHOT_H_ */
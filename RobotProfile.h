@@ -0,0 +1,71 @@
+/*
+ * RobotProfile.h
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#ifndef ROBOT_PROFILE_H_
+#define ROBOT_PROFILE_H_
+
+#include <cstdlib>
+
+/**
+ * This is the profile of the Pololu gear motors with their encoders.
+ */
+struct PololuMotor {
+    
+    static constexpr float  COUNTS_PER_TURN = 1200.0f;      /**< Encoder resolution, given in [counts/turn]. */
+    static constexpr float  KN = 40.0f;                     /**< Speed constant, given in [rpm/V]. */
+    static constexpr float  TIME_CONSTANT = 0.05f;          /**< Mechanical time constant, given in [s]. */
+};
+
+/**
+ * This is the profile of the Maxon gear motors with their encoders.
+ */
+struct MaxonMotor {
+    
+    static constexpr float  COUNTS_PER_TURN = 86016.0f;     /**< Encoder resolution, given in [counts/turn]. */
+    static constexpr float  KN = 45.0f;                     /**< Speed constant, given in [rpm/V]. */
+    static constexpr float  TIME_CONSTANT = 0.03f;          /**< Mechanical time constant, given in [s]. */
+};
+
+/**
+ * This class describes the motors, the geometry and the control period of the
+ * ROME2 mobile robot, with the conversion factors derived from these values.
+ * All values are constant expressions, so that the conversions in the periodic
+ * task of the controller are folded into single multiplications at compile time.
+ * The motor profile is selected with the <code>maxon-motors</code> option of the
+ * application configuration.
+ */
+template <typename Motor>
+struct RobotProfile {
+    
+    static constexpr float  PERIOD = 0.001f;                /**< Period of the control task, given in [s]. */
+    static constexpr float  PI = 3.14159265f;               /**< The mathematical constant PI. */
+    static constexpr float  WHEEL_DISTANCE = 0.190f;        /**< Distance between the wheels, given in [m]. */
+    static constexpr float  WHEEL_RADIUS = 0.0375f;         /**< Radius of the wheels, given in [m]. */
+    static constexpr float  MAXIMUM_VELOCITY = 500.0f;      /**< Maximum wheel velocity, given in [rpm]. */
+    static constexpr float  MAXIMUM_ACCELERATION = 200.0f;  /**< Maximum wheel acceleration, given in [rpm/s]. */
+    static constexpr float  MAXIMUM_JERK = 2000.0f;         /**< Maximum wheel jerk, given in [rpm/s2]. */
+    static constexpr float  COUNTS_PER_TURN = Motor::COUNTS_PER_TURN;   /**< Encoder resolution, given in [counts/turn]. */
+    static constexpr float  KN = Motor::KN;                 /**< Speed constant, given in [rpm/V]. */
+    static constexpr float  TIME_CONSTANT = Motor::TIME_CONSTANT;       /**< Mechanical time constant, given in [s]. */
+    static constexpr float  KP = 0.15f;                     /**< Proportional gain of the speed controller, given in [V/rpm]. */
+    static constexpr float  KI = 3.0f;                      /**< Integral gain of the speed controller, given in [V/rpm/s]. */
+    static constexpr float  MAX_VOLTAGE = 12.0f;            /**< Battery voltage, given in [V]. */
+    
+    static constexpr float  HALF_WHEEL_DISTANCE = WHEEL_DISTANCE/2.0f;              /**< Half the distance between the wheels, given in [m]. */
+    static constexpr float  RPM_PER_VELOCITY = 60.0f/(2.0f*PI*WHEEL_RADIUS);        /**< Wheel speed in [rpm] per wheel velocity in [m/s]. */
+    static constexpr float  TRANSLATION_PER_RPM = PI/60.0f*WHEEL_RADIUS;            /**< Translational velocity in [m/s] per sum of wheel speeds in [rpm]. */
+    static constexpr float  ROTATION_PER_RPM = 2.0f*PI/60.0f*WHEEL_RADIUS/WHEEL_DISTANCE;   /**< Rotational velocity in [rad/s] per sum of wheel speeds in [rpm]. */
+    static constexpr float  RPM_PER_COUNT_RATE = 60.0f/COUNTS_PER_TURN;             /**< Wheel speed in [rpm] per encoder rate in [counts/s]. */
+    static constexpr float  DUTY_CYCLE_PER_VOLTAGE = 0.5f/MAX_VOLTAGE;              /**< Change of the duty-cycle per voltage in [V]. */
+};
+
+#if MBED_CONF_APP_MAXON_MOTORS
+typedef RobotProfile<MaxonMotor> DefaultRobotProfile;
+#else
+typedef RobotProfile<PololuMotor> DefaultRobotProfile;
+#endif
+
+#endif /* ROBOT_PROFILE_H_ */
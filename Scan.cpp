@@ -0,0 +1,58 @@
+/*
+ * Scan.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include "Scan.h"
+
+using namespace std;
+
+/**
+ * Creates an empty Scan object.
+ */
+Scan::Scan() {
+    
+    clear();
+}
+
+/**
+ * Deletes this object.
+ */
+Scan::~Scan() {}
+
+/**
+ * Removes all points from this scan.
+ */
+void Scan::clear() {
+    
+    size = 0;
+    revolution = 0;
+    timestamp = 0;
+}
+
+/**
+ * Adds a point given in polar coordinates to this scan.
+ * The cosine and sine of the angle are given by the caller,
+ * so that they can be taken from precomputed tables.
+ * @param r the distance of the point, given in [m].
+ * @param alpha the angle of the point, given in [rad].
+ * @param cosAlpha the cosine of the angle.
+ * @param sinAlpha the sine of the angle.
+ * @param time the time of the measurement of the point, given in [us].
+ * @return <code>true</code> if the point was added, <code>false</code> if this scan is full.
+ */
+bool Scan::add(float r, float alpha, float cosAlpha, float sinAlpha, uint32_t time) {
+    
+    if (size >= CAPACITY) return false;
+    
+    this->r[size] = r;
+    this->alpha[size] = alpha;
+    x[size] = r*cosAlpha;
+    y[size] = r*sinAlpha;
+    this->time[size] = time;
+    
+    size++;
+    
+    return true;
+}
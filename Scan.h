@@ -0,0 +1,40 @@
+/*
+ * Scan.h
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#ifndef SCAN_H_
+#define SCAN_H_
+
+#include <cstdlib>
+#include <stdint.h>
+
+/**
+ * This class stores the points of a full 360 degree scan of a LIDAR.
+ * The points are stored in contiguous arrays with a fixed capacity, one array
+ * per coordinate, so that a scan can be filled again and again without
+ * allocating any memory on the heap.
+ */
+class Scan {
+    
+    public:
+        
+        static const unsigned short CAPACITY = 1536;    /**< Maximum number of points of a scan. */
+        
+        unsigned short  size;               /**< Number of points of this scan. */
+        unsigned int    revolution;         /**< Number of the revolution of this scan. */
+        uint32_t        timestamp;          /**< Time when this revolution was completed, given in [us]. */
+        float           r[CAPACITY];        /**< Distances of the points, given in [m]. */
+        float           alpha[CAPACITY];    /**< Angles of the points, given in [rad]. */
+        float           x[CAPACITY];        /**< X coordinates of the points, given in [m]. */
+        float           y[CAPACITY];        /**< Y coordinates of the points, given in [m]. */
+        uint32_t        time[CAPACITY];     /**< Times of the measurements of the points, given in [us]. */
+        
+                        Scan();
+        virtual         ~Scan();
+        void            clear();
+        bool            add(float r, float alpha, float cosAlpha, float sinAlpha, uint32_t time);
+};
+
+#endif /* SCAN_H_ */
@@ -0,0 +1,439 @@
+/*
+ * ScanMatcher.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <mbed.h>
+#include "ScanMatcher.h"
+
+using namespace std;
+
+const float ScanMatcher::RESOLUTION = 0.1f;                 // minimum width of a cell of the lookup grid, given in [m]
+const float ScanMatcher::MARGIN = 0.5f;                     // margin of the lookup grid around the segments, given in [m]
+const float ScanMatcher::MINIMUM_RANGE = 0.1f;              // minimum distance of a point, given in [m]
+const float ScanMatcher::MAXIMUM_RANGE = 6.0f;              // maximum distance of a point, given in [m]
+const float ScanMatcher::MAXIMUM_DISTANCE = 0.2f;           // maximum distance of a point to its segment, given in [m]
+const float ScanMatcher::DAMPING = 0.001f;                  // damping of the Gauss-Newton steps, given in [m2]
+const float ScanMatcher::CONVERGED_TRANSLATION = 0.001f;    // translation of an iteration at which a match converged, given in [m]
+const float ScanMatcher::CONVERGED_ROTATION = 0.001f;       // rotation of an iteration at which a match converged, given in [rad]
+const float ScanMatcher::MAXIMUM_TRANSLATION = 0.3f;        // maximum translation of a valid match, given in [m]
+const float ScanMatcher::MAXIMUM_ROTATION = 0.3f;           // maximum rotation of a valid match, given in [rad]
+const float ScanMatcher::SIGMA_DISTANCE = 0.05f;            // standard deviation of the distance of a point to its segment, given in [m]
+
+/**
+ * Creates a ScanMatcher object with an empty map.
+ */
+ScanMatcher::ScanMatcher() {
+    
+    size = 0;
+    xs = NULL;
+    ys = NULL;
+    directionXs = NULL;
+    directionYs = NULL;
+    lengths = NULL;
+    
+    grid = NULL;
+    gridX = 0.0f;
+    gridY = 0.0f;
+    gridResolution = RESOLUTION;
+    gridColumns = 0;
+    gridRows = 0;
+    
+    iterations = 0;
+    correspondences = 0;
+    duration = 0;
+}
+
+/**
+ * Deletes this object.
+ */
+ScanMatcher::~ScanMatcher() {
+    
+    clear();
+}
+
+/**
+ * Loads the segments of the reference map from a file, for example from the SD card with
+ * the filename <code>/fs/segments.txt</code>. The map is only replaced, when the file
+ * could be read and contains at least one segment.
+ * @param filename the name of the file to read.
+ * @return <code>true</code> if the map was loaded, <code>false</code> otherwise.
+ */
+bool ScanMatcher::load(const char* filename) {
+    
+    FILE* file = fopen(filename, "r");
+    if (file == NULL) return false;
+    
+    // count the segments of the file, and read them in a second pass
+    
+    char line[128];
+    unsigned short size = 0;
+    
+    while ((size < MAXIMUM_SEGMENTS) && (fgets(line, sizeof(line), file) != NULL)) {
+        float x1, y1, x2, y2;
+        if ((line[0] != '#') && (sscanf(line, "%f %f %f %f", &x1, &y1, &x2, &y2) == 4)) size++;
+    }
+    
+    if (size == 0) {
+        fclose(file);
+        return false;
+    }
+    
+    float* x1 = new float[size];
+    float* y1 = new float[size];
+    float* x2 = new float[size];
+    float* y2 = new float[size];
+    unsigned short n = 0;
+    
+    fseek(file, 0, SEEK_SET);
+    
+    while ((n < size) && (fgets(line, sizeof(line), file) != NULL)) {
+        if ((line[0] != '#') && (sscanf(line, "%f %f %f %f", &x1[n], &y1[n], &x2[n], &y2[n]) == 4)) n++;
+    }
+    
+    fclose(file);
+    
+    bool success = set(x1, y1, x2, y2, n);
+    
+    delete[] x1;
+    delete[] y1;
+    delete[] x2;
+    delete[] y2;
+    
+    return success;
+}
+
+/**
+ * Sets the segments of the reference map, and precomputes the lookup grid with the
+ * nearest segment of every cell.
+ * @param x1 an array with the x coordinates of the start points of the segments, given in [m].
+ * @param y1 an array with the y coordinates of the start points of the segments, given in [m].
+ * @param x2 an array with the x coordinates of the end points of the segments, given in [m].
+ * @param y2 an array with the y coordinates of the end points of the segments, given in [m].
+ * @param size the number of segments.
+ * @return <code>true</code> if the map was set, <code>false</code> if the map would be empty.
+ */
+bool ScanMatcher::set(const float x1[], const float y1[], const float x2[], const float y2[], unsigned short size) {
+    
+    if (size > MAXIMUM_SEGMENTS) size = MAXIMUM_SEGMENTS;
+    
+    // count the segments with a length, and get the bounding box of these segments
+    
+    unsigned short n = 0;
+    
+    float minimumX = 0.0f;
+    float maximumX = 0.0f;
+    float minimumY = 0.0f;
+    float maximumY = 0.0f;
+    
+    for (unsigned short i = 0; i < size; i++) {
+        
+        if ((fabs(x2[i]-x1[i]) < 1.0e-3f) && (fabs(y2[i]-y1[i]) < 1.0e-3f)) continue;
+        
+        if ((n == 0) || (fmin(x1[i], x2[i]) < minimumX)) minimumX = fmin(x1[i], x2[i]);
+        if ((n == 0) || (fmax(x1[i], x2[i]) > maximumX)) maximumX = fmax(x1[i], x2[i]);
+        if ((n == 0) || (fmin(y1[i], y2[i]) < minimumY)) minimumY = fmin(y1[i], y2[i]);
+        if ((n == 0) || (fmax(y1[i], y2[i]) > maximumY)) maximumY = fmax(y1[i], y2[i]);
+        
+        n++;
+    }
+    
+    if (n == 0) return false;
+    
+    clear();
+    
+    this->size = n;
+    xs = new float[n];
+    ys = new float[n];
+    directionXs = new float[n];
+    directionYs = new float[n];
+    lengths = new float[n];
+    
+    n = 0;
+    
+    for (unsigned short i = 0; i < size; i++) {
+        
+        if ((fabs(x2[i]-x1[i]) < 1.0e-3f) && (fabs(y2[i]-y1[i]) < 1.0e-3f)) continue;
+        
+        float length = sqrt((x2[i]-x1[i])*(x2[i]-x1[i])+(y2[i]-y1[i])*(y2[i]-y1[i]));
+        
+        xs[n] = x1[i];
+        ys[n] = y1[i];
+        directionXs[n] = (x2[i]-x1[i])/length;
+        directionYs[n] = (y2[i]-y1[i])/length;
+        lengths[n] = length;
+        
+        n++;
+    }
+    
+    // choose the size of the lookup grid, with coarser cells for large maps
+    
+    gridX = minimumX-MARGIN;
+    gridY = minimumY-MARGIN;
+    
+    float width = maximumX-minimumX+2.0f*MARGIN;
+    float height = maximumY-minimumY+2.0f*MARGIN;
+    
+    gridResolution = RESOLUTION;
+    if (width > GRID_SIZE*gridResolution) gridResolution = width/GRID_SIZE;
+    if (height > GRID_SIZE*gridResolution) gridResolution = height/GRID_SIZE;
+    
+    gridColumns = static_cast<unsigned short>(ceil(width/gridResolution));
+    gridRows = static_cast<unsigned short>(ceil(height/gridResolution));
+    
+    if (gridColumns > GRID_SIZE) gridColumns = GRID_SIZE;
+    if (gridRows > GRID_SIZE) gridRows = GRID_SIZE;
+    
+    grid = new int16_t[gridColumns*gridRows];
+    
+    // store the nearest segment of the center of every cell, if a point in the cell can be near this segment
+    
+    float range = MAXIMUM_DISTANCE+0.71f*gridResolution;
+    
+    for (unsigned short row = 0; row < gridRows; row++) {
+        for (unsigned short column = 0; column < gridColumns; column++) {
+            
+            float x = gridX+(column+0.5f)*gridResolution;
+            float y = gridY+(row+0.5f)*gridResolution;
+            
+            int16_t nearest = -1;
+            float minimum = range;
+            
+            for (unsigned short i = 0; i < this->size; i++) {
+                float value = distance(i, x, y);
+                if (value < minimum) {
+                    minimum = value;
+                    nearest = i;
+                }
+            }
+            
+            grid[row*gridColumns+column] = nearest;
+        }
+    }
+    
+    return true;
+}
+
+/**
+ * Gets the number of segments of the reference map.
+ */
+unsigned short ScanMatcher::getSize() {
+    
+    return size;
+}
+
+/**
+ * Aligns a scan with the reference map, starting at a given pose of the robot.
+ * <br/>
+ * At most <code>MAXIMUM_POINTS</code> points of the scan are used, and at most
+ * <code>MAXIMUM_ITERATIONS</code> iterations are calculated, so that the duration
+ * of a match is bounded. A match is rejected, when there are too few correspondences,
+ * or when the aligned pose is too far from the given pose.
+ * @param scan a reference to the scan, with points given in the coordinates of the robot.
+ * @param x a reference to the x coordinate of the pose of the robot at the time of the scan,
+ * which is set to the x coordinate of the aligned pose, given in [m].
+ * @param y a reference to the y coordinate of the pose of the robot, given in [m].
+ * @param alpha a reference to the orientation of the pose of the robot, given in [rad].
+ * @param covariance a reference to a matrix that is set to the covariance matrix of the aligned pose.
+ * @return <code>true</code> if the scan was aligned, <code>false</code> otherwise, with the pose unchanged.
+ */
+bool ScanMatcher::match(Scan& scan, float& x, float& y, float& alpha, Matrix<3, 3>& covariance) {
+    
+    uint32_t start = us_ticker_read();
+    
+    iterations = 0;
+    correspondences = 0;
+    
+    if (size == 0) {
+        duration = us_ticker_read()-start;
+        return false;
+    }
+    
+    // take every n-th valid point of the scan, to use at most the maximum number of points
+    
+    unsigned short step = (scan.size+MAXIMUM_POINTS-1)/MAXIMUM_POINTS;
+    if (step < 1) step = 1;
+    
+    unsigned short points = 0;
+    
+    for (unsigned short i = 0; (i < scan.size) && (points < MAXIMUM_POINTS); i += step) {
+        if ((scan.r[i] >= MINIMUM_RANGE) && (scan.r[i] < MAXIMUM_RANGE)) {
+            pointXs[points] = scan.x[i];
+            pointYs[points] = scan.y[i];
+            points++;
+        }
+    }
+    
+    // minimize the distances of the points to their segments with damped Gauss-Newton steps
+    
+    float matchedX = x;
+    float matchedY = y;
+    float matchedAlpha = alpha;
+    
+    Matrix<3, 3> h;
+    bool success = false;
+    
+    while (iterations < MAXIMUM_ITERATIONS) {
+        
+        float cosAlpha = cos(matchedAlpha);
+        float sinAlpha = sin(matchedAlpha);
+        
+        float b[3] = {0.0f, 0.0f, 0.0f};
+        h = Matrix<3, 3>();
+        correspondences = 0;
+        
+        for (unsigned short i = 0; i < points; i++) {
+            
+            float pointX = matchedX+cosAlpha*pointXs[i]-sinAlpha*pointYs[i];
+            float pointY = matchedY+sinAlpha*pointXs[i]+cosAlpha*pointYs[i];
+            
+            // look up the segment of this point, and calculate the signed distance to the line of this segment
+            
+            int column = static_cast<int>(floor((pointX-gridX)/gridResolution));
+            int row = static_cast<int>(floor((pointY-gridY)/gridResolution));
+            
+            if ((column < 0) || (column >= gridColumns) || (row < 0) || (row >= gridRows)) continue;
+            
+            int16_t segment = grid[row*gridColumns+column];
+            if (segment < 0) continue;
+            
+            float dx = pointX-xs[segment];
+            float dy = pointY-ys[segment];
+            float t = dx*directionXs[segment]+dy*directionYs[segment];
+            
+            if ((t < 0.0f) || (t > lengths[segment])) continue;
+            
+            float normalX = -directionYs[segment];
+            float normalY = directionXs[segment];
+            float value = dx*normalX+dy*normalY;
+            
+            if (fabs(value) > MAXIMUM_DISTANCE) continue;
+            
+            // accumulate the normal equations with the jacobian of the distance
+            
+            float j[3] = {normalX, normalY, normalY*(pointX-matchedX)-normalX*(pointY-matchedY)};
+            
+            for (unsigned short r = 0; r < 3; r++) {
+                for (unsigned short c = r; c < 3; c++) h(r, c) += j[r]*j[c];
+                b[r] += j[r]*value;
+            }
+            
+            correspondences++;
+        }
+        
+        if (correspondences < MINIMUM_CORRESPONDENCES) break;
+        
+        for (unsigned short r = 0; r < 3; r++) {
+            h(r, r) += DAMPING;
+            for (unsigned short c = 0; c < r; c++) h(r, c) = h(c, r);
+        }
+        
+        Matrix<3, 3> inverse;
+        if (!h.inverse(inverse)) break;
+        
+        float deltaX = -(inverse(0, 0)*b[0]+inverse(0, 1)*b[1]+inverse(0, 2)*b[2]);
+        float deltaY = -(inverse(1, 0)*b[0]+inverse(1, 1)*b[1]+inverse(1, 2)*b[2]);
+        float deltaAlpha = -(inverse(2, 0)*b[0]+inverse(2, 1)*b[1]+inverse(2, 2)*b[2]);
+        
+        matchedX += deltaX;
+        matchedY += deltaY;
+        matchedAlpha += deltaAlpha;
+        
+        iterations++;
+        success = true;
+        
+        if ((sqrt(deltaX*deltaX+deltaY*deltaY) < CONVERGED_TRANSLATION) && (fabs(deltaAlpha) < CONVERGED_ROTATION)) break;
+    }
+    
+    // reject matches that moved too far from the given pose
+    
+    float deltaAlpha = matchedAlpha-alpha;
+    
+    success &= (correspondences >= MINIMUM_CORRESPONDENCES);
+    success &= (sqrt((matchedX-x)*(matchedX-x)+(matchedY-y)*(matchedY-y)) < MAXIMUM_TRANSLATION);
+    success &= (fabs(deltaAlpha) < MAXIMUM_ROTATION);
+    
+    if (success) success = h.inverse(covariance);
+    
+    if (success) {
+        
+        covariance = covariance*(SIGMA_DISTANCE*SIGMA_DISTANCE);
+        
+        x = matchedX;
+        y = matchedY;
+        alpha += deltaAlpha;
+    }
+    
+    duration = us_ticker_read()-start;
+    
+    return success;
+}
+
+/**
+ * Gets the number of iterations of the last match.
+ */
+unsigned short ScanMatcher::getIterations() {
+    
+    return iterations;
+}
+
+/**
+ * Gets the number of points of the last match, that corresponded with a segment of the map.
+ */
+unsigned short ScanMatcher::getCorrespondences() {
+    
+    return correspondences;
+}
+
+/**
+ * Gets the duration of the last match.
+ * @return the duration, given in [us].
+ */
+uint32_t ScanMatcher::getDuration() {
+    
+    return duration;
+}
+
+/**
+ * Calculates the distance of a position to a segment.
+ */
+float ScanMatcher::distance(unsigned short segment, float x, float y) {
+    
+    float dx = x-xs[segment];
+    float dy = y-ys[segment];
+    float t = dx*directionXs[segment]+dy*directionYs[segment];
+    
+    if (t < 0.0f) t = 0.0f;
+    if (t > lengths[segment]) t = lengths[segment];
+    
+    dx -= t*directionXs[segment];
+    dy -= t*directionYs[segment];
+    
+    return sqrt(dx*dx+dy*dy);
+}
+
+/**
+ * Deletes the segments and the lookup grid of this map.
+ */
+void ScanMatcher::clear() {
+    
+    delete[] xs;
+    delete[] ys;
+    delete[] directionXs;
+    delete[] directionYs;
+    delete[] lengths;
+    delete[] grid;
+    
+    size = 0;
+    xs = NULL;
+    ys = NULL;
+    directionXs = NULL;
+    directionYs = NULL;
+    lengths = NULL;
+    grid = NULL;
+    gridColumns = 0;
+    gridRows = 0;
+}
@@ -0,0 +1,89 @@
+/*
+ * ScanMatcher.h
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#ifndef SCAN_MATCHER_H_
+#define SCAN_MATCHER_H_
+
+#include <cstdlib>
+#include <stdint.h>
+#include "Matrix.h"
+#include "Scan.h"
+
+/**
+ * This class aligns the scans of a LIDAR with a reference map of line segments, like
+ * the walls of an arena, with a point-to-line iterative closest point (ICP) algorithm.
+ * The aligned pose is a measurement of the full pose of the robot, which can correct
+ * the pose also where no beacons are visible.
+ * <br/>
+ * The nearest segment of every cell of a uniform grid around the map is precomputed,
+ * so that the correspondence of a point is found with a single lookup. Every iteration
+ * minimizes the squared distances of the points to the lines of their segments with a
+ * damped Gauss-Newton step. The number of points and the number of iterations are limited,
+ * which bounds the runtime of a match.
+ * <br/>
+ * A map file contains one segment per line, given as x and y coordinates of the start
+ * and the end point in [m], separated by white space. Empty lines and lines starting
+ * with '#' are ignored.
+ */
+class ScanMatcher {
+    
+    public:
+        
+                        ScanMatcher();
+        virtual         ~ScanMatcher();
+        bool            load(const char* filename);
+        bool            set(const float x1[], const float y1[], const float x2[], const float y2[], unsigned short size);
+        unsigned short  getSize();
+        bool            match(Scan& scan, float& x, float& y, float& alpha, Matrix<3, 3>& covariance);
+        unsigned short  getIterations();
+        unsigned short  getCorrespondences();
+        uint32_t        getDuration();
+        
+    private:
+        
+        static const unsigned short MAXIMUM_SEGMENTS = 1024;    // maximum number of segments of the map
+        static const unsigned short GRID_SIZE = 128;            // maximum number of cells of the lookup grid in each direction
+        static const unsigned short MAXIMUM_POINTS = 180;       // maximum number of points of a scan used for a match
+        static const unsigned short MAXIMUM_ITERATIONS = 10;    // maximum number of iterations of a match
+        static const unsigned short MINIMUM_CORRESPONDENCES = 20;   // minimum number of correspondences of a valid match
+        static const float          RESOLUTION;             // minimum width of a cell of the lookup grid, given in [m]
+        static const float          MARGIN;                 // margin of the lookup grid around the segments, given in [m]
+        static const float          MINIMUM_RANGE;          // minimum distance of a point, given in [m]
+        static const float          MAXIMUM_RANGE;          // maximum distance of a point, given in [m]
+        static const float          MAXIMUM_DISTANCE;       // maximum distance of a point to its segment, given in [m]
+        static const float          DAMPING;                // damping of the Gauss-Newton steps
+        static const float          CONVERGED_TRANSLATION;  // translation of an iteration at which a match converged, given in [m]
+        static const float          CONVERGED_ROTATION;     // rotation of an iteration at which a match converged, given in [rad]
+        static const float          MAXIMUM_TRANSLATION;    // maximum translation of a valid match, given in [m]
+        static const float          MAXIMUM_ROTATION;       // maximum rotation of a valid match, given in [rad]
+        static const float          SIGMA_DISTANCE;         // standard deviation of the distance of a point to its segment, given in [m]
+        
+        unsigned short  size;           // number of segments
+        float*          xs;             // x coordinates of the start points of the segments, given in [m]
+        float*          ys;             // y coordinates of the start points of the segments, given in [m]
+        float*          directionXs;    // x components of the unit directions of the segments
+        float*          directionYs;    // y components of the unit directions of the segments
+        float*          lengths;        // lengths of the segments, given in [m]
+        
+        int16_t*        grid;           // index of the nearest segment of every cell, or -1 if no segment is near
+        float           gridX;          // x coordinate of the origin of the lookup grid, given in [m]
+        float           gridY;          // y coordinate of the origin of the lookup grid, given in [m]
+        float           gridResolution; // width of a cell of the lookup grid, given in [m]
+        unsigned short  gridColumns;    // number of columns of the lookup grid
+        unsigned short  gridRows;       // number of rows of the lookup grid
+        
+        float           pointXs[MAXIMUM_POINTS];    // x coordinates of the points of a match, given in robot coordinates in [m]
+        float           pointYs[MAXIMUM_POINTS];    // y coordinates of the points of a match, given in robot coordinates in [m]
+        
+        unsigned short  iterations;         // number of iterations of the last match
+        unsigned short  correspondences;    // number of correspondences of the last match
+        uint32_t        duration;           // duration of the last match, given in [us]
+        
+        float           distance(unsigned short segment, float x, float y);
+        void            clear();
+};
+
+#endif /* SCAN_MATCHER_H_ */
@@ -32,15 +32,6 @@ SensorFusion::SensorFusion(IMU& imu) : imu(imu), thread(osPriorityHigh, STACK_SI
     tiltAngleK = 0.0f;
     tiltAngleC = 0.0f;
     
-    // initialize parameters for kalman filter
-    
-    p11 = 0.0f;
-    p12 = 0.0f;
-    p21 = 0.0f;
-    p22 = 0.0f;
-    xAlpha = 0.0f;
-    xOmega = 0.0f;
-    
     // initialize parameters for complementary filter
     
     alphaAccFiltered = 0.0f;
@@ -130,42 +121,31 @@ void SensorFusion::run() {
         
         // calculate prediction for sensor fusion with Kalman-filter
         
-        float zAlpha = atan2(accelerationY, accelerationZ);
-        float zOmega = gyroX;
-        
-        xAlpha = xAlpha+PERIOD*xOmega;
+        Matrix<2, 2> f = Matrix<2, 2>::identity();
+        f(0, 1) = PERIOD;
         
-        float p11 = this->p11+this->p12*PERIOD+this->p21*PERIOD+this->p22*PERIOD*PERIOD+S_Q_ALPHA*S_Q_ALPHA;
-        float p12 = this->p12+this->p22*PERIOD;
-        float p21 = this->p21+this->p22*PERIOD;
-        float p22 = this->p22+S_Q_OMEGA*S_Q_OMEGA;
+        Matrix<2, 2> q;
+        q(0, 0) = S_Q_ALPHA*S_Q_ALPHA;
+        q(1, 1) = S_Q_OMEGA*S_Q_OMEGA;
         
-        this->p11 = p11;
-        this->p12 = p12;
-        this->p21 = p21;
-        this->p22 = p22;
+        filter.x = f*filter.x;
+        filter.predict(f, q);
         
-        // calculate correction for sensor fusion with Kalman-filter
-                
-        float k11 = p11/(p11+S_R_ALPHA*S_R_ALPHA);
-        float k22 = p22/(p22+S_R_OMEGA*S_R_OMEGA);
+        // calculate correction for sensor fusion with Kalman-filter, both states are measured directly
         
-        xAlpha = xAlpha+k11*(zAlpha-xAlpha);
-        xOmega = xOmega+k22*(zOmega-xOmega);
+        Matrix<2, 1> innovation;
+        innovation(0, 0) = atan2(accelerationY, accelerationZ)-filter.x(0, 0);
+        innovation(1, 0) = gyroX-filter.x(1, 0);
         
-        p11 = this->p11*(1.0-this->p11/(this->p11+S_R_ALPHA*S_R_ALPHA));
-        p12 = 0.0;
-        p21 = 0.0;
-        p22 = this->p22*(1.0-this->p22/(this->p22+S_R_ALPHA*S_R_ALPHA));
+        Matrix<2, 2> r;
+        r(0, 0) = S_R_ALPHA*S_R_ALPHA;
+        r(1, 1) = S_R_OMEGA*S_R_OMEGA;
         
-        this->p11 = p11;
-        this->p12 = p12;
-        this->p21 = p21;
-        this->p22 = p22;
+        filter.update(innovation, Matrix<2, 2>::identity(), r);
         
         // set tilt angle from Kalman filter
         
-        tiltAngleK = xAlpha;
+        tiltAngleK = filter.x(0, 0);
         
         // set tilt angle from complementary filter
         
@@ -11,6 +11,7 @@
 #include <mbed.h>
 #include "IMU.h"
 #include "ThreadFlag.h"
+#include "ExtendedKalmanFilter.h"
 
 /**
  * This class determines the IMU's tilt angle around the x-axis with sensor fusion algorithms.
@@ -50,12 +51,7 @@ class SensorFusion {
         float   tiltAngleK;
         float   tiltAngleC;
         
-        float   p11;
-        float   p12;
-        float   p21;
-        float   p22;
-        float   xAlpha;
-        float   xOmega;
+        ExtendedKalmanFilter<2, 2>  filter;
         
         float   alphaAccFiltered;
         float   alphaGyro;
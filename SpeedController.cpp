@@ -0,0 +1,244 @@
+/*
+ * SpeedController.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include <cmath>
+#include "SpeedController.h"
+
+using namespace std;
+
+/**
+ * Creates a SpeedController object with default values.
+ */
+SpeedController::SpeedController() {
+    
+    period = 0.001f;
+    kp = 0.15f;
+    ki = 0.0f;
+    kn = 40.0f;
+    timeConstant = 0.0f;
+    minimumVoltage = -12.0f;
+    maximumVoltage = 12.0f;
+    integral = 0.0f;
+    
+    identifying = false;
+    identificationVoltage = 0.0f;
+    identificationPeriods = 0;
+    identificationPeriod = 0;
+    speedIntegral = 0.0f;
+    finalSpeedSum = 0.0f;
+    
+    resetStatistics();
+}
+
+/**
+ * Deletes this object.
+ */
+SpeedController::~SpeedController() {}
+
+/**
+ * Sets the period of the task that calls the <code>control()</code> method.
+ * @param period the period, given in [s].
+ */
+void SpeedController::setPeriod(float period) {
+    
+    this->period = period;
+}
+
+/**
+ * Sets the gains of the PI controller.
+ * @param kp the proportional gain, given in [V/rpm].
+ * @param ki the integral gain, given in [V/rpm/s].
+ */
+void SpeedController::setGains(float kp, float ki) {
+    
+    this->kp = kp;
+    this->ki = ki;
+}
+
+/**
+ * Sets the first order model of the motor, that is used for the feedforward.
+ * @param kn the speed constant, given in [rpm/V].
+ * @param timeConstant the mechanical time constant, given in [s].
+ */
+void SpeedController::setModel(float kn, float timeConstant) {
+    
+    this->kn = kn;
+    this->timeConstant = timeConstant;
+}
+
+/**
+ * Sets the limits of the voltage, for example given by the limits of the duty-cycle.
+ * @param minimumVoltage the lower limit, given in [V].
+ * @param maximumVoltage the upper limit, given in [V].
+ */
+void SpeedController::setLimits(float minimumVoltage, float maximumVoltage) {
+    
+    this->minimumVoltage = minimumVoltage;
+    this->maximumVoltage = maximumVoltage;
+}
+
+/**
+ * Resets the integrator of the PI controller.
+ */
+void SpeedController::reset() {
+    
+    integral = 0.0f;
+}
+
+/**
+ * Calculates the voltage of the motor. While a step response is measured,
+ * the voltage of the step is returned, independent of the desired speed.
+ * @param desiredSpeed the desired speed, given in [rpm].
+ * @param desiredAcceleration the desired acceleration, given in [rpm/s].
+ * @param actualSpeed the actual speed, given in [rpm].
+ * @return the voltage within the limits, given in [V].
+ */
+float SpeedController::control(float desiredSpeed, float desiredAcceleration, float actualSpeed) {
+    
+    if (identifying) return identify(actualSpeed);
+    
+    float error = desiredSpeed-actualSpeed;
+    
+    // update the statistics of the speed error
+    
+    errorCount++;
+    errorSum += error;
+    errorSquareSum += error*error;
+    if (fabs(error) > errorMaximum) errorMaximum = fabs(error);
+    
+    // calculate and limit the voltage with feedforward and PI controller
+    
+    float voltage = (desiredSpeed+timeConstant*desiredAcceleration)/kn+kp*error+integral;
+    float limitedVoltage = voltage;
+    
+    if (limitedVoltage < minimumVoltage) limitedVoltage = minimumVoltage;
+    else if (limitedVoltage > maximumVoltage) limitedVoltage = maximumVoltage;
+    
+    // integrate the error, and feed the saturation back with the integral time as tracking time
+    
+    integral += period*ki*error;
+    if (kp > 0.0f) integral += period*ki/kp*(limitedVoltage-voltage);
+    
+    return limitedVoltage;
+}
+
+/**
+ * Starts the identification of the model of the motor with a step response.
+ * The motor should stand still, when the identification is started.
+ * @param voltage the voltage of the step, given in [V].
+ * @param duration the duration of the step, which should be several time constants, given in [s].
+ */
+void SpeedController::startIdentification(float voltage, float duration) {
+    
+    identificationVoltage = voltage;
+    identificationPeriods = static_cast<unsigned int>(duration/period);
+    identificationPeriod = 0;
+    speedIntegral = 0.0f;
+    finalSpeedSum = 0.0f;
+    
+    identifying = (identificationPeriods >= 4) && (voltage != 0.0f);
+}
+
+/**
+ * Tells if the step response of the identification is measured.
+ */
+bool SpeedController::isIdentifying() {
+    
+    return identifying;
+}
+
+/**
+ * Gets the speed constant of the model of the motor.
+ * @return the speed constant, given in [rpm/V].
+ */
+float SpeedController::getKN() {
+    
+    return kn;
+}
+
+/**
+ * Gets the mechanical time constant of the model of the motor.
+ * @return the time constant, given in [s].
+ */
+float SpeedController::getTimeConstant() {
+    
+    return timeConstant;
+}
+
+/**
+ * Resets the statistics of the speed error.
+ */
+void SpeedController::resetStatistics() {
+    
+    errorCount = 0;
+    errorSum = 0.0f;
+    errorSquareSum = 0.0f;
+    errorMaximum = 0.0f;
+}
+
+/**
+ * Gets the mean of the speed error since the statistics were reset.
+ * @return the mean error, given in [rpm].
+ */
+float SpeedController::getErrorMean() {
+    
+    unsigned int count = errorCount;
+    
+    return (count > 0) ? errorSum/count : 0.0f;
+}
+
+/**
+ * Gets the root mean square of the speed error since the statistics were reset.
+ * @return the rms error, given in [rpm].
+ */
+float SpeedController::getErrorRMS() {
+    
+    unsigned int count = errorCount;
+    
+    return (count > 0) ? sqrt(errorSquareSum/count) : 0.0f;
+}
+
+/**
+ * Gets the maximum absolute speed error since the statistics were reset.
+ * @return the maximum error, given in [rpm].
+ */
+float SpeedController::getErrorMaximum() {
+    
+    return errorMaximum;
+}
+
+/**
+ * Measures one period of the step response, and fits the model of the motor at the end of the step.
+ * @param actualSpeed the actual speed, given in [rpm].
+ * @return the voltage of the step, or zero at the end of the step, given in [V].
+ */
+float SpeedController::identify(float actualSpeed) {
+    
+    speedIntegral += actualSpeed*period;
+    if (4*identificationPeriod >= 3*identificationPeriods) finalSpeedSum += actualSpeed;
+    
+    identificationPeriod++;
+    
+    if (identificationPeriod < identificationPeriods) return identificationVoltage;
+    
+    // the final speed is the mean speed of the last quarter of the step
+    
+    float finalSpeed = finalSpeedSum/(identificationPeriods-(3*identificationPeriods+3)/4);
+    float duration = identificationPeriods*period;
+    
+    if (finalSpeed*identificationVoltage > 0.0f) {
+        
+        float timeConstant = duration-speedIntegral/finalSpeed;
+        
+        kn = finalSpeed/identificationVoltage;
+        if (timeConstant > 0.0f) this->timeConstant = timeConstant;
+    }
+    
+    integral = 0.0f;
+    identifying = false;
+    
+    return 0.0f;
+}
@@ -0,0 +1,75 @@
+/*
+ * SpeedController.h
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#ifndef SPEED_CONTROLLER_H_
+#define SPEED_CONTROLLER_H_
+
+#include <cstdlib>
+
+/**
+ * This class implements a speed controller for a DC motor, to be called in a periodic task.
+ * <br/>
+ * The voltage is the sum of a feedforward of the desired speed and acceleration with a
+ * first order model of the motor, and a PI controller of the speed error. The integrator
+ * uses back-calculation against the voltage limits, so that it does not wind up while the
+ * voltage is saturated.
+ * <br/>
+ * The speed constant and the time constant of the model can be identified with a step
+ * response: a constant voltage is applied for a given duration, and the speed constant is
+ * the final speed over the voltage, while the time constant is the area between the final
+ * speed and the response, divided by the final speed.
+ * <br/>
+ * The controller keeps statistics of the speed error, which are read without locking,
+ * and may therefore be slightly inconsistent while they are updated.
+ */
+class SpeedController {
+    
+    public:
+        
+                SpeedController();
+        virtual ~SpeedController();
+        void    setPeriod(float period);
+        void    setGains(float kp, float ki);
+        void    setModel(float kn, float timeConstant);
+        void    setLimits(float minimumVoltage, float maximumVoltage);
+        void    reset();
+        float   control(float desiredSpeed, float desiredAcceleration, float actualSpeed);
+        void    startIdentification(float voltage, float duration);
+        bool    isIdentifying();
+        float   getKN();
+        float   getTimeConstant();
+        void    resetStatistics();
+        float   getErrorMean();
+        float   getErrorRMS();
+        float   getErrorMaximum();
+        
+    private:
+        
+        float           period;             // period of the task, given in [s]
+        float           kp;                 // proportional gain, given in [V/rpm]
+        float           ki;                 // integral gain, given in [V/rpm/s]
+        float           kn;                 // speed constant of the motor, given in [rpm/V]
+        float           timeConstant;       // mechanical time constant of the motor, given in [s]
+        float           minimumVoltage;     // lower limit of the voltage, given in [V]
+        float           maximumVoltage;     // upper limit of the voltage, given in [V]
+        float           integral;           // state of the integrator, given in [V]
+        
+        volatile bool   identifying;        // flag that a step response is measured
+        float           identificationVoltage;      // voltage of the step, given in [V]
+        unsigned int    identificationPeriods;      // number of periods of the step response
+        unsigned int    identificationPeriod;       // actual period of the step response
+        float           speedIntegral;      // integral of the speed over the step response, given in [rpm*s]
+        float           finalSpeedSum;      // sum of the speeds in the last quarter of the step response, given in [rpm]
+        
+        unsigned int    errorCount;         // number of speed errors of the statistics
+        float           errorSum;           // sum of the speed errors, given in [rpm]
+        float           errorSquareSum;     // sum of the squared speed errors, given in [rpm2]
+        float           errorMaximum;       // maximum absolute speed error, given in [rpm]
+        
+        float           identify(float actualSpeed);
+};
+
+#endif /* SPEED_CONTROLLER_H_ */
@@ -8,6 +8,8 @@
 #include "TaskWait.h"
 #include "TaskMove.h"
 #include "TaskMoveTo.h"
+#include "TaskFollowPath.h"
+#include "TaskFollowTrajectory.h"
 #include "StateMachine.h"
 
 using namespace std;
@@ -17,6 +19,11 @@ const float StateMachine::DISTANCE_THRESHOLD = 0.2f;        // minimum allowed d
 const float StateMachine::TRANSLATIONAL_VELOCITY = 0.3f;    // translational velocity in [m/s]
 const float StateMachine::ROTATIONAL_VELOCITY = 1.0f;       // rotational velocity in [rad/s]
 const float StateMachine::VELOCITY_THRESHOLD = 0.01;        // velocity threshold before switching off, in [m/s] and [rad/s]
+const float StateMachine::ROUTE_X[] = {0.0f, 2.0f, 2.5f, 2.0f, 0.0f, -0.5f, 0.0f, 2.0f, 2.5f, 2.0f, 0.0f, -0.5f, 0.0f, 2.0f, 2.5f, 2.0f, 0.0f, -0.5f, 0.0f};
+const float StateMachine::ROUTE_Y[] = {0.0f, 0.0f, 0.5f, 1.0f, 1.0f, 0.5f, 0.0f, 0.0f, 0.5f, 1.0f, 1.0f, 0.5f, 0.0f, 0.0f, 0.5f, 1.0f, 1.0f, 0.5f, 0.0f};
+const float StateMachine::ROUTE_VELOCITY = 0.2f;            // maximum translational velocity on the route, given in [m/s]
+const float StateMachine::ROUTE_ACCELERATION = 0.2f;        // maximum translational acceleration on the route, given in [m/s2]
+const float StateMachine::ROUTE_LATERAL_ACCELERATION = 0.3f;    // maximum lateral acceleration on the route, given in [m/s2]
 
 /**
  * Creates and initializes a state machine object.
@@ -29,6 +36,15 @@ StateMachine::StateMachine(Controller& controller, DigitalOut& enableMotorDriver
     buttonBefore = buttonNow;
     taskList.clear();
     
+    // compile the route into a path with a velocity profile, or into a trajectory
+    
+    if (MBED_CONF_APP_FOLLOW_PATH) {
+        path.compile(ROUTE_X, ROUTE_Y, ROUTE_SIZE, true);
+        path.limitVelocity(ROUTE_VELOCITY, ROUTE_ACCELERATION, ROUTE_LATERAL_ACCELERATION);
+    } else {
+        trajectory.compile(ROUTE_X, ROUTE_Y, ROUTE_SIZE, ROUTE_VELOCITY, ROUTE_ACCELERATION, ROUTE_LATERAL_ACCELERATION);
+    }
+    
     // start thread and timer interrupt
     
     thread.start(callback(this, &StateMachine::run));
@@ -94,16 +110,8 @@ void StateMachine::run() {
                     enableMotorDriver = 1;
                     
                     taskList.push_back(new TaskWait(controller, 0.5f));
-
-                    for (int i = 0; i < 3; i++) {
-                        
-                        taskList.push_back(new TaskMoveTo(controller, 2.0f, 0.0f, 0.0f, 0.2f, 0.1f));
-                        taskList.push_back(new TaskMoveTo(controller, 2.5f, 0.5f, 1.57f, 0.2f, 0.1f));
-                        taskList.push_back(new TaskMoveTo(controller, 2.0f, 1.0f, 3.14f, 0.2f, 0.1f));
-                        taskList.push_back(new TaskMoveTo(controller, 0.0f, 1.0f, 3.14f, 0.2f, 0.1f));
-                        taskList.push_back(new TaskMoveTo(controller, -0.5f, 0.5f, -1.57f, 0.2f, 0.1f));
-                        taskList.push_back(new TaskMoveTo(controller, 0.0f, 0.0f, 0.0f, 0.2f, 0.1f));
-                    }
+                    if (MBED_CONF_APP_FOLLOW_PATH) taskList.push_back(new TaskFollowPath(controller, path, ROUTE_LATERAL_ACCELERATION, TaskFollowPath::DEFAULT_ZONE));
+                    else taskList.push_back(new TaskFollowTrajectory(controller, trajectory));
                     
                     state = MOVE_FORWARD;
                 }
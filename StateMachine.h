@@ -13,6 +13,8 @@
 #include "Controller.h"
 #include "IRSensor.h"
 #include "Task.h"
+#include "Path.h"
+#include "Trajectory.h"
 #include "ThreadFlag.h"
 
 /**
@@ -20,6 +22,11 @@
  * It allows to move the robot forward, and to turn left or right,
  * depending on distance measurements, to avoid collisions with
  * obstacles.
+ * <br/>
+ * The route of the robot is compiled into a trajectory at startup,
+ * so that the robot drives through its waypoints without stopping.
+ * When it is enabled in the configuration, the route is compiled into
+ * a path instead, which the robot follows with pure pursuit.
  */
 class StateMachine {
     
@@ -44,6 +51,12 @@ class StateMachine {
         static const float  TRANSLATIONAL_VELOCITY;     // translational velocity in [m/s]
         static const float  ROTATIONAL_VELOCITY;        // rotational velocity in [rad/s]
         static const float  VELOCITY_THRESHOLD;         // velocity threshold before switching off, in [m/s] and [rad/s]
+        static const unsigned short ROUTE_SIZE = 19;    // number of waypoints of the route
+        static const float  ROUTE_X[ROUTE_SIZE];        // x coordinates of the waypoints of the route, given in [m]
+        static const float  ROUTE_Y[ROUTE_SIZE];        // y coordinates of the waypoints of the route, given in [m]
+        static const float  ROUTE_VELOCITY;             // maximum translational velocity on the route, given in [m/s]
+        static const float  ROUTE_ACCELERATION;         // maximum translational acceleration on the route, given in [m/s2]
+        static const float  ROUTE_LATERAL_ACCELERATION; // maximum lateral acceleration on the route, given in [m/s2]
         
         Controller&     controller;
         DigitalOut&     enableMotorDriver;
@@ -64,6 +77,8 @@ class StateMachine {
         int             buttonNow;
         int             buttonBefore;
         deque<Task*>    taskList;
+        Path            path;
+        Trajectory      trajectory;
         ThreadFlag      threadFlag;
         Thread          thread;
         Ticker          ticker;
@@ -0,0 +1,119 @@
+/*
+ * TaskFollowPath.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include <cmath>
+#include "TaskFollowPath.h"
+
+using namespace std;
+
+const float TaskFollowPath::DEFAULT_LATERAL_ACCELERATION = 0.5f;    // default lateral acceleration, given in [m/s2]
+const float TaskFollowPath::DEFAULT_ZONE = 0.02f;                   // default zone value, given in [m]
+const float TaskFollowPath::MINIMUM_LOOKAHEAD = 0.15f;              // look-ahead distance at zero velocity, given in [m]
+const float TaskFollowPath::LOOKAHEAD_TIME = 0.5f;                  // increase of the look-ahead distance with the velocity, given in [s]
+const float TaskFollowPath::MINIMUM_VELOCITY = 0.05f;               // velocity to reach the end of the path, given in [m/s]
+
+/**
+ * Creates a task object that moves the robot along a path.
+ * @param controller a reference to the controller object of the robot.
+ * @param path a reference to the path to follow, with a velocity profile.
+ */
+TaskFollowPath::TaskFollowPath(Controller& controller, Path& path) : controller(controller), path(path) {
+    
+    lateralAcceleration = DEFAULT_LATERAL_ACCELERATION;
+    zone = DEFAULT_ZONE;
+    velocity = 0.0f;
+    closestIndex = 0;
+    lookaheadIndex = 0;
+}
+
+/**
+ * Creates a task object that moves the robot along a path.
+ * @param controller a reference to the controller object of the robot.
+ * @param path a reference to the path to follow, with a velocity profile.
+ * @param lateralAcceleration the maximum lateral acceleration on the arc to the look-ahead point, given in [m/s2].
+ * @param zone the zone threshold around the end of the path, given in [m].
+ */
+TaskFollowPath::TaskFollowPath(Controller& controller, Path& path, float lateralAcceleration, float zone) : controller(controller), path(path) {
+    
+    this->lateralAcceleration = lateralAcceleration;
+    this->zone = zone;
+    velocity = 0.0f;
+    closestIndex = 0;
+    lookaheadIndex = 0;
+}
+
+/**
+ * Deletes the task object.
+ */
+TaskFollowPath::~TaskFollowPath() {}
+
+/**
+ * This method is called periodically by a task sequencer.
+ * @param period the period of the task sequencer, given in [s].
+ * @return the status of this task, i.e. RUNNING or DONE.
+ */
+int TaskFollowPath::run(float period) {
+    
+    unsigned int size = path.getSize();
+    
+    PoseSnapshot pose = controller.getPoseSnapshot();
+    
+    if (size == 0) {
+        
+        controller.setTranslationalVelocity(0.0f);
+        controller.setRotationalVelocity(0.0f);
+        
+        return DONE;
+    }
+    
+    // search the closest point and the look-ahead point, resuming from the previous period
+    
+    closestIndex = path.findClosestPoint(pose.x, pose.y, closestIndex);
+    
+    // stop within the zone around the end of the path, or when the projection of the robot onto the path
+    // passed its end, so that a robot beside the end of the path does not circle around it
+    
+    if (closestIndex == size-1) {
+        
+        float endX = pose.x-path.getX(size-1);
+        float endY = pose.y-path.getY(size-1);
+        float alpha = path.getAlpha(size-1);
+        
+        if ((endX*endX+endY*endY < zone*zone) || (cos(alpha)*endX+sin(alpha)*endY >= 0.0f)) {
+            
+            controller.setTranslationalVelocity(0.0f);
+            controller.setRotationalVelocity(0.0f);
+            
+            return DONE;
+        }
+    }
+    
+    if (lookaheadIndex < closestIndex) lookaheadIndex = closestIndex;
+    lookaheadIndex = path.findPoint(path.getDistance(closestIndex)+MINIMUM_LOOKAHEAD+LOOKAHEAD_TIME*velocity, lookaheadIndex);
+    
+    // calculate the curvature of the arc through the look-ahead point, in the coordinates of the robot
+    
+    float deltaX = path.getX(lookaheadIndex)-pose.x;
+    float deltaY = path.getY(lookaheadIndex)-pose.y;
+    
+    float lookaheadX = pose.cosAlpha*deltaX+pose.sinAlpha*deltaY;
+    float lookaheadY = -pose.sinAlpha*deltaX+pose.cosAlpha*deltaY;
+    float squaredDistance = lookaheadX*lookaheadX+lookaheadY*lookaheadY;
+    
+    float curvature = (squaredDistance > 0.0f) ? 2.0f*lookaheadY/squaredDistance : 0.0f;
+    
+    // limit the velocity with the velocity profile of the path, and with the curvature of the arc
+    
+    velocity = path.getVelocity(closestIndex);
+    
+    if (fabs(curvature)*velocity*velocity > lateralAcceleration) velocity = sqrt(lateralAcceleration/fabs(curvature));
+    if (velocity < MINIMUM_VELOCITY) velocity = MINIMUM_VELOCITY;
+    
+    controller.setTranslationalVelocity(velocity);
+    controller.setRotationalVelocity(velocity*curvature);
+    
+    return RUNNING;
+}
@@ -0,0 +1,52 @@
+/*
+ * TaskFollowPath.h
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#ifndef TASK_FOLLOW_PATH_H_
+#define TASK_FOLLOW_PATH_H_
+
+#include <cstdlib>
+#include "Controller.h"
+#include "Path.h"
+#include "Task.h"
+
+/**
+ * This is a specific implementation of a task class that moves the robot along a path with pure pursuit.
+ * <br/>
+ * The task searches the point of the path that is closest to the robot, and a look-ahead point further
+ * along the path, with a look-ahead distance that grows with the velocity. Both searches resume from the
+ * points of the previous period. The robot drives on the circular arc through the look-ahead point, with
+ * the velocity of the velocity profile of the path at the closest point, which is further reduced when the
+ * curvature of the arc exceeds the lateral acceleration limit. The task is done when the robot is within
+ * a zone around the end of the path, or when its projection onto the path passed the end.
+ */
+class TaskFollowPath : public Task {
+    
+    public:
+        
+        static const float  DEFAULT_LATERAL_ACCELERATION;   /**< Default lateral acceleration, given in [m/s2]. */
+        static const float  DEFAULT_ZONE;                   /**< Default zone value, given in [m]. */
+        
+                    TaskFollowPath(Controller& controller, Path& path);
+                    TaskFollowPath(Controller& controller, Path& path, float lateralAcceleration, float zone);
+        virtual     ~TaskFollowPath();
+        virtual int run(float period);
+        
+    private:
+        
+        static const float  MINIMUM_LOOKAHEAD;  // look-ahead distance at zero velocity, given in [m]
+        static const float  LOOKAHEAD_TIME;     // increase of the look-ahead distance with the velocity, given in [s]
+        static const float  MINIMUM_VELOCITY;   // velocity to reach the end of the path, given in [m/s]
+        
+        Controller&     controller;             // reference to the controller object to use
+        Path&           path;                   // reference to the path to follow
+        float           lateralAcceleration;    // maximum lateral acceleration, given in [m/s2]
+        float           zone;                   // zone threshold around the end of the path, given in [m]
+        float           velocity;               // translational velocity of the previous period, given in [m/s]
+        unsigned int    closestIndex;           // index of the point of the path that is closest to the robot
+        unsigned int    lookaheadIndex;         // index of the look-ahead point of the path
+};
+
+#endif /* TASK_FOLLOW_PATH_H_ */
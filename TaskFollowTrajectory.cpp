@@ -0,0 +1,77 @@
+/*
+ * TaskFollowTrajectory.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include <cmath>
+#include "TaskFollowTrajectory.h"
+
+using namespace std;
+
+const float TaskFollowTrajectory::K1 = 2.0f;                // gain of the longitudinal error, given in [1/s]
+const float TaskFollowTrajectory::K2 = 16.0f;               // gain of the lateral error, given in [1/m2]
+const float TaskFollowTrajectory::K3 = 3.0f;                // gain of the orientation error, given in [1/s]
+const float TaskFollowTrajectory::ZONE = 0.01f;             // zone of the longitudinal error at the end of the trajectory, given in [m]
+const float TaskFollowTrajectory::ANGLE_ZONE = 0.02f;       // zone of the sine of the orientation error at the end of the trajectory
+const float TaskFollowTrajectory::SETTLING_TIME = 2.0f;     // maximum time to settle on the end of the trajectory, given in [s]
+
+/**
+ * Creates a task object that moves the robot along a trajectory.
+ * @param controller a reference to the controller object of the robot.
+ * @param trajectory a reference to the compiled trajectory to follow.
+ */
+TaskFollowTrajectory::TaskFollowTrajectory(Controller& controller, Trajectory& trajectory) : controller(controller), trajectory(trajectory) {
+    
+    time = 0.0f;
+}
+
+/**
+ * Deletes the task object.
+ */
+TaskFollowTrajectory::~TaskFollowTrajectory() {}
+
+/**
+ * This method is called periodically by a task sequencer.
+ * @param period the period of the task sequencer, given in [s].
+ * @return the status of this task, i.e. RUNNING or DONE.
+ */
+int TaskFollowTrajectory::run(float period) {
+    
+    PoseSnapshot pose = controller.getPoseSnapshot();
+    
+    float cosAlpha = pose.cosAlpha;
+    float sinAlpha = pose.sinAlpha;
+    
+    // get the reference of the trajectory, which is the final pose with zero velocities after its duration
+    
+    float x, y, cosReference, sinReference, velocity, rotationalVelocity;
+    
+    trajectory.get(time, x, y, cosReference, sinReference, velocity, rotationalVelocity);
+    
+    // calculate the errors of the pose in the coordinates of the robot
+    
+    float errorX = cosAlpha*(x-pose.x)+sinAlpha*(y-pose.y);
+    float errorY = -sinAlpha*(x-pose.x)+cosAlpha*(y-pose.y);
+    float cosError = cosReference*cosAlpha+sinReference*sinAlpha;
+    float sinError = sinReference*cosAlpha-cosReference*sinAlpha;
+    
+    // stop when the robot settled on the final pose
+    
+    float duration = trajectory.getDuration();
+    
+    if ((time > duration) && (((fabs(errorX) < ZONE) && (fabs(sinError) < ANGLE_ZONE) && (cosError > 0.0f)) || (time > duration+SETTLING_TIME))) {
+        
+        controller.setTranslationalVelocity(0.0f);
+        controller.setRotationalVelocity(0.0f);
+        
+        return DONE;
+    }
+    
+    controller.setTranslationalVelocity(velocity*cosError+K1*errorX);
+    controller.setRotationalVelocity(rotationalVelocity+K2*velocity*errorY+K3*sinError);
+    
+    time += period;
+    
+    return RUNNING;
+}
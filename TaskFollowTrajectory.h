@@ -0,0 +1,48 @@
+/*
+ * TaskFollowTrajectory.h
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#ifndef TASK_FOLLOW_TRAJECTORY_H_
+#define TASK_FOLLOW_TRAJECTORY_H_
+
+#include <cstdlib>
+#include "Controller.h"
+#include "Trajectory.h"
+#include "Task.h"
+
+/**
+ * This is a specific implementation of a task class that moves the robot along a precompiled trajectory.
+ * <br/>
+ * The task reads the reference pose and velocities of the trajectory at its actual time, and adds a
+ * feedback of the pose error, expressed in the coordinates of the robot, to the reference velocities.
+ * The time of the trajectory only advances while this task is running. After the duration of the
+ * trajectory, the feedback continues on the final pose, until the longitudinal error and the error
+ * of the orientation are within a zone, or a settling time elapsed. The lateral error cannot be
+ * corrected by a standing robot, so it is not part of this zone. This task uses the cosine and
+ * sine of the orientation of the pose snapshot, and needs no trigonometric functions.
+ */
+class TaskFollowTrajectory : public Task {
+    
+    public:
+        
+                    TaskFollowTrajectory(Controller& controller, Trajectory& trajectory);
+        virtual     ~TaskFollowTrajectory();
+        virtual int run(float period);
+        
+    private:
+        
+        static const float  K1;
+        static const float  K2;
+        static const float  K3;
+        static const float  ZONE;
+        static const float  ANGLE_ZONE;
+        static const float  SETTLING_TIME;
+        
+        Controller& controller;     // reference to the controller object to use
+        Trajectory& trajectory;     // reference to the trajectory to follow
+        float       time;           // actual time of the trajectory, given in [s]
+};
+
+#endif /* TASK_FOLLOW_TRAJECTORY_H_ */
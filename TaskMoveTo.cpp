@@ -79,9 +79,11 @@ TaskMoveTo::~TaskMoveTo() {}
  */
 int TaskMoveTo::run(float period) {
     
-    float x = controller.getX();
-    float y = controller.getY();
-    float alpha = controller.getAlpha();
+    PoseSnapshot pose = controller.getPoseSnapshot();
+    
+    float x = pose.x;
+    float y = pose.y;
+    float alpha = pose.alpha;
     
     float rho = sqrt((this->x-x)*(this->x-x)+(this->y-y)*(this->y-y));
     
@@ -0,0 +1,170 @@
+/*
+ * Trajectory.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include <cmath>
+#include <algorithm>
+#include "Path.h"
+#include "Trajectory.h"
+
+using namespace std;
+
+const float Trajectory::SAMPLE_TIME = 0.1f;             // time between two samples of the lookup table, given in [s]
+const float Trajectory::POSITION_SCALE = 0.001f;        // resolution of the position, given in [m]
+const float Trajectory::DIRECTION_SCALE = 1.0f/16384.0f;    // resolution of the cosine and sine of the orientation
+const float Trajectory::VELOCITY_SCALE = 0.001f;        // resolution of the translational velocity, given in [m/s]
+const float Trajectory::ROTATION_SCALE = 0.001f;        // resolution of the rotational velocity, given in [rad/s]
+
+/**
+ * Creates an empty trajectory.
+ */
+Trajectory::Trajectory() {
+    
+    duration = 0.0f;
+}
+
+/**
+ * Deletes this object.
+ */
+Trajectory::~Trajectory() {}
+
+/**
+ * Compiles a list of waypoints into a trajectory, that starts and ends with zero velocity.
+ * @param x an array with the x coordinates of the waypoints, given in [m].
+ * @param y an array with the y coordinates of the waypoints, given in [m].
+ * @param size the number of waypoints, at least 2.
+ * @param velocity the maximum translational velocity, given in [m/s].
+ * @param acceleration the maximum translational acceleration and deceleration, given in [m/s2].
+ * @param lateralAcceleration the maximum lateral acceleration in curves, given in [m/s2].
+ * @return <code>true</code> if the trajectory was compiled, <code>false</code> otherwise.
+ */
+bool Trajectory::compile(const float x[], const float y[], unsigned short size, float velocity, float acceleration, float lateralAcceleration) {
+    
+    samples.clear();
+    duration = 0.0f;
+    
+    if ((velocity <= 0.0f) || (acceleration <= 0.0f) || (lateralAcceleration <= 0.0f)) return false;
+    
+    // compile the waypoints into a spline path with a velocity profile
+    
+    Path path;
+    
+    if (!path.compile(x, y, size, true)) return false;
+    
+    path.limitVelocity(velocity, acceleration, lateralAcceleration);
+    
+    unsigned int n = path.getSize();
+    
+    // calculate the time of every point of the path
+    
+    vector<float> t(n, 0.0f);
+    
+    for (unsigned int k = 1; k < n; k++) {
+        t[k] = t[k-1]+2.0f*(path.getDistance(k)-path.getDistance(k-1))/max(path.getVelocity(k-1)+path.getVelocity(k), 1.0e-6f);
+    }
+    
+    duration = t[n-1];
+    
+    // resample the trajectory with the fixed sample time
+    
+    unsigned int count = static_cast<unsigned int>(ceil(duration/SAMPLE_TIME))+1;
+    
+    samples.resize(count);
+    
+    unsigned int k = 0;
+    
+    for (unsigned int i = 0; i < count; i++) {
+        
+        float time = min(i*SAMPLE_TIME, duration);
+        
+        while ((k < n-2) && (t[k+1] < time)) k++;
+        
+        float r = (t[k+1] > t[k]) ? (time-t[k])/(t[k+1]-t[k]) : 0.0f;
+        
+        float sampleX = path.getX(k)+r*(path.getX(k+1)-path.getX(k));
+        float sampleY = path.getY(k)+r*(path.getY(k+1)-path.getY(k));
+        float sampleAlpha = path.getAlpha(k)+r*(path.getAlpha(k+1)-path.getAlpha(k));
+        float sampleVelocity = path.getVelocity(k)+r*(path.getVelocity(k+1)-path.getVelocity(k));
+        float sampleKappa = path.getCurvature(k)+r*(path.getCurvature(k+1)-path.getCurvature(k));
+        
+        Sample& sample = samples[i];
+        
+        sample.x = static_cast<int16_t>(lroundf(sampleX/POSITION_SCALE));
+        sample.y = static_cast<int16_t>(lroundf(sampleY/POSITION_SCALE));
+        sample.cosAlpha = static_cast<int16_t>(lroundf(cos(sampleAlpha)/DIRECTION_SCALE));
+        sample.sinAlpha = static_cast<int16_t>(lroundf(sin(sampleAlpha)/DIRECTION_SCALE));
+        sample.velocity = static_cast<int16_t>(lroundf(sampleVelocity/VELOCITY_SCALE));
+        sample.rotationalVelocity = static_cast<int16_t>(lroundf(sampleVelocity*sampleKappa/ROTATION_SCALE));
+    }
+    
+    // the last sample is the end of the trajectory, which is read at the time of this sample
+    
+    duration = (count-1)*SAMPLE_TIME;
+    
+    return true;
+}
+
+/**
+ * Gets the number of samples of the lookup table of this trajectory.
+ */
+unsigned int Trajectory::getSize() {
+    
+    return samples.size();
+}
+
+/**
+ * Gets the duration of this trajectory, which is rounded up to the time of its last sample.
+ * @return the duration, given in [s].
+ */
+float Trajectory::getDuration() {
+    
+    return duration;
+}
+
+/**
+ * Gets the reference pose and velocities of this trajectory at a given time,
+ * interpolated between two samples of the lookup table.
+ * @param time the time since the start of the trajectory, given in [s].
+ * @param x a reference to the x coordinate of the position, given in [m].
+ * @param y a reference to the y coordinate of the position, given in [m].
+ * @param cosAlpha a reference to the cosine of the orientation.
+ * @param sinAlpha a reference to the sine of the orientation.
+ * @param velocity a reference to the translational velocity, given in [m/s].
+ * @param rotationalVelocity a reference to the rotational velocity, given in [rad/s].
+ */
+void Trajectory::get(float time, float& x, float& y, float& cosAlpha, float& sinAlpha, float& velocity, float& rotationalVelocity) {
+    
+    if (samples.empty()) {
+        
+        x = 0.0f;
+        y = 0.0f;
+        cosAlpha = 1.0f;
+        sinAlpha = 0.0f;
+        velocity = 0.0f;
+        rotationalVelocity = 0.0f;
+        
+        return;
+    }
+    
+    float index = (time > 0.0f) ? time/SAMPLE_TIME : 0.0f;
+    unsigned int i = static_cast<unsigned int>(index);
+    
+    if (i >= samples.size()-1) {
+        i = samples.size()-1;
+        index = static_cast<float>(i);
+    }
+    
+    const Sample& sample0 = samples[i];
+    const Sample& sample1 = samples[(i < samples.size()-1) ? i+1 : i];
+    
+    float r = index-i;
+    
+    x = (sample0.x+r*(sample1.x-sample0.x))*POSITION_SCALE;
+    y = (sample0.y+r*(sample1.y-sample0.y))*POSITION_SCALE;
+    cosAlpha = (sample0.cosAlpha+r*(sample1.cosAlpha-sample0.cosAlpha))*DIRECTION_SCALE;
+    sinAlpha = (sample0.sinAlpha+r*(sample1.sinAlpha-sample0.sinAlpha))*DIRECTION_SCALE;
+    velocity = (sample0.velocity+r*(sample1.velocity-sample0.velocity))*VELOCITY_SCALE;
+    rotationalVelocity = (sample0.rotationalVelocity+r*(sample1.rotationalVelocity-sample0.rotationalVelocity))*ROTATION_SCALE;
+}
@@ -0,0 +1,61 @@
+/*
+ * Trajectory.h
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#ifndef TRAJECTORY_H_
+#define TRAJECTORY_H_
+
+#include <cstdlib>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * This class compiles a list of waypoints into a continuous, time parameterized
+ * trajectory, that is stored as a compact lookup table.
+ * <br/>
+ * The waypoints are compiled into a spline path with a velocity profile, see the
+ * <code>Path</code> class, which is then parameterized with time. The velocity is zero
+ * only at the first and the last waypoint, so that the robot drives through the other
+ * waypoints without stopping.
+ * <br/>
+ * The trajectory is stored with a fixed sample time, with the position, the orientation as
+ * cosine and sine, and the translational and rotational velocity of each sample as 16-bit
+ * fixed point values. The compilation uses trigonometric functions and square roots, and is
+ * meant to run at startup. Reading the trajectory at a given time only interpolates between
+ * two samples.
+ */
+class Trajectory {
+    
+    public:
+        
+                        Trajectory();
+        virtual         ~Trajectory();
+        bool            compile(const float x[], const float y[], unsigned short size, float velocity, float acceleration, float lateralAcceleration);
+        unsigned int    getSize();
+        float           getDuration();
+        void            get(float time, float& x, float& y, float& cosAlpha, float& sinAlpha, float& velocity, float& rotationalVelocity);
+        
+    private:
+        
+        static const float          SAMPLE_TIME;        // time between two samples of the lookup table, given in [s]
+        static const float          POSITION_SCALE;     // resolution of the position, given in [m]
+        static const float          DIRECTION_SCALE;    // resolution of the cosine and sine of the orientation
+        static const float          VELOCITY_SCALE;     // resolution of the translational velocity, given in [m/s]
+        static const float          ROTATION_SCALE;     // resolution of the rotational velocity, given in [rad/s]
+        
+        struct Sample {
+            int16_t     x;                      // x coordinate, given in [mm]
+            int16_t     y;                      // y coordinate, given in [mm]
+            int16_t     cosAlpha;               // cosine of the orientation, scaled with 2^14
+            int16_t     sinAlpha;               // sine of the orientation, scaled with 2^14
+            int16_t     velocity;               // translational velocity, given in [mm/s]
+            int16_t     rotationalVelocity;     // rotational velocity, given in [mrad/s]
+        };
+        
+        std::vector<Sample>     samples;        // lookup table of the trajectory
+        float                   duration;       // duration of the trajectory, given in [s]
+};
+
+#endif /* TRAJECTORY_H_ */
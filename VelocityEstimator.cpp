@@ -0,0 +1,128 @@
+/*
+ * VelocityEstimator.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include <cmath>
+#include "VelocityEstimator.h"
+
+using namespace std;
+
+const float VelocityEstimator::FAST_COUNTS = 8.0f;  // counts per period, above which the count difference of one period is used
+const float VelocityEstimator::SLOW_COUNTS = 6.0f;  // counts per period, below which the window is used again
+
+/**
+ * Creates a VelocityEstimator object with a default period of 1 ms and a default timeout of 0.1 s.
+ */
+VelocityEstimator::VelocityEstimator() {
+    
+    period = 0.001f;
+    timeout = 0.1f;
+    
+    reset(0);
+}
+
+/**
+ * Deletes this object.
+ */
+VelocityEstimator::~VelocityEstimator() {}
+
+/**
+ * Resets the estimator to a standing encoder.
+ * @param count the actual count of the encoder.
+ */
+void VelocityEstimator::reset(int64_t count) {
+    
+    periods = 0;
+    
+    edgeCounts[0] = count;
+    edgePeriods[0] = 0;
+    latest = 0;
+    size = 1;
+    
+    fast = false;
+    velocity = 0.0f;
+}
+
+/**
+ * Sets the period of the task that calls the <code>update()</code> method.
+ * @param period the period, given in [s].
+ */
+void VelocityEstimator::setPeriod(float period) {
+    
+    this->period = period;
+}
+
+/**
+ * Sets the time without edges, after which the encoder is assumed to stand still.
+ * @param timeout the timeout, given in [s].
+ */
+void VelocityEstimator::setTimeout(float timeout) {
+    
+    this->timeout = timeout;
+}
+
+/**
+ * Updates the estimated velocity with the count of the encoder, using the end of this
+ * period as the time of an edge.
+ * @param count the actual count of the encoder.
+ * @return the estimated velocity, given in [counts/s].
+ */
+float VelocityEstimator::update(int64_t count) {
+    
+    periods++;
+    
+    if (count != edgeCounts[latest]) {
+        
+        // choose the window with hysteresis, so that the choice does not depend on the quantization of single periods
+        
+        float counts = fabs(velocity)*period;
+        
+        if (counts > FAST_COUNTS) fast = true;
+        else if (counts < SLOW_COUNTS) fast = false;
+        
+        uint32_t window = fast ? 1 : WINDOW;
+        
+        // search the latest edge that is at least the window older, or the oldest edge
+        
+        uint16_t i = latest;
+        
+        for (uint16_t n = 1; (n < size) && (periods-edgePeriods[i] < window); n++) i = (i+EDGES-1)%EDGES;
+        
+        // divide the counts since this edge by the time between the edges
+        
+        velocity = static_cast<float>(count-edgeCounts[i])/(static_cast<float>(periods-edgePeriods[i])*period);
+        
+        latest = (latest+1)%EDGES;
+        edgeCounts[latest] = count;
+        edgePeriods[latest] = periods;
+        if (size < EDGES) size++;
+        
+    } else {
+        
+        float elapsed = static_cast<float>(periods-edgePeriods[latest])*period;
+        
+        if (elapsed > timeout) {
+            
+            velocity = 0.0f;
+            
+        } else if (fabs(velocity)*elapsed > 1.0f) {
+            
+            // the next edge is late, the velocity is at most one count over the time since the latest edge
+            
+            velocity = (velocity > 0.0f) ? 1.0f/elapsed : -1.0f/elapsed;
+        }
+    }
+    
+    return velocity;
+}
+
+/**
+ * Gets the estimated velocity.
+ * @return the velocity, given in [counts/s].
+ */
+float VelocityEstimator::getVelocity() {
+    
+    return velocity;
+}
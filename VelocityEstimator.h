@@ -0,0 +1,60 @@
+/*
+ * VelocityEstimator.h
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#ifndef VELOCITY_ESTIMATOR_H_
+#define VELOCITY_ESTIMATOR_H_
+
+#include <cstdlib>
+#include <stdint.h>
+
+/**
+ * This class estimates the velocity of an encoder from its absolute count with a
+ * combined M/T method, within a periodic task.
+ * <br/>
+ * The velocity is the number of counts between the latest edge and an earlier edge,
+ * divided by the time between these edges. At low speed, the earlier edge is the latest
+ * edge that is at least a window of periods older, so that the velocity is measured over
+ * the time between counts (T method), which resolves much lower velocities than the
+ * quantized count difference of a period. At high speed, when the count changes by several
+ * counts in every period, the earlier edge is the edge of the previous period, which gives
+ * the count difference of one period (M method) without the delay of the window. While no
+ * edge is seen, the velocity is bounded by one count over the time since the latest edge,
+ * so that it decays to zero when the encoder stops.
+ * <br/>
+ * The times of the edges are the ends of the periods in which the count changed, because
+ * the timers of the encoders latch counts and not times with their capture channels.
+ */
+class VelocityEstimator {
+    
+    public:
+        
+                VelocityEstimator();
+        virtual ~VelocityEstimator();
+        void    reset(int64_t count);
+        void    setPeriod(float period);
+        void    setTimeout(float timeout);
+        float   update(int64_t count);
+        float   getVelocity();
+        
+    private:
+        
+        static const unsigned short WINDOW = 8;     // minimum number of periods between the edges of a measurement at low speed
+        static const unsigned short EDGES = WINDOW; // capacity of the ring buffer of edges
+        static const float          FAST_COUNTS;    // counts per period, above which the count difference of one period is used
+        static const float          SLOW_COUNTS;    // counts per period, below which the window is used again
+        
+        float       period;             // period of the task, given in [s]
+        float       timeout;            // time without edges, after which the velocity is zero, given in [s]
+        uint32_t    periods;            // number of periods since the reset
+        int64_t     edgeCounts[EDGES];  // ring buffer with the counts at the latest edges
+        uint32_t    edgePeriods[EDGES]; // ring buffer with the periods of the latest edges
+        uint16_t    latest;             // index of the latest edge in the ring buffers
+        uint16_t    size;               // number of edges in the ring buffers
+        bool        fast;               // flag that the count difference of one period is used
+        float       velocity;           // estimated velocity, given in [counts/s]
+};
+
+#endif /* VELOCITY_ESTIMATOR_H_ */
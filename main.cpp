@@ -9,11 +9,19 @@
 #include "IRSensor.h"
 #include "EncoderCounter.h"
 #include "IMU.h"
+#include "DMASerial.h"
 #include "LIDAR.h"
+#include "LandmarkMap.h"
+#include "JointCompatibility.h"
+#include "ScanMatcher.h"
+#include "ParticleFilter.h"
+#include "OccupancyGrid.h"
 #include "Controller.h"
 #include "StateMachine.h"
 #include "HTTPServer.h"
+#include "HTTPScriptController.h"
 #include "HTTPScriptLIDAR.h"
+#include "HTTPScriptOccupancyGrid.h"
 
 int main() {
     
@@ -74,12 +82,14 @@ int main() {
     
     ThisThread::sleep_for(500ms);
     
-    UnbufferedSerial* serial = new UnbufferedSerial(PG_14, PG_9);
-    LIDAR* lidar = new LIDAR(*serial);
+    DMASerial* serial = new DMASerial(PG_14, PG_9, 115200);
+    LIDAR* lidar = new LIDAR(*serial, LIDAR::EXPRESS);
     
     // create robot controller objects
     
-    Controller controller(pwmLeft, pwmRight, counterLeft, counterRight);
+    PoseHistory* poseHistory = new PoseHistory();
+    Controller controller(pwmLeft, pwmRight, counterLeft, counterRight, imu, *poseHistory);
+    controller.setGyroFusion(true);
     StateMachine stateMachine(controller, enableMotorDriver, led0, led1, led2, led3, led4, led5, button, irSensor0, irSensor1, irSensor2, irSensor3, irSensor4, irSensor5);
     
     // create ethernet interface and webserver
@@ -92,48 +102,153 @@ int main() {
     ethernet->connect();
     
     HTTPServer* httpServer = new HTTPServer(*ethernet);
-    httpServer->add("lidar", new HTTPScriptLIDAR(*lidar));
+    httpServer->add("controller", new HTTPScriptController(controller));
+    
+    // load the map of landmarks from the SD card, or use the pipes of the test arena
+    
+    LandmarkMap* landmarkMap = new LandmarkMap();
+    
+    if (!landmarkMap->load("/fs/landmarks.txt")) {
+        
+        float x[] = {0.0f, 2.0f, 4.0f, 6.0f};
+        float y[] = {0.5f, 0.5f, 0.5f, 0.5f};
+        
+        landmarkMap->set(x, y, 4);
+    }
+    
+    JointCompatibility* jointCompatibility = new JointCompatibility(*landmarkMap);
+    
+    // load the map of walls from the SD card, to align the scans with, when no beacons are visible
+    
+    ScanMatcher* scanMatcher = new ScanMatcher();
+    scanMatcher->load("/fs/segments.txt");
+    
+    httpServer->add("lidar", new HTTPScriptLIDAR(*lidar, *scanMatcher));
+    
+    // create a particle filter for a global localization, which is used at start up when it is enabled
+    // in the configuration, and again when no beacons could be associated for a number of scans
+    
+    ParticleFilter* particleFilter = new ParticleFilter(*landmarkMap);
+    
+    const unsigned short LOST_SCANS = 20;
+    
+    bool localized = !MBED_CONF_APP_GLOBAL_LOCALIZATION;
+    unsigned short lostScans = 0;
+    
+    // create an occupancy grid of the surroundings, which is built from the scans while the robot is localized
+    
+    OccupancyGrid* occupancyGrid = new OccupancyGrid(-3.0f, -3.0f);
+    
+    httpServer->add("occupancy", new HTTPScriptOccupancyGrid(*occupancyGrid));
+    
+    Scan* scan = new Scan();
+    Beacon beacons[16];
+    
+    unsigned int previousRevolution = 0;
 
     while (true) {
         
         led = !led;
         
         ThisThread::sleep_for(100ms);
+        
+        // skip the processing, when the LIDAR has not completed a new revolution
+        
+        unsigned int revolution = lidar->getRevolution();
+        if ((revolution > 0) && (revolution == previousRevolution)) continue;
+        previousRevolution = revolution;
 
-        deque<Point> beacons = lidar->getBeacons();
-
-
-        Point rohr1;
-        rohr1.x = 0.0f;
-        rohr1.y = 0.5f;
-        Point rohr2;
-        rohr2.x = 2.0f;
-        rohr2.y = 0.5f;
-        Point rohr3;
-        rohr3.x = 4.0f;
-        rohr3.y = 0.5f;
-        Point rohr4;
-        rohr4.x = 6.0f;
-        rohr4.y = 0.5f;
-
-        for (int i; i < beacons.size(); i++) {
-          float x = controller.getX();
-          float y = controller.getY();
-          float alpha = controller.getAlpha();
-          Point measuredBeacon;
-
-          measuredBeacon.x = cos(alpha) * beacons[i].x - sin(alpha) * beacons[i].y + x;
-          measuredBeacon.y = sin(alpha) * beacons[i].x + cos(alpha) * beacons[i].y + y;
-
-          if (rohr1.distance(measuredBeacon) < 0.4f) {
-            controller.correctPoseWithBeacon(rohr1, measuredBeacon);
-          } else if (rohr2.distance(measuredBeacon) < 0.4f) {
-            controller.correctPoseWithBeacon(rohr2, measuredBeacon);
-          } else if (rohr3.distance(measuredBeacon) < 0.4f) {
-            controller.correctPoseWithBeacon(rohr3, measuredBeacon);
-          } else if (rohr4.distance(measuredBeacon) < 0.4f) {
-            controller.correctPoseWithBeacon(rohr4, measuredBeacon);
-          }
+        lidar->getScan(*scan, *poseHistory);
+        unsigned short size = lidar->getBeacons(*scan, beacons, 16);
+        
+        // get the pose of the robot at the end of this scan, the reference pose of the de-skewed points
+        
+        PoseSnapshot pose = controller.getPoseSnapshot();
+        
+        float x = pose.x;
+        float y = pose.y;
+        float alpha = pose.alpha;
+        
+        poseHistory->get(scan->timestamp, x, y, alpha);
+        
+        if (!localized) {
+            
+            // localize the robot globally, and hand the estimate over to the controller when the particles converged
+            
+            particleFilter->update(x, y, alpha, beacons, size);
+            
+            if (particleFilter->isConverged()) {
+                
+                // move the estimate with the odometry since the scan, given in the robot coordinates of the scan
+                
+                float deltaX = cos(alpha)*(pose.x-x)+sin(alpha)*(pose.y-y);
+                float deltaY = -sin(alpha)*(pose.x-x)+cos(alpha)*(pose.y-y);
+                
+                float estimatedAlpha = particleFilter->getAlpha();
+                
+                float estimatedX = particleFilter->getX()+cos(estimatedAlpha)*deltaX-sin(estimatedAlpha)*deltaY;
+                float estimatedY = particleFilter->getY()+sin(estimatedAlpha)*deltaX+cos(estimatedAlpha)*deltaY;
+                
+                controller.setPose(estimatedX, estimatedY, estimatedAlpha+pose.alpha-alpha, particleFilter->getCovariance());
+                
+                localized = true;
+                lostScans = 0;
+            }
+            
+            continue;
+        }
+        
+        // associate the beacons with the landmarks of the map, with a set of pairings that are jointly compatible
+        
+        Point actualBeacons[JointCompatibility::MAXIMUM_BEACONS];
+        Point measuredBeacons[JointCompatibility::MAXIMUM_BEACONS];
+        
+        unsigned short associations = jointCompatibility->associate(x, y, alpha, pose.p, beacons, size, actualBeacons, measuredBeacons);
+        
+        // correct the pose with all associated beacons of this scan at once, or align the scan with the map of walls
+        
+        bool corrected = false;
+        
+        if (associations > 0) {
+            
+            controller.correctPoseWithBeacons(actualBeacons, measuredBeacons, associations);
+            
+            corrected = true;
+            
+        } else {
+            
+            float matchedX = x;
+            float matchedY = y;
+            float matchedAlpha = alpha;
+            Matrix<3, 3> r;
+            
+            if (scanMatcher->match(*scan, matchedX, matchedY, matchedAlpha, r)) {
+                
+                // move the matched pose with the odometry since the scan, given in the robot coordinates of the scan
+                
+                float deltaX = cos(alpha)*(pose.x-x)+sin(alpha)*(pose.y-y);
+                float deltaY = -sin(alpha)*(pose.x-x)+cos(alpha)*(pose.y-y);
+                
+                float correctedX = matchedX+cos(matchedAlpha)*deltaX-sin(matchedAlpha)*deltaY;
+                float correctedY = matchedY+sin(matchedAlpha)*deltaX+cos(matchedAlpha)*deltaY;
+                
+                controller.correctPose(correctedX, correctedY, matchedAlpha+pose.alpha-alpha, r);
+                
+                corrected = true;
+            }
         }
+        
+        // start a new global localization, when beacons are visible but the pose could not be corrected for a while
+        
+        if ((size > 0) && !corrected) lostScans++; else if (corrected) lostScans = 0;
+        
+        if (lostScans > LOST_SCANS) {
+            particleFilter->reset();
+            localized = false;
+        }
+        
+        // add this scan to the occupancy grid, with the pose of the robot at the time of the scan
+        
+        occupancyGrid->update(*scan, x, y, alpha);
     }
 }
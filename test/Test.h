@@ -0,0 +1,51 @@
+/*
+ * Test.h
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#ifndef TEST_H_
+#define TEST_H_
+
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <chrono>
+
+/**
+ * This header contains the few helpers that the host tests share.
+ * A failed check prints its location and the failed condition, and counts the failure,
+ * so that a test runs to the end. The main function of a test returns <code>TEST_RESULT</code>,
+ * which is nonzero if any check failed.
+ */
+
+static unsigned int testFailures = 0;   // number of failed checks of this test
+
+#define CHECK(condition) do { \
+    if (!(condition)) { \
+        printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+        testFailures++; \
+    } \
+} while (0)
+
+#define CHECK_NEAR(actual, expected, tolerance) do { \
+    double actualValue = (actual); \
+    double expectedValue = (expected); \
+    if (!(fabs(actualValue-expectedValue) <= (tolerance))) { \
+        printf("%s:%d: check failed: %s = %g, expected %g +- %g\n", __FILE__, __LINE__, #actual, actualValue, expectedValue, (double)(tolerance)); \
+        testFailures++; \
+    } \
+} while (0)
+
+#define TEST_RESULT ((testFailures > 0) ? EXIT_FAILURE : EXIT_SUCCESS)
+
+/**
+ * Gets the time of a monotonic clock of the host, to measure the duration of benchmarks.
+ * @return the time, given in [s].
+ */
+inline double testTime() {
+    
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#endif /* TEST_H_ */
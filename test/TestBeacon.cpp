@@ -0,0 +1,114 @@
+/*
+ * TestBeacon.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include <cmath>
+#include "Test.h"
+#include "TestStream.h"
+#include "LIDAR.h"
+#include "Beacon.h"
+
+using namespace std;
+
+static const float  PI = 3.1415926535897932f;
+static const float  RADIUS = 0.055f;    // radius of the pipes, given in [m]
+
+/**
+ * Samples the visible arc of a pipe with the angular resolution of the LIDAR.
+ * @param distance the distance of the center of the pipe, given in [m].
+ * @param angle the direction of the center of the pipe, given in [rad].
+ * @param noise the maximum error of a measured distance, given in [m].
+ * @return the number of points.
+ */
+static unsigned short sample(float distance, float angle, float noise, float x[], float y[]) {
+    
+    unsigned short size = 0;
+    
+    for (int degree = 0; degree < 360; degree++) {
+        
+        float theta = (float)degree*PI/180.0f;
+        float delta = remainder(theta-angle, 2.0f*PI);
+        float discriminant = RADIUS*RADIUS-distance*distance*sin(delta)*sin(delta);
+        
+        if ((cos(delta) > 0.0f) && (discriminant > 0.0f)) {
+            float r = distance*cos(delta)-sqrt(discriminant)+noise*(2.0f*(float)rand()/(float)RAND_MAX-1.0f);
+            x[size] = r*cos(theta);
+            y[size] = r*sin(theta);
+            size++;
+        }
+    }
+    
+    return size;
+}
+
+/**
+ * Tests the circle fit on synthetic arcs of pipes, and on the pipes of the simulated scans.
+ */
+int main() {
+    
+    float x[64];
+    float y[64];
+    
+    srand(1);
+    
+    // fit exact and noisy arcs at different distances and directions
+    
+    for (float distance = 0.5f; distance < 3.0f; distance += 0.25f) {
+        for (float angle = -3.0f; angle < 3.0f; angle += 0.7f) {
+            
+            unsigned short size = sample(distance, angle, 0.0f, x, y);
+            CHECK(size >= 2);
+            
+            Beacon beacon;
+            CHECK(beacon.fit(x, y, size, RADIUS));
+            CHECK(beacon.size == size);
+            CHECK_NEAR(beacon.x, distance*cos(angle), 0.002);
+            CHECK_NEAR(beacon.y, distance*sin(angle), 0.002);
+            CHECK(beacon.residual < 0.001f);
+            
+            size = sample(distance, angle, 0.01f, x, y);
+            
+            CHECK(beacon.fit(x, y, size, RADIUS));
+            CHECK(sqrt((beacon.x-distance*cos(angle))*(beacon.x-distance*cos(angle))+(beacon.y-distance*sin(angle))*(beacon.y-distance*sin(angle))) < 0.03f);
+            CHECK(beacon.residual < 0.012f);
+            CHECK(beacon.covariance[0][0] > 0.0f);
+            CHECK(beacon.covariance[1][1] > 0.0f);
+            CHECK(beacon.covariance[0][1] == beacon.covariance[1][0]);
+            CHECK(beacon.covariance[0][0]*beacon.covariance[1][1] > beacon.covariance[0][1]*beacon.covariance[0][1]);
+        }
+    }
+    
+    // points closer to the sensor than the radius cannot belong to a pipe
+    
+    Beacon beacon;
+    x[0] = 0.01f; y[0] = 0.0f;
+    x[1] = 0.0f; y[1] = 0.01f;
+    CHECK(!beacon.fit(x, y, 2, RADIUS));
+    CHECK(!beacon.fit(x, y, 0, RADIUS));
+    
+    // the points of the pipes of the simulated scans collapse to one center per pipe,
+    // the residuals are bounded by the simulated noise, which is up to 18 mm
+    
+    static TestStream stream;       // without input, this LIDAR object uses its simulated scans
+    static LIDAR lidar(stream);
+    static Scan scan;
+    
+    Beacon beacons[16];
+    
+    for (unsigned short i = 0; i < 100; i++) {
+        
+        lidar.getScan(scan);
+        
+        unsigned short size = lidar.getBeacons(scan, beacons, 16);
+        CHECK(size == 3);
+        
+        for (unsigned short k = 0; k < size; k++) {
+            CHECK(beacons[k].size >= 2);
+            CHECK(beacons[k].residual < 0.015f);
+        }
+    }
+    
+    return TEST_RESULT;
+}
@@ -0,0 +1,422 @@
+/*
+ * TestController.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include <cmath>
+#include "Test.h"
+#include "Controller.h"
+
+using namespace std;
+
+static const double PI = 3.14159265358979323846;
+static const double SIGMA_DISTANCE = 0.01;  // standard deviation of distance measurement of the controller, given in [m]
+static const double SIGMA_GAMMA = 0.02;     // standard deviation of angle measurement of the controller, given in [rad]
+static const double SIGMA_TRANSLATION = 0.0001; // standard deviation of estimated translation per period of the controller, given in [m]
+static const double SIGMA_ORIENTATION = 0.0002; // standard deviation of estimated orientation per period of the controller, given in [rad]
+
+/**
+ * Corrects a pose with beacons with the generic equations of an extended Kalman filter,
+ * with full matrix products in double precision, as a reference for the controller.
+ */
+static void correctPose(double pose[3], double p[3][3], Point actualBeacons[], Point measuredBeacons[], unsigned short size) {
+    
+    for (unsigned short n = 0; n < size; n++) {
+        
+        double dx = actualBeacons[n].x-pose[0];
+        double dy = actualBeacons[n].y-pose[1];
+        double rr = dx*dx+dy*dy;
+        double r = sqrt(rr);
+        
+        double mx = measuredBeacons[n].x-pose[0];
+        double my = measuredBeacons[n].y-pose[1];
+        
+        double innovation[2] = {sqrt(mx*mx+my*my)-r, remainder(atan2(my, mx)-atan2(dy, dx), 2.0*PI)};
+        double h[2][3] = {{-dx/r, -dy/r, 0.0}, {dy/rr, -dx/rr, -1.0}};
+        
+        double hp[2][3] = {{0.0}};
+        for (int i = 0; i < 2; i++) for (int j = 0; j < 3; j++) for (int k = 0; k < 3; k++) hp[i][j] += h[i][k]*p[k][j];
+        
+        double s[2][2] = {{SIGMA_DISTANCE*SIGMA_DISTANCE, 0.0}, {0.0, SIGMA_GAMMA*SIGMA_GAMMA}};
+        for (int i = 0; i < 2; i++) for (int j = 0; j < 2; j++) for (int k = 0; k < 3; k++) s[i][j] += hp[i][k]*h[j][k];
+        
+        double determinant = s[0][0]*s[1][1]-s[0][1]*s[1][0];
+        double inverse[2][2] = {{s[1][1]/determinant, -s[0][1]/determinant}, {-s[1][0]/determinant, s[0][0]/determinant}};
+        
+        double k[3][2] = {{0.0}};
+        for (int i = 0; i < 3; i++) for (int j = 0; j < 2; j++) for (int l = 0; l < 2; l++) k[i][j] += hp[l][i]*inverse[l][j];
+        
+        for (int i = 0; i < 3; i++) pose[i] += k[i][0]*innovation[0]+k[i][1]*innovation[1];
+        pose[2] = remainder(pose[2], 2.0*PI);
+        
+        double khp[3][3] = {{0.0}};
+        for (int i = 0; i < 3; i++) for (int j = 0; j < 3; j++) for (int l = 0; l < 2; l++) khp[i][j] += k[i][l]*hp[l][j];
+        for (int i = 0; i < 3; i++) for (int j = 0; j < 3; j++) p[i][j] -= khp[i][j];
+    }
+}
+
+/**
+ * Creates a beacon at a given position, and its measurement from a robot with a given pose error.
+ */
+static void createBeacon(float x, float y, float errorX, float errorY, float errorAlpha, float noise, Point& actualBeacon, Point& measuredBeacon) {
+    
+    actualBeacon.x = x;
+    actualBeacon.y = y;
+    
+    // the robot sees the beacon from a pose that is offset by the error, so the measured beacon is displaced inversely
+    
+    float c = cos(errorAlpha);
+    float s = sin(errorAlpha);
+    
+    measuredBeacon.x = c*x+s*y-errorX+noise*(2.0f*(float)rand()/(float)RAND_MAX-1.0f);
+    measuredBeacon.y = -s*x+c*y-errorY+noise*(2.0f*(float)rand()/(float)RAND_MAX-1.0f);
+}
+
+/**
+ * Turns the wheels of the robot by a number of encoder counts, and runs the controller for one period.
+ * The encoder counters count down, when the counts of the wheels increase.
+ */
+static void drive(int countsLeft, int countsRight) {
+    
+    TIM4->CNT = (uint16_t)(TIM4->CNT-countsLeft);
+    TIM3->CNT = (uint16_t)(TIM3->CNT-countsRight);
+    
+    Thread::run(osPriorityHigh, 1);
+}
+
+/**
+ * Predicts a covariance matrix of the pose with the generic products P = F*P*F'+G*Q*G' in double precision,
+ * with the jacobians of a motion along a circular arc, which are reconstructed from the poses before and after this motion.
+ */
+static void predictCovariance(const PoseSnapshot& pose, const PoseSnapshot& predictedPose, double p[3][3]) {
+    
+    double deltaX = (double)predictedPose.x-(double)pose.x;
+    double deltaY = (double)predictedPose.y-(double)pose.y;
+    double deltaOrientation = remainder((double)predictedPose.alpha-(double)pose.alpha, 2.0*PI);
+    
+    double a = 1.0;
+    double b = 0.0;
+    double derivativeA = 0.0;
+    double derivativeB = 0.5;
+    
+    if (fabs(deltaOrientation) > 1.0e-9) {
+        a = sin(deltaOrientation)/deltaOrientation;
+        b = (1.0-cos(deltaOrientation))/deltaOrientation;
+        derivativeA = (cos(deltaOrientation)-a)/deltaOrientation;
+        derivativeB = (sin(deltaOrientation)-b)/deltaOrientation;
+    }
+    
+    double c = cos(pose.alpha);
+    double s = sin(pose.alpha);
+    double deltaTranslation = ((c*a-s*b)*deltaX+(s*a+c*b)*deltaY)/(a*a+b*b);
+    
+    double f[3][3] = {{1.0, 0.0, -deltaY}, {0.0, 1.0, deltaX}, {0.0, 0.0, 1.0}};
+    double g[3][2] = {{c*a-s*b, deltaTranslation*(c*derivativeA-s*derivativeB)}, {s*a+c*b, deltaTranslation*(s*derivativeA+c*derivativeB)}, {0.0, 1.0}};
+    double q[2] = {SIGMA_TRANSLATION*SIGMA_TRANSLATION, SIGMA_ORIENTATION*SIGMA_ORIENTATION};
+    
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            p[i][j] = 0.0;
+            for (int k = 0; k < 3; k++) for (int l = 0; l < 3; l++) p[i][j] += f[i][k]*pose.p(k, l)*f[j][l];
+            for (int k = 0; k < 2; k++) p[i][j] += g[i][k]*q[k]*g[j][k];
+        }
+    }
+}
+
+/**
+ * Drives the robot with a profile of the translational and the rotational velocity, and integrates
+ * the velocities that the controller estimates in every period exactly along circular arcs in double
+ * precision, and with a first order step along the heading at the end of the period.
+ * @param controller a reference to the controller of the robot.
+ * @param profile the number of the profile.
+ * @param errorArc a reference to a variable that is set to the distance between the pose of the controller and the exact integration, given in [m].
+ * @param errorFirstOrder a reference to a variable that is set to the distance between the first order and the exact integration, given in [m].
+ */
+static void driveProfile(Controller& controller, int profile, double& errorArc, double& errorFirstOrder) {
+    
+    const double PERIOD = DefaultRobotProfile::PERIOD;
+    const double HALF_WHEEL_DISTANCE = DefaultRobotProfile::HALF_WHEEL_DISTANCE;
+    const double COUNTS_PER_METER = DefaultRobotProfile::COUNTS_PER_TURN/(2.0*PI*DefaultRobotProfile::WHEEL_RADIUS);
+    
+    // let the estimated velocities settle to zero before the pose is reset
+    
+    for (unsigned int period = 0; period < 1000; period++) drive(0, 0);
+    
+    controller.setPose(0.0f, 0.0f, 0.0f, Matrix<3, 3>::identity()*0.001f);
+    drive(0, 0);
+    
+    double x = 0.0, y = 0.0, alpha = 0.0;
+    double xFirstOrder = 0.0, yFirstOrder = 0.0, alphaFirstOrder = 0.0;
+    double positionLeft = 0.0, positionRight = 0.0;
+    
+    for (unsigned int period = 0; period < 120000; period++) {
+        
+        double time = period*PERIOD;
+        double v = 0.0, omega = 0.0;
+        
+        if (profile == 0) {
+            v = 0.5;
+            omega = 2.0*sin(2.0*PI*0.5*time);
+        } else if (profile == 1) {
+            v = 1.0;
+            omega = 2.0;
+        } else {
+            v = 0.6+0.4*sin(0.5*time);
+            omega = 1.5+sin(0.3*time)+0.5*cos(1.1*time);
+        }
+        
+        // turn the wheels by the counts of this period, the right wheel counts backwards when the robot moves forward
+        
+        double previousLeft = positionLeft;
+        double previousRight = positionRight;
+        
+        positionLeft += (v-HALF_WHEEL_DISTANCE*omega)*PERIOD*COUNTS_PER_METER;
+        positionRight -= (v+HALF_WHEEL_DISTANCE*omega)*PERIOD*COUNTS_PER_METER;
+        
+        drive((int)(floor(positionLeft)-floor(previousLeft)), (int)(floor(positionRight)-floor(previousRight)));
+        
+        double deltaTranslation = controller.getActualTranslationalVelocity()*PERIOD;
+        double deltaOrientation = controller.getActualRotationalVelocity()*PERIOD;
+        
+        if (fabs(deltaOrientation) > 1.0e-12) {
+            x += deltaTranslation/deltaOrientation*(sin(alpha+deltaOrientation)-sin(alpha));
+            y += deltaTranslation/deltaOrientation*(cos(alpha)-cos(alpha+deltaOrientation));
+        } else {
+            x += deltaTranslation*cos(alpha);
+            y += deltaTranslation*sin(alpha);
+        }
+        
+        alpha += deltaOrientation;
+        
+        alphaFirstOrder += deltaOrientation;
+        xFirstOrder += deltaTranslation*cos(alphaFirstOrder);
+        yFirstOrder += deltaTranslation*sin(alphaFirstOrder);
+    }
+    
+    PoseSnapshot pose = controller.getPoseSnapshot();
+    
+    errorArc = sqrt((pose.x-x)*(pose.x-x)+(pose.y-y)*(pose.y-y));
+    errorFirstOrder = sqrt((xFirstOrder-x)*(xFirstOrder-x)+(yFirstOrder-y)*(yFirstOrder-y));
+    
+    CHECK_NEAR(remainder(pose.alpha-alpha, 2.0*PI), 0.0, 1.0e-3);
+}
+
+/**
+ * Tests the pose corrections of the controller, with the hardware of the robot replaced by the stub of the host.
+ */
+int main() {
+    
+    static PwmOut pwmLeft(PF_9);
+    static PwmOut pwmRight(PF_8);
+    static EncoderCounter counterLeft(PD_12, PD_13);
+    static EncoderCounter counterRight(PB_4, PC_7);
+    static SPI spi(PC_12, PC_11, PC_10);
+    static DigitalOut csAG(PC_8);
+    static DigitalOut csM(PC_9);
+    static IMU imu(spi, csAG, csM);
+    static PoseHistory poseHistory;
+    static Controller controller(pwmLeft, pwmRight, counterLeft, counterRight, imu, poseHistory);
+    
+    srand(1);
+    
+    // the sequential update with all beacons of a scan matches the generic equations of a Kalman filter
+    
+    for (unsigned short size = 1; size <= 4; size++) {
+        for (unsigned short run = 0; run < 20; run++) {
+            
+            Matrix<3, 3> p0;
+            p0(0, 0) = 0.01f;
+            p0(0, 1) = 0.002f;
+            p0(1, 0) = 0.002f;
+            p0(1, 1) = 0.02f;
+            p0(2, 2) = 0.005f;
+            
+            controller.setPose(1.0f, 2.0f, -3.0f+0.3f*run, p0);
+            Thread::run(osPriorityHigh, 1);
+            
+            PoseSnapshot pose = controller.getPoseSnapshot();
+            
+            Point actualBeacons[4];
+            Point measuredBeacons[4];
+            
+            for (unsigned short n = 0; n < size; n++) {
+                createBeacon(pose.x+2.0f*cos(1.5f*n+run), pose.y+1.5f*sin(1.5f*n+run), 0.05f, -0.03f, 0.02f, 0.01f, actualBeacons[n], measuredBeacons[n]);
+            }
+            
+            double reference[3] = {pose.x, pose.y, pose.alpha};
+            double p[3][3];
+            for (int i = 0; i < 3; i++) for (int j = 0; j < 3; j++) p[i][j] = pose.p(i, j);
+            
+            correctPose(reference, p, actualBeacons, measuredBeacons, size);
+            
+            if (size == 1) {
+                controller.correctPoseWithBeacon(actualBeacons[0], measuredBeacons[0]);
+            } else {
+                controller.correctPoseWithBeacons(actualBeacons, measuredBeacons, size);
+            }
+            
+            Thread::run(osPriorityHigh, 1);
+            
+            pose = controller.getPoseSnapshot();
+            
+            CHECK_NEAR(pose.x, reference[0], 1.0e-5);
+            CHECK_NEAR(pose.y, reference[1], 1.0e-5);
+            CHECK_NEAR(remainder(pose.alpha-reference[2], 2.0*PI), 0.0, 1.0e-5);
+            
+            // the covariance matrix differs from the reference only by the process noise of one period, below 1e-7
+            
+            for (int i = 0; i < 3; i++) {
+                for (int j = 0; j < 3; j++) {
+                    CHECK_NEAR(pose.p(i, j), p[i][j], 1.0e-7+1.0e-4*fabs(p[i][j]));
+                    CHECK(pose.p(i, j) == pose.p(j, i));
+                }
+            }
+        }
+    }
+    
+    // repeated corrections with consistent beacons converge to the actual pose, with a covariance matrix that stays valid
+    
+    Matrix<3, 3> p0 = Matrix<3, 3>::identity()*0.01f;
+    controller.setPose(0.5f, 0.5f, 0.1f, p0);
+    Thread::run(osPriorityHigh, 1);
+    
+    for (unsigned short scan = 0; scan < 100; scan++) {
+        
+        PoseSnapshot pose = controller.getPoseSnapshot();
+        
+        Point actualBeacons[4];
+        Point measuredBeacons[4];
+        
+        for (unsigned short n = 0; n < 4; n++) {
+            
+            float x = 2.0f*(float)(n%2)-0.5f;
+            float y = 2.0f*(float)(n/2)-0.5f;
+            
+            // the actual pose of the robot is (0.5, 0.6, 0.12)
+            
+            float c = cos(pose.alpha-0.12f);
+            float s = sin(pose.alpha-0.12f);
+            
+            actualBeacons[n].x = x;
+            actualBeacons[n].y = y;
+            measuredBeacons[n].x = pose.x+c*(x-0.5f)-s*(y-0.6f)+0.005f*(2.0f*(float)rand()/(float)RAND_MAX-1.0f);
+            measuredBeacons[n].y = pose.y+s*(x-0.5f)+c*(y-0.6f)+0.005f*(2.0f*(float)rand()/(float)RAND_MAX-1.0f);
+        }
+        
+        controller.correctPoseWithBeacons(actualBeacons, measuredBeacons, 4);
+        Thread::run(osPriorityHigh, 1);
+        
+        pose = controller.getPoseSnapshot();
+        
+        CHECK(pose.p(0, 0) > 0.0f);
+        CHECK(pose.p(1, 1) > 0.0f);
+        CHECK(pose.p(2, 2) > 0.0f);
+        CHECK(pose.p(0, 0)*pose.p(1, 1) > pose.p(0, 1)*pose.p(0, 1));
+    }
+    
+    PoseSnapshot pose = controller.getPoseSnapshot();
+    
+    CHECK_NEAR(pose.x, 0.5, 0.01);
+    CHECK_NEAR(pose.y, 0.6, 0.01);
+    CHECK_NEAR(pose.alpha, 0.12, 0.01);
+    
+    // measure the duration of a correction with 4 beacons, in batches that fit into the queue of corrections
+    
+    Point actualBeacons[4];
+    Point measuredBeacons[4];
+    
+    for (unsigned short n = 0; n < 4; n++) createBeacon(2.0f*(float)(n%2)-0.5f, 2.0f*(float)(n/2)-0.5f, 0.0f, 0.0f, 0.0f, 0.005f, actualBeacons[n], measuredBeacons[n]);
+    
+    double duration = 0.0;
+    
+    for (unsigned short batch = 0; batch < 1000; batch++) {
+        
+        double start = testTime();
+        for (unsigned short i = 0; i < 8; i++) controller.correctPoseWithBeacons(actualBeacons, measuredBeacons, 4);
+        duration += testTime()-start;
+        
+        Thread::run(osPriorityHigh, 1);
+    }
+    
+    printf("pose correction with 4 beacons: %.0f ns\n", duration/8000.0*1.0e9);
+    
+    // a correction with a measurement of the full pose moves the pose by the Kalman gain towards the measurement
+    
+    controller.setPose(1.0f, 2.0f, 0.5f, Matrix<3, 3>::identity()*0.01f);
+    Thread::run(osPriorityHigh, 1);
+    
+    controller.correctPose(1.2f, 1.9f, 0.4f, Matrix<3, 3>::identity()*0.03f);
+    Thread::run(osPriorityHigh, 1);
+    
+    pose = controller.getPoseSnapshot();
+    
+    CHECK_NEAR(pose.x, 1.05, 1.0e-5);
+    CHECK_NEAR(pose.y, 1.975, 1.0e-5);
+    CHECK_NEAR(pose.alpha, 0.475, 1.0e-5);
+    CHECK_NEAR(pose.p(0, 0), 0.0075, 1.0e-6);
+    CHECK_NEAR(pose.p(2, 2), 0.0075, 1.0e-6);
+    
+    // the expanded prediction of the covariance matrix matches the generic products while the robot moves along arcs
+    
+    controller.setPose(0.0f, 0.0f, 0.0f, p0);
+    Thread::run(osPriorityHigh, 1);
+    
+    double worstDifference = 0.0;
+    
+    for (unsigned int period = 0; period < 4000; period++) {
+        
+        PoseSnapshot previousPose = controller.getPoseSnapshot();
+        
+        drive((int)(10.0f+8.0f*sin(0.003f*period)), (int)(-10.0f+8.0f*cos(0.002f*period)));
+        
+        pose = controller.getPoseSnapshot();
+        
+        double p[3][3];
+        predictCovariance(previousPose, pose, p);
+        
+        double norm = 0.0;
+        for (int i = 0; i < 3; i++) for (int j = 0; j < 3; j++) norm = fmax(norm, fabs(p[i][j]));
+        for (int i = 0; i < 3; i++) for (int j = 0; j < 3; j++) worstDifference = fmax(worstDifference, fabs(pose.p(i, j)-p[i][j])/norm);
+    }
+    
+    CHECK(worstDifference < 1.0e-4);
+    
+    drive(0, 0);
+    
+    printf("covariance prediction: largest difference %.1e relative to the generic products\n", worstDifference);
+    
+    // the odometry along circular arcs matches an exact integration over 120 s within the rounding of the pose in single
+    // precision, while first order steps drift by half a step length when the robot keeps turning in one direction
+    
+    const char* profiles[] = {"sinusoidal turning", "constant rotation", "mixed profile"};
+    
+    for (int profile = 0; profile < 3; profile++) {
+        
+        double errorArc = 0.0;
+        double errorFirstOrder = 0.0;
+        
+        driveProfile(controller, profile, errorArc, errorFirstOrder);
+        
+        CHECK(errorArc < 0.001);
+        CHECK((profile == 0) || (errorArc < errorFirstOrder));
+        
+        printf("odometry with %s: %.2f mm error along arcs, %.2f mm with first order steps\n", profiles[profile], errorArc*1000.0, errorFirstOrder*1000.0);
+    }
+    
+    // measure the duration of a period of the control loop on the host, the robot reports its CPU cycles instead
+    
+    const unsigned int PERIODS = 100000;
+    
+    double periodStart = testTime();
+    
+    for (unsigned int period = 0; period < PERIODS; period++) drive(3, 5);
+    
+    double periodDuration = testTime()-periodStart;
+    
+    CHECK(controller.getMaximumCycles() >= controller.getCycles());
+    
+    printf("period of the control loop: %.0f ns\n", periodDuration/PERIODS*1.0e9);
+    
+    return TEST_RESULT;
+}
@@ -0,0 +1,225 @@
+/*
+ * TestDifferentialMotion.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include <cmath>
+#include <algorithm>
+#include <cstdio>
+#include "Test.h"
+#include "DifferentialMotion.h"
+#include "RobotProfile.h"
+
+using namespace std;
+
+typedef DefaultRobotProfile Profile;
+
+static const double PI = 3.14159265358979;
+static const double VELOCITY_PER_RPM = 2.0*PI*Profile::WHEEL_RADIUS/60.0;   // wheel velocity in [m/s] per wheel speed in [rpm]
+
+/**
+ * Plans the wheel speeds of a robot that starts from rest towards the wheel speeds of a commanded
+ * circle, and drives the robot with ideal wheels along the planned speeds.
+ * @param velocity the commanded translational velocity, given in [m/s].
+ * @param rotation the commanded rotational velocity, given in [rad/s].
+ * @param joint <code>true</code> to plan the speeds with a <code>DifferentialMotion</code> object,
+ * <code>false</code> to plan them with independent <code>Motion</code> objects.
+ * @param jerk the limit of the jerk, or 0 for a profile without a jerk limit.
+ * @return the largest distance of the robot from the commanded circle within 2 s, given in [m].
+ */
+static double simulate(double velocity, double rotation, bool joint, float jerk) {
+    
+    float targetLeft = (velocity-Profile::HALF_WHEEL_DISTANCE*rotation)/VELOCITY_PER_RPM;
+    float targetRight = (velocity+Profile::HALF_WHEEL_DISTANCE*rotation)/VELOCITY_PER_RPM;
+    
+    DifferentialMotion motion;
+    motion.setProfileVelocity(Profile::MAXIMUM_VELOCITY);
+    motion.setProfileAcceleration(Profile::MAXIMUM_ACCELERATION);
+    motion.setProfileDeceleration(Profile::MAXIMUM_ACCELERATION);
+    motion.setProfileJerk(jerk);
+    
+    Motion motionLeft;
+    Motion motionRight;
+    motionLeft.setLimits(Profile::MAXIMUM_VELOCITY, Profile::MAXIMUM_ACCELERATION, Profile::MAXIMUM_ACCELERATION);
+    motionRight.setLimits(Profile::MAXIMUM_VELOCITY, Profile::MAXIMUM_ACCELERATION, Profile::MAXIMUM_ACCELERATION);
+    motionLeft.setProfileJerk(jerk);
+    motionRight.setProfileJerk(jerk);
+    
+    // the commanded circle starts at the origin in the direction of the x axis, the robot
+    // stays on the circle as long as the ratio of its wheel speeds is preserved
+    
+    double radius = velocity/rotation;
+    double x = 0.0, y = 0.0, alpha = 0.0;
+    double error = 0.0;
+    
+    for (unsigned int period = 0; period < 2000; period++) {
+        
+        float speedLeft, speedRight;
+        
+        if (joint) {
+            motion.incrementToVelocity(targetLeft, targetRight, Profile::PERIOD);
+            speedLeft = motion.getVelocityLeft();
+            speedRight = motion.getVelocityRight();
+        } else {
+            motionLeft.incrementToVelocity(targetLeft, Profile::PERIOD);
+            motionRight.incrementToVelocity(targetRight, Profile::PERIOD);
+            speedLeft = motionLeft.velocity;
+            speedRight = motionRight.velocity;
+        }
+        
+        double deltaTranslation = (speedLeft+speedRight)/2.0*VELOCITY_PER_RPM*Profile::PERIOD;
+        double deltaOrientation = (speedRight-speedLeft)/Profile::WHEEL_DISTANCE*VELOCITY_PER_RPM*Profile::PERIOD;
+        
+        if (fabs(deltaOrientation) > 1.0e-12) {
+            x += deltaTranslation/deltaOrientation*(sin(alpha+deltaOrientation)-sin(alpha));
+            y += deltaTranslation/deltaOrientation*(cos(alpha)-cos(alpha+deltaOrientation));
+        } else {
+            x += deltaTranslation*cos(alpha);
+            y += deltaTranslation*sin(alpha);
+        }
+        
+        alpha += deltaOrientation;
+        
+        double distance = fabs(sqrt(x*x+(y-radius)*(y-radius))-fabs(radius));
+        if (distance > error) error = distance;
+    }
+    
+    return error;
+}
+
+/**
+ * Plans the wheel speeds from given actual speeds towards given target speeds, and checks that both
+ * wheels move along a straight line and reach their targets in the same period.
+ * @return the number of periods until both wheels reached their targets.
+ */
+static unsigned int change(float speedLeft, float speedRight, float targetLeft, float targetRight, float jerk) {
+    
+    DifferentialMotion motion;
+    motion.setProfileVelocity(Profile::MAXIMUM_VELOCITY);
+    
+    // jump to the actual speeds first, without limits of the acceleration
+    
+    motion.setProfileAcceleration(1.0e9f);
+    motion.setProfileDeceleration(1.0e9f);
+    motion.incrementToVelocity(speedLeft, speedRight, Profile::PERIOD);
+    motion.incrementToVelocity(speedLeft, speedRight, Profile::PERIOD);
+    motion.setProfileAcceleration(Profile::MAXIMUM_ACCELERATION);
+    motion.setProfileDeceleration(Profile::MAXIMUM_ACCELERATION);
+    motion.setProfileJerk(jerk);
+    
+    CHECK_NEAR(motion.getVelocityLeft(), speedLeft, 1.0e-3);
+    CHECK_NEAR(motion.getVelocityRight(), speedRight, 1.0e-3);
+    
+    float deltaLeft = targetLeft-speedLeft;
+    float deltaRight = targetRight-speedRight;
+    float delta = sqrt(deltaLeft*deltaLeft+deltaRight*deltaRight);
+    
+    double worstDeviation = 0.0;
+    unsigned int periodLeft = 0;
+    unsigned int periodRight = 0;
+    
+    for (unsigned int period = 1; period <= 10000; period++) {
+        
+        motion.incrementToVelocity(targetLeft, targetRight, Profile::PERIOD);
+        
+        float left = motion.getVelocityLeft();
+        float right = motion.getVelocityRight();
+        
+        // distance of the wheel speeds from the straight line between the actual and the target speeds
+        
+        double deviation = fabs((left-speedLeft)*deltaRight-(right-speedRight)*deltaLeft)/delta;
+        if (deviation > worstDeviation) worstDeviation = deviation;
+        
+        // a wheel has reached its target when less than 0.1% of its change remains
+        
+        if ((periodLeft == 0) && (fabs(left-targetLeft) <= 0.001f*fabs(deltaLeft))) periodLeft = period;
+        if ((periodRight == 0) && (fabs(right-targetRight) <= 0.001f*fabs(deltaRight))) periodRight = period;
+        
+        if ((periodLeft > 0) && (periodRight > 0)) break;
+    }
+    
+    CHECK(worstDeviation < 0.01);
+    CHECK(periodLeft > 0);
+    CHECK(periodRight > 0);
+    CHECK((periodLeft <= periodRight+1) && (periodRight <= periodLeft+1));
+    
+    return max(periodLeft, periodRight);
+}
+
+/**
+ * Tests the joint planning of the wheel speeds against independent planning of both wheels.
+ */
+int main() {
+    
+    // starting from rest, the joint plan keeps the robot on the commanded circle, with and without a jerk limit
+    
+    const double commands[][2] = {{0.3, 1.5}, {0.5, 2.0}, {0.6, 4.0}, {1.8, 3.0}};
+    
+    for (unsigned int i = 0; i < 4; i++) {
+        for (unsigned int j = 0; j < 2; j++) {
+            
+            float jerk = (j == 0) ? 0.0f : Profile::MAXIMUM_JERK;
+            
+            double errorIndependent = simulate(commands[i][0], commands[i][1], false, jerk);
+            double errorJoint = simulate(commands[i][0], commands[i][1], true, jerk);
+            
+            CHECK(errorJoint < 0.001);
+            CHECK(errorIndependent > 10.0*errorJoint);
+            
+            printf("%.1f m/s and %.1f rad/s %s jerk limit: path error %.1f mm independent, %.2f mm joint\n", commands[i][0], commands[i][1], (j == 0) ? "without" : "with", errorIndependent*1000.0, errorJoint*1000.0);
+        }
+    }
+    
+    // changes between arbitrary wheel speeds move along a straight line, and both wheels reach their targets together
+    
+    const float speeds[][4] = {{0.0f, 0.0f, 100.0f, 300.0f}, {100.0f, 300.0f, 300.0f, 100.0f}, {200.0f, -200.0f, 50.0f, 250.0f}, {400.0f, 300.0f, 0.0f, 0.0f}, {-100.0f, 50.0f, 120.0f, 40.0f}};
+    
+    for (unsigned int i = 0; i < 5; i++) {
+        
+        unsigned int periodsWithoutJerk = change(speeds[i][0], speeds[i][1], speeds[i][2], speeds[i][3], 0.0f);
+        unsigned int periodsWithJerk = change(speeds[i][0], speeds[i][1], speeds[i][2], speeds[i][3], Profile::MAXIMUM_JERK);
+        
+        // the wheel with the larger change still runs at the acceleration limit
+        
+        float largerChange = max(fabs(speeds[i][2]-speeds[i][0]), fabs(speeds[i][3]-speeds[i][1]));
+        
+        CHECK_NEAR(periodsWithoutJerk*Profile::PERIOD, largerChange/Profile::MAXIMUM_ACCELERATION, 0.002);
+        CHECK(periodsWithJerk >= periodsWithoutJerk);
+    }
+    
+    // target speeds above the velocity limit are scaled down for both wheels with the same factor
+    
+    DifferentialMotion motion;
+    motion.setProfileVelocity(Profile::MAXIMUM_VELOCITY);
+    motion.setProfileAcceleration(Profile::MAXIMUM_ACCELERATION);
+    motion.setProfileDeceleration(Profile::MAXIMUM_ACCELERATION);
+    
+    for (unsigned int period = 0; period < 5000; period++) motion.incrementToVelocity(300.0f, 600.0f, Profile::PERIOD);
+    
+    CHECK_NEAR(motion.getVelocityLeft(), 250.0, 1.0e-3);
+    CHECK_NEAR(motion.getVelocityRight(), Profile::MAXIMUM_VELOCITY, 1.0e-3);
+    CHECK_NEAR(motion.getAccelerationLeft(), 0.0, 1.0e-6);
+    CHECK_NEAR(motion.getAccelerationRight(), 0.0, 1.0e-6);
+    
+    // measure the duration of one increment with a jerk limit, alternating between two targets
+    
+    motion.setProfileJerk(Profile::MAXIMUM_JERK);
+    
+    const unsigned int INCREMENTS = 1000000;
+    
+    double start = testTime();
+    
+    for (unsigned int i = 0; i < INCREMENTS; i++) {
+        if ((i/1000)%2 == 0) motion.incrementToVelocity(300.0f, 100.0f, Profile::PERIOD);
+        else motion.incrementToVelocity(-100.0f, 200.0f, Profile::PERIOD);
+    }
+    
+    double duration = testTime()-start;
+    
+    CHECK(fabs(motion.getVelocityLeft()) <= Profile::MAXIMUM_VELOCITY);
+    
+    printf("joint increment of the wheel speeds: %.0f ns\n", duration/INCREMENTS*1.0e9);
+    
+    return TEST_RESULT;
+}
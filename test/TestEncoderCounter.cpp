@@ -0,0 +1,193 @@
+/*
+ * TestEncoderCounter.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include "Test.h"
+#include "EncoderCounter.h"
+#include "VelocityEstimator.h"
+
+using namespace std;
+
+static const float  PERIOD = 0.001f;    // period of the controller, given in [s]
+
+/**
+ * Sets the 16-bit hardware counter of the simulated timer to a given absolute position of the encoder.
+ * The timer counts in the opposite direction of the encoder, like on the robot.
+ */
+static void setPosition(int64_t position) {
+    
+    TIM2->CNT = static_cast<uint32_t>(-position) & 0xFFFF;
+}
+
+/**
+ * Drives the encoder with a constant rate, reads the count in every period and estimates the velocity.
+ * @param rate the rate of the encoder, given in [counts/s].
+ * @param errorEstimator the largest error of the estimated velocity after 0.2 s, given in [counts/s].
+ * @param errorDifference the largest error of the count difference of single periods, given in [counts/s].
+ * @return the mean of the estimated velocity after 0.2 s, given in [counts/s].
+ */
+static double drive(EncoderCounter& encoderCounter, double rate, double& errorEstimator, double& errorDifference) {
+    
+    VelocityEstimator velocityEstimator;
+    velocityEstimator.setPeriod(PERIOD);
+    
+    setPosition(0);
+    encoderCounter.reset();
+    velocityEstimator.reset(encoderCounter.readCount());
+    
+    int64_t previousCount = 0;
+    double sum = 0.0;
+    unsigned int samples = 0;
+    
+    errorEstimator = 0.0;
+    errorDifference = 0.0;
+    
+    // start at a phase between two counts, so that the edges are not aligned with the periods
+    
+    for (unsigned int period = 1; period <= 2000; period++) {
+        
+        int64_t position = static_cast<int64_t>(floor(0.37+rate*period*PERIOD));
+        
+        setPosition(position);
+        
+        int64_t count = encoderCounter.readCount();
+        
+        CHECK(count == position);
+        
+        float velocity = velocityEstimator.update(count);
+        float difference = (count-previousCount)/PERIOD;
+        
+        previousCount = count;
+        
+        if (period <= 200) continue;
+        
+        errorEstimator = fmax(errorEstimator, fabs(velocity-rate));
+        errorDifference = fmax(errorDifference, fabs(difference-rate));
+        sum += velocity;
+        samples++;
+    }
+    
+    return sum/samples;
+}
+
+/**
+ * Tests the extension of the 16-bit encoder counter to an absolute count, and the estimation of
+ * the velocity from this count, with a simulated timer.
+ */
+int main() {
+    
+    EncoderCounter encoderCounter(PA_15, PB_3);
+    
+    setPosition(0);
+    encoderCounter.reset();
+    
+    CHECK(encoderCounter.readCount() == 0);
+    
+    // the absolute count follows the encoder over many wrap arounds of the 16-bit counter in both directions
+    
+    int64_t position = 0;
+    
+    for (unsigned int i = 0; i < 20; i++) {
+        
+        position += 30000;
+        setPosition(position);
+        
+        CHECK(encoderCounter.readCount() == position);
+        CHECK(encoderCounter.read() == static_cast<short>(position));
+    }
+    
+    CHECK(position == 600000);
+    
+    for (unsigned int i = 0; i < 40; i++) {
+        
+        position -= 32767;
+        setPosition(position);
+        
+        CHECK(encoderCounter.readCount() == position);
+    }
+    
+    CHECK(position < -600000);
+    
+    // a change of more than 32767 counts between two readings is taken as a change in the other direction
+    
+    int64_t count = encoderCounter.readCount();
+    
+    setPosition(position+40000);
+    
+    CHECK(encoderCounter.readCount() == count+40000-65536);
+    
+    // a reset with an offset starts the absolute count at this offset
+    
+    setPosition(123);
+    encoderCounter.reset(-500);
+    setPosition(-500+200);
+    
+    CHECK(encoderCounter.readCount() == -300);
+    
+    for (unsigned int i = 1; i <= 5; i++) {
+        setPosition(-500-30000*i);
+        encoderCounter.readCount();
+    }
+    
+    setPosition(-500-140000);
+    
+    CHECK(encoderCounter.readCount() == -140500);
+    
+    // at low speed, the estimator measures the time between edges, and resolves rates far below the
+    // quantization of the count difference of single periods, which is 1 count per period
+    
+    const double rates[] = {20.0, 150.0, -150.0, 700.0, 5230.0, 41370.0, -41370.0};
+    
+    for (unsigned int i = 0; i < 7; i++) {
+        
+        double errorEstimator, errorDifference;
+        double mean = drive(encoderCounter, rates[i], errorEstimator, errorDifference);
+        
+        double countsPerPeriod = fabs(rates[i])*PERIOD;
+        
+        // the edges are at the ends of the periods, so the time between the edges of a measurement
+        // is quantized to one period: this is at most 1 of 8 periods of the window at low speed,
+        // and 1 count per period at high speed
+        
+        if (countsPerPeriod < 1.0) CHECK(errorEstimator <= fabs(rates[i])/8.0+1.0e-3*fabs(rates[i]));
+        else CHECK(errorEstimator <= 1.0/PERIOD+1.0e-3*fabs(rates[i]));
+        
+        // the edges that are selected with the window do not sample all phases evenly, which biases the mean a little
+        
+        CHECK_NEAR(mean, rates[i], 0.03*fabs(rates[i]));
+        
+        if (countsPerPeriod < 1.0) CHECK(errorEstimator < 0.2*errorDifference);
+        
+        printf("%8.0f counts/s: mean %9.1f counts/s, largest error %7.1f counts/s estimator, %7.1f counts/s count difference\n", rates[i], mean, errorEstimator, errorDifference);
+    }
+    
+    // the velocity decays to zero when the encoder stops
+    
+    VelocityEstimator velocityEstimator;
+    velocityEstimator.setPeriod(PERIOD);
+    velocityEstimator.reset(0);
+    
+    for (unsigned int period = 1; period <= 100; period++) velocityEstimator.update(period/2);
+    
+    CHECK_NEAR(velocityEstimator.getVelocity(), 500.0, 1.0);
+    
+    float velocity = velocityEstimator.getVelocity();
+    
+    for (unsigned int period = 1; period <= 100; period++) {
+        float next = velocityEstimator.update(50);
+        CHECK(next <= velocity);
+        velocity = next;
+    }
+    
+    CHECK(velocityEstimator.getVelocity() < 20.0f);
+    
+    for (unsigned int period = 1; period <= 10; period++) velocityEstimator.update(50);
+    
+    CHECK(velocityEstimator.getVelocity() == 0.0f);
+    
+    return TEST_RESULT;
+}
@@ -0,0 +1,169 @@
+/*
+ * TestJointCompatibility.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include "Test.h"
+#include "JointCompatibility.h"
+
+using namespace std;
+
+static const float  SIGMA_BEACON = 0.01f;   // standard deviation of the center of a beacon, given in [m]
+
+/**
+ * Creates a beacon in robot coordinates, as it is seen from a robot at the origin that is rotated by a given angle.
+ */
+static Beacon createBeacon(float x, float y, float rotation) {
+    
+    Beacon beacon;
+    
+    beacon.x = cos(rotation)*x+sin(rotation)*y;
+    beacon.y = -sin(rotation)*x+cos(rotation)*y;
+    beacon.covariance[0][0] = SIGMA_BEACON*SIGMA_BEACON;
+    beacon.covariance[1][1] = SIGMA_BEACON*SIGMA_BEACON;
+    
+    return beacon;
+}
+
+/**
+ * Associates a beacon on its own with the landmark that has the smallest Mahalanobis distance,
+ * like a greedy nearest neighbor association, for a robot at the origin.
+ */
+static int associateGreedy(LandmarkMap& map, const Beacon& beacon, const Matrix<3, 3>& p) {
+    
+    Matrix<2, 3> jacobian = Matrix<2, 3>::identity();
+    jacobian(0, 2) = -beacon.y;
+    jacobian(1, 2) = beacon.x;
+    
+    Matrix<2, 2> covariance = jacobian*p*jacobian.transpose()+Matrix<2, 2>(beacon.covariance);
+    
+    float distance = 0.0f;
+    
+    return map.associate(beacon.x, beacon.y, covariance, distance);
+}
+
+/**
+ * Checks that no landmark is paired with more than one beacon.
+ */
+static bool isUnique(Point actualBeacons[], unsigned short associations) {
+    
+    for (unsigned short i = 0; i < associations; i++) {
+        for (unsigned short j = i+1; j < associations; j++) {
+            if ((actualBeacons[i].x == actualBeacons[j].x) && (actualBeacons[i].y == actualBeacons[j].y)) return false;
+        }
+    }
+    
+    return true;
+}
+
+/**
+ * Tests the joint compatibility branch and bound association with ambiguous landmarks and clutter.
+ */
+int main() {
+    
+    Point actualBeacons[JointCompatibility::MAXIMUM_BEACONS];
+    Point measuredBeacons[JointCompatibility::MAXIMUM_BEACONS];
+    
+    // a robot with an uncertain orientation, which is actually rotated by 0.15 rad: the beacon of the landmark
+    // at (2, 0) appears closer to the landmark 0.25 rad beside it, but only the landmark at (2, 0) is consistent
+    // with the beacon of the landmark at (-2, 0), which needs the same rotation
+    
+    {
+        const float xs[] = {2.0f, 2.0f*cos(0.25f), -2.0f};
+        const float ys[] = {0.0f, 2.0f*sin(0.25f), 0.0f};
+        
+        LandmarkMap map;
+        map.set(xs, ys, 3);
+        
+        Matrix<3, 3> p;
+        p(0, 0) = 0.0001f;
+        p(1, 1) = 0.0001f;
+        p(2, 2) = 0.01f;
+        
+        Beacon beacons[] = {createBeacon(2.0f, 0.0f, -0.15f), createBeacon(-2.0f, 0.0f, -0.15f)};
+        
+        CHECK(associateGreedy(map, beacons[0], p) == 1);
+        CHECK(associateGreedy(map, beacons[1], p) == 2);
+        
+        JointCompatibility jointCompatibility(map);
+        
+        unsigned short associations = jointCompatibility.associate(0.0f, 0.0f, 0.0f, p, beacons, 2, actualBeacons, measuredBeacons);
+        
+        CHECK(associations == 2);
+        CHECK((actualBeacons[0].x == 2.0f) && (actualBeacons[0].y == 0.0f));
+        CHECK((actualBeacons[1].x == -2.0f) && (actualBeacons[1].y == 0.0f));
+        CHECK(!jointCompatibility.isTruncated());
+    }
+    
+    // the 4 pipes of the arena, with clutter 6 cm next to two of them: every landmark is paired once, with its own beacon
+    
+    {
+        const float xs[] = {1.0f, 1.0f, -1.0f, -1.0f};
+        const float ys[] = {1.0f, -1.0f, -1.0f, 1.0f};
+        
+        LandmarkMap map;
+        map.set(xs, ys, 4);
+        
+        Matrix<3, 3> p;
+        p(0, 0) = 0.0004f;
+        p(1, 1) = 0.0004f;
+        p(2, 2) = 0.0004f;
+        
+        Beacon beacons[] = {createBeacon(1.06f, 1.0f, 0.0f), createBeacon(1.0f, 1.0f, 0.0f), createBeacon(1.0f, -1.0f, 0.0f), createBeacon(-1.0f, -0.94f, 0.0f), createBeacon(-1.0f, -1.0f, 0.0f), createBeacon(-1.0f, 1.0f, 0.0f)};
+        
+        JointCompatibility jointCompatibility(map);
+        
+        unsigned short associations = jointCompatibility.associate(0.0f, 0.0f, 0.0f, p, beacons, 6, actualBeacons, measuredBeacons);
+        
+        CHECK(associations == 4);
+        CHECK(isUnique(actualBeacons, associations));
+        CHECK(!jointCompatibility.isTruncated());
+        
+        for (unsigned short i = 0; i < associations; i++) {
+            CHECK_NEAR(measuredBeacons[i].x, actualBeacons[i].x, 1.0e-5);
+            CHECK_NEAR(measuredBeacons[i].y, actualBeacons[i].y, 1.0e-5);
+        }
+    }
+    
+    // a cluster of 4 landmarks with 8 uncertain beacons, where every beacon is compatible with every landmark
+    // and at most 4 beacons can be paired: the search stops at the node limit, and still returns a
+    // hypothesis without a landmark paired twice
+    
+    {
+        const float xs[] = {1.0f, 1.1f, 1.0f, 1.1f};
+        const float ys[] = {0.0f, 0.0f, 0.1f, 0.1f};
+        
+        LandmarkMap map;
+        map.set(xs, ys, 4);
+        
+        Matrix<3, 3> p;
+        p(0, 0) = 0.01f;
+        p(1, 1) = 0.01f;
+        p(2, 2) = 0.01f;
+        
+        Beacon beacons[JointCompatibility::MAXIMUM_BEACONS];
+        
+        for (unsigned short i = 0; i < JointCompatibility::MAXIMUM_BEACONS; i++) {
+            beacons[i] = createBeacon(1.0f+0.015f*(float)i, 0.01f*(float)(i%3), 0.0f);
+            beacons[i].covariance[0][0] = 0.01f;
+            beacons[i].covariance[1][1] = 0.01f;
+        }
+        
+        JointCompatibility jointCompatibility(map);
+        
+        unsigned short associations = jointCompatibility.associate(0.0f, 0.0f, 0.0f, p, beacons, JointCompatibility::MAXIMUM_BEACONS, actualBeacons, measuredBeacons);
+        
+        CHECK(jointCompatibility.isTruncated());
+        CHECK(jointCompatibility.getNodes() == 256);
+        CHECK(associations > 0);
+        CHECK(associations <= 4);
+        CHECK(isUnique(actualBeacons, associations));
+        
+        printf("cluster: %u associations of %u beacons after %u nodes\n", associations, JointCompatibility::MAXIMUM_BEACONS, jointCompatibility.getNodes());
+    }
+    
+    return TEST_RESULT;
+}
@@ -0,0 +1,322 @@
+/*
+ * TestLIDAR.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include <cmath>
+#include <deque>
+#include "Test.h"
+#include "TestStream.h"
+#include "LIDAR.h"
+
+using namespace std;
+
+/**
+ * Gets the points of beacons in a scan with the quadratic search of the original implementation.
+ */
+static deque<Point> getBeaconPoints(Scan& scan) {
+    
+    deque<Point> points;
+    for (unsigned short i = 0; i < scan.size; i++) points.push_back(Point(scan.r[i], scan.alpha[i]));
+    
+    deque<Point> beacons;
+    
+    for (unsigned short i = 0; i < points.size(); i++) {
+        
+        bool beacon = true;
+        int counter = 0;
+        
+        for (unsigned short j = 0; beacon && (j < points.size()); j++) {
+            
+            float distance = points[i].manhattanDistance(points[j]);
+            if (distance < 0.1f) {
+                counter++;
+            } else if (distance < 0.5f) {
+                beacon = false;
+            }
+        }
+        
+        if (beacon && (counter > 1)) beacons.push_back(points[i]);
+    }
+    
+    for (size_t i = 1; i < points.size()-1; i++) {
+        
+        if (points[i].distance() <= 3.0f) {
+            
+            bool nearbyPointFound = false;
+            for (size_t j = i+1; j < points.size(); j++) {
+                if (fabs(points[j].distance()-points[i].distance()) <= 0.1f) {
+                    nearbyPointFound = true;
+                    break;
+                }
+            }
+            
+            if (nearbyPointFound) {
+                bool isolated = true;
+                for (size_t j = 0; j < points.size(); j++) {
+                    if ((j != i) && (fabs(points[j].distance()-points[i].distance()) <= 0.1f)) {
+                        isolated = false;
+                        break;
+                    }
+                    if ((j != i) && (fabs(points[j].distance()-points[i].distance()) > 0.5f)) {
+                        isolated = false;
+                        break;
+                    }
+                }
+                if (isolated) beacons.push_back(points[i]);
+            }
+        }
+    }
+    
+    return beacons;
+}
+
+/**
+ * Gets the beacons in a scan with the single pass of <code>getBeacons()</code>, but on the
+ * <code>deque</code> of points that the previous implementation built for every scan. That
+ * implementation built this <code>deque</code> twice, in <code>getScan()</code> and again in
+ * <code>getBeacons()</code>, and every point calculated its coordinates with cos and sin.
+ */
+static deque<Beacon> getBeaconsFromDeque(Scan& scan) {
+    
+    deque<Point> points;
+    for (unsigned short i = 0; i < scan.size; i++) points.push_back(Point(scan.r[i], scan.alpha[i]));
+    
+    deque<Point> copy;
+    for (unsigned short i = 0; i < scan.size; i++) copy.push_back(Point(scan.r[i], scan.alpha[i]));
+    
+    deque<Beacon> beacons;
+    
+    unsigned short size = points.size();
+    
+    unsigned short start = 0;
+    for (unsigned short i = 0; i < size; i++) {
+        if (fabs(points[i].r-points[(i+size-1)%size].r) > 0.1f) {
+            start = i;
+            break;
+        }
+    }
+    
+    unsigned short first = start;
+    
+    for (unsigned short k = 1; k <= size; k++) {
+        
+        unsigned short i = (start+k)%size;
+        unsigned short previous = (i+size-1)%size;
+        
+        if ((k == size) || (fabs(points[i].r-points[previous].r) > 0.1f)) {
+            
+            unsigned short last = previous;
+            unsigned short count = (last+size-first)%size+1;
+            
+            float rangeBefore = points[(first+size-1)%size].r;
+            float rangeAfter = points[(last+1)%size].r;
+            
+            if ((count >= 2) && (count <= 64) && (points[first].r < 3.0f) && (points[last].r < 3.0f)
+                    && (rangeBefore-points[first].r > 0.3f) && (rangeAfter-points[last].r > 0.3f)
+                    && (points[first].distance(points[last]) < 0.15f)) {
+                
+                float x[64];
+                float y[64];
+                
+                for (unsigned short j = 0; j < count; j++) {
+                    x[j] = points[(first+j)%size].x;
+                    y[j] = points[(first+j)%size].y;
+                }
+                
+                Beacon beacon;
+                if (beacon.fit(x, y, count, 0.055f)) beacons.push_back(beacon);
+            }
+            
+            first = i;
+        }
+    }
+    
+    return beacons;
+}
+
+/**
+ * Appends a standard scan measurement frame to the input of a stream.
+ * @param angle the angle of the measurement, given in [1/64 deg].
+ * @param distance the distance of the measurement, given in [1/4 mm].
+ */
+static void appendFrame(TestStream& stream, bool start, unsigned short angle, unsigned short distance) {
+    
+    stream.input.push_back((char)((40 << 2) | (start ? 0x01 : 0x02)));
+    stream.input.push_back((char)(((angle & 0x7F) << 1) | 0x01));
+    stream.input.push_back((char)(angle >> 7));
+    stream.input.push_back((char)(distance & 0xFF));
+    stream.input.push_back((char)(distance >> 8));
+}
+
+/**
+ * Tests that the single pass beacon extraction finds the same pipes in the simulated scans
+ * as the quadratic search of the original implementation, and compares their durations.
+ */
+int main() {
+    
+    static TestStream stream;       // without input, this LIDAR object uses its simulated scans
+    static LIDAR lidar(stream);
+    static Scan scan;
+    
+    const unsigned short SCANS = 100;
+    
+    Beacon beacons[16];
+    Beacon reference[3];
+    unsigned short matches[3] = {0, 0, 0};
+    
+    srand(1);
+    
+    for (unsigned short i = 0; i < SCANS; i++) {
+        
+        lidar.getScan(scan);
+        CHECK(scan.size == 360);
+        
+        unsigned short size = lidar.getBeacons(scan, beacons, 16);
+        if (size != 3) continue;
+        
+        // the pipes are found in the same order and at the same centers in every scan
+        
+        if (i == 0) for (unsigned short k = 0; k < 3; k++) reference[k] = beacons[k];
+        for (unsigned short k = 0; k < 3; k++) CHECK(beacons[k].distance(reference[k]) < 0.05f);
+        
+        // every point that the original search found lies on one of these pipes
+        
+        deque<Point> points = getBeaconPoints(scan);
+        bool found[3] = {false, false, false};
+        
+        for (unsigned short j = 0; j < points.size(); j++) {
+            bool onPipe = false;
+            for (unsigned short k = 0; k < 3; k++) {
+                if (points[j].distance(beacons[k]) < 0.1f) {
+                    onPipe = true;
+                    found[k] = true;
+                }
+            }
+            CHECK(onPipe);
+        }
+        
+        for (unsigned short k = 0; k < 3; k++) if (found[k]) matches[k]++;
+    }
+    
+    // the original search misses a pipe in a few scans because of the simulated noise
+    
+    for (unsigned short k = 0; k < 3; k++) CHECK(matches[k] >= 90);
+    
+    // compare the durations of both searches
+    
+    const unsigned int RUNS = 200;
+    
+    lidar.getScan(scan);
+    
+    unsigned int count = 0;
+    double start = testTime();
+    for (unsigned int i = 0; i < RUNS; i++) count += getBeaconPoints(scan).size();
+    double quadratic = (testTime()-start)/RUNS;
+    
+    start = testTime();
+    for (unsigned int i = 0; i < RUNS; i++) count += lidar.getBeacons(scan, beacons, 16);
+    double segments = (testTime()-start)/RUNS;
+    
+    printf("beacon extraction: %.1f us quadratic search, %.1f us single pass (%u)\n", quadratic*1.0e6, segments*1.0e6, count);
+    
+    // the single pass finds the same beacons in the scan as on the deque of points of the previous implementation
+    
+    for (unsigned short i = 0; i < SCANS; i++) {
+        
+        lidar.getScan(scan);
+        
+        unsigned short size = lidar.getBeacons(scan, beacons, 16);
+        deque<Beacon> previous = getBeaconsFromDeque(scan);
+        
+        CHECK(size == previous.size());
+        
+        for (unsigned short k = 0; (k < size) && (k < previous.size()); k++) {
+            CHECK(beacons[k].distance(previous[k]) < 1.0e-4f);
+        }
+    }
+    
+    // compare the durations of getting a scan with its beacons, with and without a deque of points
+    
+    start = testTime();
+    for (unsigned int i = 0; i < RUNS; i++) {
+        lidar.getScan(scan);
+        count += getBeaconsFromDeque(scan).size();
+    }
+    double deques = (testTime()-start)/RUNS;
+    
+    start = testTime();
+    for (unsigned int i = 0; i < RUNS; i++) {
+        lidar.getScan(scan);
+        count += lidar.getBeacons(scan, beacons, 16);
+    }
+    double buffers = (testTime()-start)/RUNS;
+    
+    printf("scan and beacons: %.1f us with a deque of points, %.1f us with caller buffers (%u)\n", deques*1.0e6, buffers*1.0e6, count);
+    
+    // the measurements of a LIDAR are converted into a scan with the tables of cosines and sines
+    
+    static TestStream lidarStream;
+    static LIDAR lidarWithScanner(lidarStream);
+    
+    const unsigned char DESCRIPTOR[] = {0xA5, 0x5A, 0x05, 0x00, 0x00, 0x40, 0x81};
+    lidarStream.input.insert(lidarStream.input.end(), DESCRIPTOR, DESCRIPTOR+sizeof(DESCRIPTOR));
+    
+    unsigned short angles[400];
+    unsigned short distances[400];
+    
+    for (unsigned short revolution = 0; revolution < 3; revolution++) {
+        for (unsigned short i = 0; i < 400; i++) {
+            if (revolution == 0) {
+                angles[i] = (unsigned short)(i*360*64/400+rand()%32);
+                distances[i] = (i%50 == 0) ? 0 : (unsigned short)(400+rand()%32000);
+            }
+            appendFrame(lidarStream, i == 0, angles[i], distances[i]);
+        }
+    }
+    
+    appendFrame(lidarStream, true, 0, 4000);
+    
+    Thread::run(osPriorityBelowNormal, 1);
+    
+    CHECK(lidarStream.input.empty());
+    CHECK(lidarWithScanner.getRevolution() == 4);
+    CHECK(lidarWithScanner.getSyncErrors() == 0);
+    CHECK(lidarWithScanner.getCheckErrors() == 0);
+    
+    lidarWithScanner.getScan(scan);
+    
+    CHECK(scan.revolution == 4);
+    CHECK(scan.size == 400);
+    
+    double worstError = 0.0;
+    
+    for (unsigned short i = 0; (i < scan.size) && (i < 400); i++) {
+        
+        double alpha = (double)((360*64-angles[i])%(360*64))*3.14159265358979/180.0/64.0;
+        double r = (distances[i] > 0) ? (double)distances[i]/4000.0 : LIDAR::DEFAULT_DISTANCE;
+        
+        CHECK_NEAR(scan.alpha[i], alpha, 1.0e-5);
+        CHECK_NEAR(scan.r[i], r, 1.0e-5);
+        
+        double error = fmax(fabs(scan.x[i]/scan.r[i]-cos(alpha)), fabs(scan.y[i]/scan.r[i]-sin(alpha)));
+        if (error > worstError) worstError = error;
+    }
+    
+    CHECK(worstError < 2.0e-6);
+    
+    // a corrupted angle field that still passes the check bit does not exceed the tables
+    
+    appendFrame(lidarStream, false, 0x7FFF, 4000);
+    appendFrame(lidarStream, true, 0, 4000);
+    
+    Thread::run(osPriorityBelowNormal, 1);
+    
+    lidarWithScanner.getScan(scan);
+    
+    CHECK(scan.size == 2);
+    CHECK_NEAR(scan.alpha[1], (360.0-(0x7FFF%(360*64))/64.0)*3.14159265358979/180.0, 1.0e-5);
+    
+    return TEST_RESULT;
+}
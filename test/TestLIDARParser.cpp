@@ -0,0 +1,348 @@
+/*
+ * TestLIDARParser.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include <vector>
+#include "Test.h"
+#include "LIDARParser.h"
+
+using namespace std;
+
+/**
+ * This is a measurement of the LIDAR, as it is encoded in the byte stream and decoded by the parser.
+ */
+struct Measurement {
+    
+    char            quality;
+    unsigned short  angle;      // given in [1/64 deg]
+    unsigned short  distance;   // given in [1/4 mm]
+    bool            start;
+    
+    bool operator==(const Measurement& measurement) const {
+        
+        return (quality == measurement.quality) && (angle == measurement.angle) && (distance == measurement.distance) && (start == measurement.start);
+    }
+};
+
+static const unsigned char  DESCRIPTOR[] = {0xA5, 0x5A, 0x05, 0x00, 0x00, 0x40, 0x81};
+static const unsigned char  EXPRESS_DESCRIPTOR[] = {0xA5, 0x5A, 0x54, 0x00, 0x00, 0x40, 0x82};
+static const unsigned short PACKET_SIZE = 84;
+static const unsigned short FULL_ANGLE = 360*64;
+
+/**
+ * Creates the measurements of a number of revolutions of a standard scan, with 360 measurements per revolution.
+ */
+static vector<Measurement> createMeasurements(unsigned short revolutions) {
+    
+    vector<Measurement> measurements;
+    
+    for (unsigned short i = 0; i < 360*revolutions; i++) {
+        
+        Measurement measurement;
+        measurement.quality = (char)(10+rand()%54);
+        measurement.angle = (unsigned short)((i%360)*64+rand()%64);
+        measurement.distance = (unsigned short)(400+rand()%32000);
+        measurement.start = (i%360 == 0);
+        
+        measurements.push_back(measurement);
+    }
+    
+    return measurements;
+}
+
+/**
+ * Encodes measurements as the response of a standard scan, with the response descriptor and one frame of 5 bytes per measurement.
+ */
+static vector<unsigned char> encodeFrames(const vector<Measurement>& measurements) {
+    
+    vector<unsigned char> bytes(DESCRIPTOR, DESCRIPTOR+sizeof(DESCRIPTOR));
+    
+    for (unsigned int i = 0; i < measurements.size(); i++) {
+        
+        const Measurement& measurement = measurements[i];
+        
+        bytes.push_back((unsigned char)((measurement.quality << 2) | (measurement.start ? 0x01 : 0x02)));
+        bytes.push_back((unsigned char)(((measurement.angle & 0x7F) << 1) | 0x01));
+        bytes.push_back((unsigned char)(measurement.angle >> 7));
+        bytes.push_back((unsigned char)(measurement.distance & 0xFF));
+        bytes.push_back((unsigned char)(measurement.distance >> 8));
+    }
+    
+    return bytes;
+}
+
+/**
+ * Encodes random express scan packets, with the response descriptor, and calculates the measurements
+ * that the parser must decode from them. The angles of the measurements of a packet are interpolated
+ * up to the start angle of the next packet, so the last packet is not decoded.
+ * @param packets the number of packets.
+ * @param measurements a vector that is filled with the expected measurements.
+ */
+static vector<unsigned char> encodePackets(unsigned short packets, vector<Measurement>& measurements) {
+    
+    vector<unsigned char> bytes(EXPRESS_DESCRIPTOR, EXPRESS_DESCRIPTOR+sizeof(EXPRESS_DESCRIPTOR));
+    
+    // about 32 measurements with 0.5 deg per packet, with a random start angle
+    
+    vector<int> startAngles;
+    for (unsigned short p = 0; p < packets; p++) startAngles.push_back(((p == 0) ? rand()%FULL_ANGLE : startAngles[p-1]+1000+rand()%32)%FULL_ANGLE);
+    
+    measurements.clear();
+    
+    for (unsigned short p = 0; p < packets; p++) {
+        
+        unsigned char packet[PACKET_SIZE];
+        
+        packet[2] = (unsigned char)(startAngles[p] & 0xFF);
+        packet[3] = (unsigned char)((startAngles[p] >> 8) | ((p == 0) ? 0x80 : 0x00));
+        
+        for (unsigned short cabin = 0; cabin < 16; cabin++) {
+            
+            unsigned char* data = &packet[4+5*cabin];
+            data[4] = 0;
+            
+            for (unsigned short j = 0; j < 2; j++) {
+                
+                unsigned short distance = (rand()%8 == 0) ? 0 : (unsigned short)(400+rand()%32000) & 0xFFFC;
+                int offset = rand()%64;     // angle offset of the measurement, given in [1/8 deg]
+                
+                data[2*j] = (unsigned char)((distance | (offset >> 4)) & 0xFF);
+                data[2*j+1] = (unsigned char)(distance >> 8);
+                data[4] |= (unsigned char)((offset & 0x0F) << (4*j));
+                
+                if (p+1 < packets) {
+                    
+                    int difference = (startAngles[p+1]-startAngles[p]+FULL_ANGLE)%FULL_ANGLE;
+                    int i = 2*cabin+j;
+                    double nominal = (double)startAngles[p]+(double)(i*difference)/32.0;
+                    
+                    Measurement measurement;
+                    measurement.quality = (distance > 0) ? 0x2F : 0;
+                    measurement.angle = (unsigned short)(((int)floor(nominal-8.0*offset)+FULL_ANGLE)%FULL_ANGLE);
+                    measurement.distance = distance;
+                    measurement.start = (nominal < FULL_ANGLE) && (nominal+(double)difference/32.0 >= FULL_ANGLE);
+                    
+                    measurements.push_back(measurement);
+                }
+            }
+        }
+        
+        unsigned char checksum = 0;
+        for (unsigned short i = 2; i < PACKET_SIZE; i++) checksum ^= packet[i];
+        
+        packet[0] = 0xA0 | (checksum & 0x0F);
+        packet[1] = 0x50 | (checksum >> 4);
+        
+        bytes.insert(bytes.end(), packet, packet+PACKET_SIZE);
+    }
+    
+    return bytes;
+}
+
+/**
+ * Parses a byte stream and collects all decoded measurements.
+ */
+static vector<Measurement> parse(LIDARParser& parser, const vector<unsigned char>& bytes) {
+    
+    vector<Measurement> measurements;
+    
+    for (unsigned int i = 0; i < bytes.size(); i++) {
+        
+        unsigned short n = parser.parse((char)bytes[i]);
+        
+        for (unsigned short j = 0; j < n; j++) {
+            
+            Measurement measurement;
+            measurement.quality = parser.getQuality(j);
+            measurement.angle = parser.getAngle(j);
+            measurement.distance = parser.getDistance(j);
+            measurement.start = parser.getStart(j);
+            
+            measurements.push_back(measurement);
+        }
+    }
+    
+    return measurements;
+}
+
+/**
+ * Counts the expected measurements that were decoded, in their order, and the decoded measurements that were not expected.
+ */
+static unsigned int match(const vector<Measurement>& expected, const vector<Measurement>& decoded, unsigned int& unexpected) {
+    
+    unsigned int matched = 0;
+    unsigned int j = 0;
+    
+    unexpected = 0;
+    
+    for (unsigned int i = 0; i < decoded.size(); i++) {
+        
+        unsigned int k = j;
+        while ((k < expected.size()) && !(expected[k] == decoded[i])) k++;
+        
+        if (k < expected.size()) {
+            matched++;
+            j = k+1;
+        } else {
+            unexpected++;
+        }
+    }
+    
+    return matched;
+}
+
+/**
+ * Tests the decoding of standard scan frames, and the resynchronization after lost bytes.
+ */
+int main() {
+    
+    srand(1);
+    
+    vector<Measurement> measurements = createMeasurements(4);
+    vector<unsigned char> bytes = encodeFrames(measurements);
+    
+    // a clean stream is decoded completely
+    
+    {
+        LIDARParser parser;
+        
+        vector<Measurement> decoded = parse(parser, bytes);
+        
+        CHECK(decoded == measurements);
+        CHECK(parser.getFrames() == measurements.size());
+        CHECK(parser.getSyncErrors() == 0);
+        CHECK(parser.getCheckErrors() == 0);
+    }
+    
+    // bytes before the response descriptor are discarded, the bytes of the descriptor are not counted as errors
+    
+    {
+        LIDARParser parser;
+        
+        vector<unsigned char> stream(bytes);
+        stream.insert(stream.begin(), {0x00, 0x13, 0xA5});
+        
+        vector<Measurement> decoded = parse(parser, stream);
+        
+        CHECK(decoded == measurements);
+        CHECK(parser.getSyncErrors() == 2);
+        CHECK(parser.getCheckErrors() == 0);
+    }
+    
+    // after a single lost byte at any position, the frames are aligned again within a few frames,
+    // because a misaligned frame only passes the start bits and the check bit by chance
+    
+    unsigned int worstSpan = 0;
+    
+    for (unsigned int i = sizeof(DESCRIPTOR); i < bytes.size(); i++) {
+        
+        LIDARParser parser;
+        
+        vector<unsigned char> stream(bytes);
+        stream.erase(stream.begin()+i);
+        
+        vector<Measurement> decoded = parse(parser, stream);
+        
+        if (i < bytes.size()-5) CHECK(parser.getSyncErrors()+parser.getCheckErrors() > 0);   // a lost byte of the last frame only leaves it incomplete
+        
+        // count the frames from the lost byte to the first frame of the correctly decoded end of the stream
+        
+        unsigned int j = decoded.size();
+        unsigned int k = measurements.size();
+        
+        while ((j > 0) && (k > 0) && (decoded[j-1] == measurements[k-1])) {
+            j--;
+            k--;
+        }
+        
+        unsigned int span = k-(i-sizeof(DESCRIPTOR))/5;
+        if (span > worstSpan) worstSpan = span;
+    }
+    
+    CHECK(worstSpan <= 16);
+    
+    // with many lost bytes, only the measurements around them are lost
+    
+    for (unsigned short run = 0; run < 100; run++) {
+        
+        LIDARParser parser;
+        
+        const unsigned short DROPS = 16;
+        
+        vector<unsigned char> stream(bytes);
+        for (unsigned short i = 0; i < DROPS; i++) stream.erase(stream.begin()+sizeof(DESCRIPTOR)+rand()%(stream.size()-sizeof(DESCRIPTOR)));
+        
+        vector<Measurement> decoded = parse(parser, stream);
+        
+        unsigned int unexpected = 0;
+        unsigned int matched = match(measurements, decoded, unexpected);
+        
+        CHECK(matched+16*DROPS >= measurements.size());
+        CHECK(unexpected <= 16*DROPS);
+    }
+    
+    printf("standard scan: aligned again at most %u frames after a lost byte\n", worstSpan);
+    
+    // a clean stream of express scan packets is decoded completely
+    
+    const unsigned short PACKETS = 100;
+    
+    bytes = encodePackets(PACKETS, measurements);
+    
+    {
+        LIDARParser parser;
+        
+        vector<Measurement> decoded = parse(parser, bytes);
+        
+        CHECK(decoded == measurements);
+        CHECK(parser.getFrames() == PACKETS);
+        CHECK(parser.getSyncErrors() == 0);
+        CHECK(parser.getCheckErrors() == 0);
+        
+        unsigned short starts = 0;
+        for (unsigned int i = 0; i < decoded.size(); i++) if (decoded[i].start) starts++;
+        CHECK(starts >= 4);
+    }
+    
+    // a packet with a corrupted checksum is discarded together with its predecessor, whose angles it would end
+    
+    for (unsigned short p = 1; p < PACKETS-1; p++) {
+        
+        LIDARParser parser;
+        
+        vector<unsigned char> stream(bytes);
+        stream[sizeof(EXPRESS_DESCRIPTOR)+p*PACKET_SIZE+10+rand()%(PACKET_SIZE-10)] ^= 0x04;
+        
+        vector<Measurement> decoded = parse(parser, stream);
+        
+        vector<Measurement> expected(measurements);
+        expected.erase(expected.begin()+32*(p-1), expected.begin()+32*(p+1));
+        
+        CHECK(decoded == expected);
+        CHECK(parser.getFrames() == PACKETS-1);
+        CHECK(parser.getCheckErrors() >= 1);
+    }
+    
+    // after a lost byte, the parser resynchronizes on the sync nibbles of the next packet
+    
+    for (unsigned short p = 1; p < PACKETS-1; p++) {
+        
+        LIDARParser parser;
+        
+        vector<unsigned char> stream(bytes);
+        stream.erase(stream.begin()+sizeof(EXPRESS_DESCRIPTOR)+p*PACKET_SIZE+rand()%PACKET_SIZE);
+        
+        vector<Measurement> decoded = parse(parser, stream);
+        
+        vector<Measurement> expected(measurements);
+        expected.erase(expected.begin()+32*(p-1), expected.begin()+32*(p+1));
+        
+        CHECK(decoded == expected);
+        CHECK(parser.getFrames() == PACKETS-1);
+        CHECK(parser.getSyncErrors()+parser.getCheckErrors() > 0);
+    }
+    
+    return TEST_RESULT;
+}
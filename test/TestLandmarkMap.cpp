@@ -0,0 +1,202 @@
+/*
+ * TestLandmarkMap.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "Test.h"
+#include "LandmarkMap.h"
+
+using namespace std;
+
+static const float  GATE = 9.21f;   // threshold of the squared Mahalanobis distance of the map
+
+/**
+ * Gets a random value between 0 and 1.
+ */
+static float randomValue() {
+    
+    return (float)rand()/(float)RAND_MAX;
+}
+
+/**
+ * Gets the squared Mahalanobis distance of a landmark to a beacon with the same arithmetic as the map.
+ */
+static float mahalanobis(float x, float y, const Matrix<2, 2>& inverse, float landmarkX, float landmarkY) {
+    
+    float dx = landmarkX-x;
+    float dy = landmarkY-y;
+    
+    return dx*(inverse(0, 0)*dx+inverse(0, 1)*dy)+dy*(inverse(1, 0)*dx+inverse(1, 1)*dy);
+}
+
+/**
+ * Associates a beacon with the landmarks of a map by comparing it with every landmark.
+ * @return the index of the associated landmark, or -1 if no landmark is within the gate.
+ */
+static int associate(LandmarkMap& map, float x, float y, const Matrix<2, 2>& covariance) {
+    
+    Matrix<2, 2> inverse;
+    covariance.inverse(inverse);
+    
+    int landmark = -1;
+    float minimum = GATE;
+    
+    for (unsigned int i = 0; i < map.getSize(); i++) {
+        float distance = mahalanobis(x, y, inverse, map.getX(i), map.getY(i));
+        if (distance < minimum) {
+            minimum = distance;
+            landmark = i;
+        }
+    }
+    
+    return landmark;
+}
+
+/**
+ * Tests the association of beacons with the spatial index of the map against a comparison with every landmark.
+ */
+int main() {
+    
+    srand(1);
+    
+    // load a map from a file with comments
+    
+    {
+        const char* filename = "TestLandmarkMap.txt";
+        
+        FILE* file = fopen(filename, "w");
+        fprintf(file, "# landmarks of the test arena\n1.0 2.0\n\n-0.5 3.25\n# end\n");
+        fclose(file);
+        
+        LandmarkMap map;
+        
+        CHECK(!map.load("missing.txt"));
+        CHECK(map.load(filename));
+        CHECK(map.getSize() == 2);
+        
+        int landmark = map.nearest(-0.4f, 3.2f, 0.5f);
+        
+        CHECK(landmark >= 0);
+        CHECK(map.getX(landmark) == -0.5f);
+        CHECK(map.getY(landmark) == 3.25f);
+        CHECK(map.nearest(-0.4f, 2.2f, 0.5f) < 0);
+        
+        remove(filename);
+    }
+    
+    // random maps with one landmark per 4 m2, and beacons with covariances whose gates fit into the maximum search range
+    
+    const unsigned int  SIZES[] = {10, 100, 1000, 10000};
+    const unsigned int  QUERIES = 5000;
+    
+    unsigned int mismatches = 0;
+    
+    printf("landmarks  grid      brute force\n");
+    
+    for (unsigned int s = 0; s < sizeof(SIZES)/sizeof(SIZES[0]); s++) {
+        
+        unsigned int size = SIZES[s];
+        float width = sqrt(4.0f*(float)size);
+        
+        vector<float> xs(size);
+        vector<float> ys(size);
+        
+        for (unsigned int i = 0; i < size; i++) {
+            xs[i] = width*(randomValue()-0.5f);
+            ys[i] = width*(randomValue()-0.5f);
+        }
+        
+        LandmarkMap map;
+        CHECK(map.set(&xs[0], &ys[0], size));
+        CHECK(map.getSize() == size);
+        
+        vector<float> x(QUERIES);
+        vector<float> y(QUERIES);
+        vector<Matrix<2, 2> > covariances(QUERIES);
+        
+        for (unsigned int q = 0; q < QUERIES; q++) {
+            
+            // half of the beacons are measured near a landmark
+            
+            unsigned int i = rand()%size;
+            
+            x[q] = (q%2 == 0) ? map.getX(i)+0.3f*(randomValue()-0.5f) : width*(randomValue()-0.5f);
+            y[q] = (q%2 == 0) ? map.getY(i)+0.3f*(randomValue()-0.5f) : width*(randomValue()-0.5f);
+            
+            float sigmaX = 0.02f+0.3f*randomValue();
+            float sigmaY = 0.02f+0.3f*randomValue();
+            float correlation = 1.8f*(randomValue()-0.5f);
+            
+            covariances[q](0, 0) = sigmaX*sigmaX;
+            covariances[q](0, 1) = correlation*sigmaX*sigmaY;
+            covariances[q](1, 0) = correlation*sigmaX*sigmaY;
+            covariances[q](1, 1) = sigmaY*sigmaY;
+        }
+        
+        // compare the associations, the nearest landmarks and the sorted candidates
+        
+        for (unsigned int q = 0; q < QUERIES; q++) {
+            
+            float distance = 0.0f;
+            int landmark = map.associate(x[q], y[q], covariances[q], distance);
+            
+            if (landmark != associate(map, x[q], y[q], covariances[q])) mismatches++;
+            
+            int nearest = -1;
+            float minimum = 0.8f*0.8f;
+            for (unsigned int i = 0; i < size; i++) {
+                float d = (map.getX(i)-x[q])*(map.getX(i)-x[q])+(map.getY(i)-y[q])*(map.getY(i)-y[q]);
+                if (d <= minimum) {
+                    minimum = d;
+                    nearest = i;
+                }
+            }
+            
+            CHECK(map.nearest(x[q], y[q], 0.8f) == nearest);
+            
+            int landmarks[4];
+            float distances[4];
+            unsigned short count = map.candidates(x[q], y[q], covariances[q], landmarks, distances, 4);
+            
+            Matrix<2, 2> inverse;
+            covariances[q].inverse(inverse);
+            
+            unsigned short compatible = 0;
+            for (unsigned int i = 0; i < size; i++) if (mahalanobis(x[q], y[q], inverse, map.getX(i), map.getY(i)) < GATE) compatible++;
+            
+            CHECK(count == ((compatible < 4) ? compatible : 4));
+            
+            for (unsigned short k = 0; k < count; k++) {
+                CHECK(distances[k] == mahalanobis(x[q], y[q], inverse, map.getX(landmarks[k]), map.getY(landmarks[k])));
+                if (k > 0) CHECK(distances[k-1] <= distances[k]);
+            }
+            
+            if (count > 0) CHECK(landmarks[0] == landmark);
+        }
+        
+        // compare the durations of the associations
+        
+        int sum = 0;
+        
+        double start = testTime();
+        for (unsigned int q = 0; q < QUERIES; q++) {
+            float distance = 0.0f;
+            sum += map.associate(x[q], y[q], covariances[q], distance);
+        }
+        double grid = (testTime()-start)/QUERIES;
+        
+        start = testTime();
+        for (unsigned int q = 0; q < QUERIES; q++) sum += associate(map, x[q], y[q], covariances[q]);
+        double bruteForce = (testTime()-start)/QUERIES;
+        
+        printf("%-9u  %-8.0f  %.0f ns (%d)\n", size, grid*1.0e9, bruteForce*1.0e9, sum);
+    }
+    
+    CHECK(mismatches == 0);
+    
+    return TEST_RESULT;
+}
@@ -0,0 +1,228 @@
+/*
+ * TestMatrix.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include <cmath>
+#include "Test.h"
+#include "Matrix.h"
+#include "ExtendedKalmanFilter.h"
+
+using namespace std;
+
+/**
+ * Gets a random value between -1 and 1.
+ */
+static float randomValue() {
+    
+    return 2.0f*(float)rand()/(float)RAND_MAX-1.0f;
+}
+
+/**
+ * Creates a random matrix.
+ */
+template <unsigned int R, unsigned int C>
+static Matrix<R, C> randomMatrix() {
+    
+    Matrix<R, C> matrix;
+    for (unsigned int i = 0; i < R; i++) for (unsigned int j = 0; j < C; j++) matrix(i, j) = randomValue();
+    
+    return matrix;
+}
+
+/**
+ * Creates a random symmetric, positive definite matrix.
+ */
+template <unsigned int N>
+static Matrix<N, N> randomCovariance() {
+    
+    Matrix<N, N> b = randomMatrix<N, N>();
+    Matrix<N, N> a = b*b.transpose()+Matrix<N, N>::identity()*0.1f;
+    a.symmetrize();
+    
+    return a;
+}
+
+/**
+ * Gets the largest absolute difference of the elements of two matrices.
+ */
+template <unsigned int R, unsigned int C>
+static double difference(const Matrix<R, C>& a, const double b[R][C]) {
+    
+    double result = 0.0;
+    for (unsigned int i = 0; i < R; i++) for (unsigned int j = 0; j < C; j++) result = fmax(result, fabs(a(i, j)-b[i][j]));
+    
+    return result;
+}
+
+/**
+ * Tests the inverse of a square matrix, the product with its inverse must be the identity.
+ */
+template <unsigned int N>
+static void testInverse(const Matrix<N, N>& a) {
+    
+    Matrix<N, N> inverse;
+    CHECK(a.inverse(inverse));
+    
+    Matrix<N, N> product = a*inverse;
+    
+    double identity[N][N];
+    for (unsigned int i = 0; i < N; i++) for (unsigned int j = 0; j < N; j++) identity[i][j] = (i == j) ? 1.0 : 0.0;
+    
+    CHECK(difference(product, identity) < 1.0e-4);
+}
+
+/**
+ * Tests the update of the extended Kalman filter against the generic equations in double precision.
+ */
+template <unsigned int N, unsigned int M>
+static void testUpdate() {
+    
+    ExtendedKalmanFilter<N, M> filter;
+    filter.x = randomMatrix<N, 1>();
+    filter.p = randomCovariance<N>();
+    
+    Matrix<M, 1> innovation = randomMatrix<M, 1>();
+    Matrix<M, N> h = randomMatrix<M, N>();
+    Matrix<M, M> r = randomCovariance<M>();
+    
+    // calculate the reference with K = P*H'*(H*P*H'+R)^-1, x = x+K*innovation and P = P-K*H*P
+    
+    double ph[N][M] = {{0.0}};
+    for (unsigned int i = 0; i < N; i++) for (unsigned int j = 0; j < M; j++) for (unsigned int k = 0; k < N; k++) ph[i][j] += filter.p(i, k)*h(j, k);
+    
+    Matrix<M, M> s;
+    for (unsigned int i = 0; i < M; i++) {
+        for (unsigned int j = 0; j < M; j++) {
+            double sum = r(i, j);
+            for (unsigned int k = 0; k < N; k++) sum += h(i, k)*ph[k][j];
+            s(i, j) = (float)sum;
+        }
+    }
+    
+    Matrix<M, M> inverse;
+    CHECK(s.inverse(inverse));
+    
+    double k[N][M] = {{0.0}};
+    for (unsigned int i = 0; i < N; i++) for (unsigned int j = 0; j < M; j++) for (unsigned int l = 0; l < M; l++) k[i][j] += ph[i][l]*inverse(l, j);
+    
+    double x[N][1];
+    for (unsigned int i = 0; i < N; i++) {
+        x[i][0] = filter.x(i, 0);
+        for (unsigned int j = 0; j < M; j++) x[i][0] += k[i][j]*innovation(j, 0);
+    }
+    
+    double p[N][N];
+    for (unsigned int i = 0; i < N; i++) {
+        for (unsigned int j = 0; j < N; j++) {
+            p[i][j] = filter.p(i, j);
+            for (unsigned int l = 0; l < M; l++) p[i][j] -= k[i][l]*ph[j][l];
+        }
+    }
+    
+    CHECK(filter.update(innovation, h, r));
+    
+    CHECK(difference(filter.x, x) < 1.0e-4);
+    CHECK(difference(filter.p, p) < 1.0e-4);
+    
+    for (unsigned int i = 0; i < N; i++) for (unsigned int j = 0; j < N; j++) CHECK(filter.p(i, j) == filter.p(j, i));
+}
+
+/**
+ * Tests the matrix operations and the extended Kalman filter.
+ */
+int main() {
+    
+    srand(1);
+    
+    for (unsigned short run = 0; run < 1000; run++) {
+        
+        // products and transposes
+        
+        Matrix<2, 3> a = randomMatrix<2, 3>();
+        Matrix<3, 4> b = randomMatrix<3, 4>();
+        Matrix<2, 4> c = a*b;
+        
+        double product[2][4] = {{0.0}};
+        for (int i = 0; i < 2; i++) for (int j = 0; j < 4; j++) for (int k = 0; k < 3; k++) product[i][j] += (double)a(i, k)*b(k, j);
+        
+        CHECK(difference(c, product) < 1.0e-6);
+        
+        Matrix<4, 2> transpose = (a*b).transpose();
+        for (int i = 0; i < 2; i++) for (int j = 0; j < 4; j++) CHECK(transpose(j, i) == c(i, j));
+        
+        Matrix<2, 3> sum = a+a*2.0f-a;
+        for (int i = 0; i < 2; i++) for (int j = 0; j < 3; j++) CHECK_NEAR(sum(i, j), 2.0f*a(i, j), 1.0e-6);
+        
+        // inverses with the adjugate, of general matrices, and with a Cholesky decomposition
+        
+        testInverse(randomMatrix<1, 1>()+Matrix<1, 1>::identity()*2.0f);
+        testInverse(randomMatrix<2, 2>()+Matrix<2, 2>::identity()*3.0f);
+        testInverse(randomMatrix<3, 3>()+Matrix<3, 3>::identity()*4.0f);
+        testInverse(randomCovariance<4>());
+        testInverse(randomCovariance<6>());
+        
+        // Cholesky decomposition
+        
+        Matrix<5, 5> covariance = randomCovariance<5>();
+        Matrix<5, 5> l;
+        CHECK(covariance.cholesky(l));
+        
+        double original[5][5];
+        for (int i = 0; i < 5; i++) for (int j = 0; j < 5; j++) original[i][j] = covariance(i, j);
+        
+        CHECK(difference(l*l.transpose(), original) < 1.0e-5);
+        for (int i = 0; i < 5; i++) for (int j = i+1; j < 5; j++) CHECK(l(i, j) == 0.0f);
+        
+        // prediction and update of the extended Kalman filter
+        
+        ExtendedKalmanFilter<3, 2> filter;
+        filter.p = randomCovariance<3>();
+        
+        Matrix<3, 3> f = randomMatrix<3, 3>();
+        Matrix<3, 3> q = randomCovariance<3>();
+        
+        double prediction[3][3];
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                prediction[i][j] = q(i, j);
+                for (int k = 0; k < 3; k++) for (int m = 0; m < 3; m++) prediction[i][j] += (double)f(i, k)*filter.p(k, m)*f(j, m);
+            }
+        }
+        
+        filter.predict(f, q);
+        
+        CHECK(difference(filter.p, prediction) < 1.0e-5);
+        
+        testUpdate<3, 1>();
+        testUpdate<3, 2>();
+        testUpdate<2, 2>();
+        testUpdate<6, 3>();
+    }
+    
+    // singular matrices are not inverted, and a singular innovation covariance is not applied
+    
+    Matrix<2, 2> singular;
+    singular(0, 0) = 1.0f;
+    singular(0, 1) = 2.0f;
+    singular(1, 0) = 2.0f;
+    singular(1, 1) = 4.0f;
+    
+    Matrix<2, 2> inverse;
+    CHECK(!singular.inverse(inverse));
+    
+    Matrix<4, 4> zero;
+    Matrix<4, 4> l;
+    CHECK(!zero.cholesky(l));
+    
+    ExtendedKalmanFilter<3, 2> filter;
+    filter.x(0, 0) = 1.0f;
+    
+    bool updated = filter.update(Matrix<2, 1>(), Matrix<2, 3>(), Matrix<2, 2>());
+    
+    CHECK(!updated);
+    CHECK(filter.x(0, 0) == 1.0f);
+    
+    return TEST_RESULT;
+}
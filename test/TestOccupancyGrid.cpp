@@ -0,0 +1,180 @@
+/*
+ * TestOccupancyGrid.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include "Test.h"
+#include "OccupancyGrid.h"
+#include "LIDAR.h"
+
+using namespace std;
+
+static const double PI = 3.14159265358979323846;
+static const float  CELL = OccupancyGrid::RESOLUTION;   // width of a cell, given in [m]
+
+/**
+ * Fills a scan with a single point, given in the coordinates of the robot.
+ */
+static void setPoint(Scan& scan, float r, float alpha) {
+    
+    scan.clear();
+    scan.add(r, alpha, cos(alpha), sin(alpha), 0);
+}
+
+/**
+ * Gets the log-odds of the cell with a given column and row.
+ */
+static int getCell(OccupancyGrid& grid, int column, int row) {
+    
+    return grid.getLogOdds(((float)column+0.5f)*CELL, ((float)row+0.5f)*CELL);
+}
+
+/**
+ * Reads all dirty tiles of a grid, which clears their dirty flags.
+ * @return the number of cells of the dirty tiles that are not unknown.
+ */
+static unsigned int readDirtyTiles(OccupancyGrid& grid) {
+    
+    unsigned short tiles[OccupancyGrid::TILES*OccupancyGrid::TILES];
+    unsigned short size = grid.getDirtyTiles(tiles, OccupancyGrid::TILES*OccupancyGrid::TILES);
+    
+    unsigned int known = 0;
+    
+    for (unsigned short i = 0; i < size; i++) {
+        
+        int8_t cells[OccupancyGrid::TILE_CELLS];
+        grid.getTile(tiles[i], cells);
+        
+        for (unsigned short j = 0; j < OccupancyGrid::TILE_CELLS; j++) if (cells[j] != 0) known++;
+    }
+    
+    return known;
+}
+
+/**
+ * Tests the update of the occupancy grid with rays of synthetic scans, and the dirty tiles.
+ */
+int main() {
+    
+    static Scan scan;
+    unsigned short tiles[OccupancyGrid::TILES*OccupancyGrid::TILES];
+    
+    // a new grid is unknown, and all of its tiles are dirty until they were read
+    
+    OccupancyGrid grid(0.0f, 0.0f);
+    
+    CHECK(grid.getDirtyTiles(tiles, OccupancyGrid::TILES*OccupancyGrid::TILES) == OccupancyGrid::TILES*OccupancyGrid::TILES);
+    CHECK(readDirtyTiles(grid) == 0);
+    CHECK(grid.getDirtyTiles(tiles, OccupancyGrid::TILES*OccupancyGrid::TILES) == 0);
+    
+    // a robot in the cell (20, 20) sees a point 1 m ahead in the cell (40, 20): the cells before
+    // the point are free, and the cell of the point is occupied
+    
+    setPoint(scan, 1.0f, 0.0f);
+    grid.update(scan, 20.5f*CELL, 20.5f*CELL, 0.0f);
+    
+    for (int column = 20; column < 40; column++) CHECK(getCell(grid, column, 20) == -5);
+    
+    CHECK(getCell(grid, 40, 20) == 20);
+    CHECK(getCell(grid, 41, 20) == 0);
+    CHECK(getCell(grid, 19, 20) == 0);
+    CHECK(getCell(grid, 30, 19) == 0);
+    CHECK(getCell(grid, 30, 21) == 0);
+    
+    // only the 2 tiles of the ray are dirty, and reading a tile clears its dirty flag
+    
+    CHECK(grid.getDirtyTiles(tiles, OccupancyGrid::TILES*OccupancyGrid::TILES) == 2);
+    CHECK((tiles[0] == 1*OccupancyGrid::TILES+1) && (tiles[1] == 1*OccupancyGrid::TILES+2));
+    
+    int8_t cells[OccupancyGrid::TILE_CELLS];
+    grid.getTile(tiles[0], cells);
+    
+    CHECK(cells[4*OccupancyGrid::TILE_SIZE+3] == 0);
+    CHECK(cells[4*OccupancyGrid::TILE_SIZE+4] == -5);
+    CHECK(cells[4*OccupancyGrid::TILE_SIZE+15] == -5);
+    CHECK(cells[5*OccupancyGrid::TILE_SIZE+4] == 0);
+    CHECK(grid.getDirtyTiles(tiles, OccupancyGrid::TILES*OccupancyGrid::TILES) == 1);
+    CHECK(tiles[0] == 1*OccupancyGrid::TILES+2);
+    
+    grid.getTile(tiles[0], cells);
+    
+    CHECK(cells[4*OccupancyGrid::TILE_SIZE+7] == -5);
+    CHECK(cells[4*OccupancyGrid::TILE_SIZE+8] == 20);
+    CHECK(grid.getDirtyTiles(tiles, OccupancyGrid::TILES*OccupancyGrid::TILES) == 0);
+    
+    // repeated updates saturate the log-odds at their limits, and a saturated cell no longer marks its tile as dirty
+    
+    CHECK(!grid.isOccupied(40.5f*CELL, 20.5f*CELL));
+    
+    for (int i = 0; i < 30; i++) grid.update(scan, 20.5f*CELL, 20.5f*CELL, 0.0f);
+    
+    CHECK(getCell(grid, 40, 20) == 100);
+    CHECK(getCell(grid, 20, 20) == -100);
+    CHECK(getCell(grid, 39, 20) == -100);
+    CHECK(grid.isOccupied(40.5f*CELL, 20.5f*CELL));
+    CHECK(!grid.isOccupied(30.5f*CELL, 20.5f*CELL));
+    CHECK(readDirtyTiles(grid) == 21);
+    
+    grid.update(scan, 20.5f*CELL, 20.5f*CELL, 0.0f);
+    
+    CHECK(grid.getDirtyTiles(tiles, OccupancyGrid::TILES*OccupancyGrid::TILES) == 0);
+    
+    // points without a valid measurement are skipped, and rays beyond the maximum range are shortened to 6 m,
+    // i.e. 120 cells, without an occupied cell at their end
+    
+    grid.clear();
+    readDirtyTiles(grid);
+    
+    setPoint(scan, LIDAR::DEFAULT_DISTANCE, 0.5f);
+    grid.update(scan, 20.5f*CELL, 20.5f*CELL, 0.0f);
+    
+    CHECK(grid.getDirtyTiles(tiles, OccupancyGrid::TILES*OccupancyGrid::TILES) == 0);
+    
+    setPoint(scan, 8.0f, 0.0f);
+    grid.update(scan, 20.5f*CELL, 20.5f*CELL, 0.0f);
+    
+    CHECK(getCell(grid, 139, 20) == -5);
+    CHECK(getCell(grid, 140, 20) == -5);
+    CHECK(getCell(grid, 141, 20) == 0);
+    CHECK(readDirtyTiles(grid) == 121);
+    
+    // rays that leave the grid stop at its border, along a row and on a diagonal, and
+    // change no other cells
+    
+    grid.clear();
+    readDirtyTiles(grid);
+    
+    setPoint(scan, 2.0f, 0.0f);
+    grid.update(scan, 10.5f*CELL, 128.5f*CELL, PI);
+    
+    CHECK(getCell(grid, 0, 128) == -5);
+    CHECK(getCell(grid, 10, 128) == -5);
+    CHECK(getCell(grid, 11, 128) == 0);
+    CHECK(grid.getDirtyTiles(tiles, OccupancyGrid::TILES*OccupancyGrid::TILES) == 1);
+    CHECK(tiles[0] == 8*OccupancyGrid::TILES+0);
+    CHECK(readDirtyTiles(grid) == 11);
+    
+    setPoint(scan, 4.0f, 0.25f*PI);
+    grid.update(scan, 250.5f*CELL, 250.5f*CELL, 0.0f);
+    
+    for (int i = 250; i < 256; i++) CHECK(getCell(grid, i, i) == -5);
+    
+    CHECK(grid.getDirtyTiles(tiles, OccupancyGrid::TILES*OccupancyGrid::TILES) == 1);
+    CHECK(tiles[0] == OccupancyGrid::TILES*OccupancyGrid::TILES-1);
+    CHECK(readDirtyTiles(grid) == 6);
+    
+    // a robot outside of the grid does not change the grid at all
+    
+    setPoint(scan, 1.0f, 0.0f);
+    grid.update(scan, -0.5f, 1.0f, 0.0f);
+    grid.update(scan, 1.0f, 256.0f*CELL, 0.0f);
+    
+    CHECK(grid.getDirtyTiles(tiles, OccupancyGrid::TILES*OccupancyGrid::TILES) == 0);
+    
+    printf("occupancy grid: %u tiles of %u cells with a resolution of %.2f m\n", OccupancyGrid::TILES*OccupancyGrid::TILES, OccupancyGrid::TILE_CELLS, CELL);
+    
+    return TEST_RESULT;
+}
@@ -0,0 +1,167 @@
+/*
+ * TestParticleFilter.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include "Test.h"
+#include "ParticleFilter.h"
+
+using namespace std;
+
+static const double PI = 3.14159265358979323846;
+static const float  RANGE = 5.0f;           // range of the simulated LIDAR, given in [m]
+static const float  SIGMA_BEACON = 0.02f;   // standard deviation of the simulated beacons, given in [m]
+
+/**
+ * Gets a random value with a standard deviation of about 1, from a sum of uniform random values.
+ */
+static float randomNoise() {
+    
+    float sum = 0.0f;
+    for (int i = 0; i < 12; i++) sum += (float)rand()/(float)RAND_MAX;
+    
+    return sum-6.0f;
+}
+
+/**
+ * Simulates the beacons of the landmarks within the range of the LIDAR, seen from a given pose.
+ * @return the number of beacons.
+ */
+static unsigned short createBeacons(LandmarkMap& map, float x, float y, float alpha, Beacon beacons[]) {
+    
+    unsigned short size = 0;
+    
+    for (unsigned int i = 0; i < map.getSize(); i++) {
+        
+        float dx = map.getX(i)-x;
+        float dy = map.getY(i)-y;
+        
+        if (dx*dx+dy*dy > RANGE*RANGE) continue;
+        
+        beacons[size].x = cos(alpha)*dx+sin(alpha)*dy+SIGMA_BEACON*randomNoise();
+        beacons[size].y = -sin(alpha)*dx+cos(alpha)*dy+SIGMA_BEACON*randomNoise();
+        size++;
+    }
+    
+    return size;
+}
+
+/**
+ * Drives the robot on a circle and updates the particle filter with the odometry and the simulated beacons of
+ * every scan. The odometry starts at its own origin, and it has a small error in every scan.
+ * @return the number of the update, after which the particles converged, or 0 if they did not converge.
+ */
+static unsigned int drive(ParticleFilter& particleFilter, LandmarkMap& map, float& x, float& y, float& alpha, float& odometryX, float& odometryY, float& odometryAlpha, unsigned int updates) {
+    
+    unsigned int converged = 0;
+    
+    for (unsigned int update = 1; update <= updates; update++) {
+        
+        // move forward by 5 cm and turn by 0.02 rad per scan, in the true and in the odometry coordinates
+        
+        float translation = 0.05f;
+        float rotation = 0.02f;
+        
+        x += translation*cos(alpha);
+        y += translation*sin(alpha);
+        alpha = remainder(alpha+rotation, 2.0*PI);
+        
+        translation += 0.002f*randomNoise();
+        rotation += 0.002f*randomNoise();
+        
+        odometryX += translation*cos(odometryAlpha);
+        odometryY += translation*sin(odometryAlpha);
+        odometryAlpha = remainder(odometryAlpha+rotation, 2.0*PI);
+        
+        Beacon beacons[8];
+        unsigned short size = createBeacons(map, x, y, alpha, beacons);
+        
+        particleFilter.update(odometryX, odometryY, odometryAlpha, beacons, size);
+        
+        // the particles are either resampled to equal weights, or their effective number stays above the half
+        
+        float effectiveParticles = particleFilter.getEffectiveParticles();
+        
+        CHECK(effectiveParticles >= 0.5f*ParticleFilter::PARTICLES);
+        CHECK(effectiveParticles <= 1.001f*ParticleFilter::PARTICLES);
+        
+        if ((converged == 0) && particleFilter.isConverged()) converged = update;
+    }
+    
+    return converged;
+}
+
+/**
+ * Tests the global localization of the particle filter with simulated beacons, and after the robot was kidnapped.
+ */
+int main() {
+    
+    srand(1);
+    
+    // 4 pipes in an arena without symmetries, because a particle filter cannot tell symmetric poses apart
+    
+    const float xs[] = {0.0f, 3.0f, 2.2f, -0.3f};
+    const float ys[] = {0.0f, 0.4f, 2.5f, 1.8f};
+    
+    LandmarkMap map;
+    map.set(xs, ys, 4);
+    
+    ParticleFilter particleFilter(map);
+    
+    CHECK(!particleFilter.isConverged());
+    
+    // the first scan spreads the particles with the beacons, and resamples them after weighting
+    
+    float x = 1.0f, y = 1.0f, alpha = 0.5f;
+    float odometryX = 0.0f, odometryY = 0.0f, odometryAlpha = 0.0f;
+    
+    Beacon beacons[8];
+    unsigned short size = createBeacons(map, x, y, alpha, beacons);
+    
+    particleFilter.update(odometryX, odometryY, odometryAlpha, beacons, size);
+    
+    CHECK_NEAR(particleFilter.getEffectiveParticles(), ParticleFilter::PARTICLES, 0.01*ParticleFilter::PARTICLES);
+    
+    // the particles converge to the true pose while the robot drives
+    
+    unsigned int converged = drive(particleFilter, map, x, y, alpha, odometryX, odometryY, odometryAlpha, 40);
+    
+    CHECK(converged > 0);
+    CHECK(particleFilter.isConverged());
+    CHECK_NEAR(particleFilter.getX(), x, 0.1);
+    CHECK_NEAR(particleFilter.getY(), y, 0.1);
+    CHECK_NEAR(remainder(particleFilter.getAlpha()-alpha, 2.0*PI), 0.0, 0.05);
+    
+    Matrix<3, 3> p = particleFilter.getCovariance();
+    
+    CHECK((p(0, 0) > 0.0f) && (p(0, 0) < 0.01f));
+    CHECK((p(1, 1) > 0.0f) && (p(1, 1) < 0.01f));
+    CHECK((p(2, 2) > 0.0f) && (p(2, 2) < 0.01f));
+    
+    printf("converged after %u scans: error %.3f m, %.3f m, %.3f rad\n", converged, particleFilter.getX()-x, particleFilter.getY()-y, remainder(particleFilter.getAlpha()-alpha, 2.0*PI));
+    
+    // the robot is kidnapped, the odometry does not notice it, and the filter is reset for a new global localization
+    
+    x = 2.0f;
+    y = -0.5f;
+    alpha = 2.5f;
+    
+    particleFilter.reset();
+    
+    CHECK(!particleFilter.isConverged());
+    
+    converged = drive(particleFilter, map, x, y, alpha, odometryX, odometryY, odometryAlpha, 40);
+    
+    CHECK(converged > 0);
+    CHECK(particleFilter.isConverged());
+    CHECK_NEAR(particleFilter.getX(), x, 0.1);
+    CHECK_NEAR(particleFilter.getY(), y, 0.1);
+    CHECK_NEAR(remainder(particleFilter.getAlpha()-alpha, 2.0*PI), 0.0, 0.05);
+    
+    printf("converged again after %u scans: error %.3f m, %.3f m, %.3f rad\n", converged, particleFilter.getX()-x, particleFilter.getY()-y, remainder(particleFilter.getAlpha()-alpha, 2.0*PI));
+    
+    return TEST_RESULT;
+}
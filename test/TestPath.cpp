@@ -0,0 +1,197 @@
+/*
+ * TestPath.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include "Test.h"
+#include "Path.h"
+#include "TaskFollowPath.h"
+
+using namespace std;
+
+static const float  VELOCITY = 0.2f;                // limits of the route of the state machine, with a lower lateral
+static const float  ACCELERATION = 0.2f;            // acceleration, so that the curves of the route limit the velocity
+static const float  LATERAL_ACCELERATION = 0.1f;
+
+/**
+ * Searches the point of a path that is closest to a given position, with a search over the whole path.
+ */
+static unsigned int findClosestPoint(Path& path, float x, float y) {
+    
+    unsigned int closest = 0;
+    float closestDistance = 1.0e9f;
+    
+    for (unsigned int i = 0; i < path.getSize(); i++) {
+        float distance = (path.getX(i)-x)*(path.getX(i)-x)+(path.getY(i)-y)*(path.getY(i)-y);
+        if (distance < closestDistance) {
+            closest = i;
+            closestDistance = distance;
+        }
+    }
+    
+    return closest;
+}
+
+/**
+ * Sets the pose of the controller, and runs it for one period, so that the pose is published.
+ */
+static void setPose(Controller& controller, float x, float y, float alpha) {
+    
+    controller.setPose(x, y, alpha, Matrix<3, 3>::identity()*0.001f);
+    Thread::run(osPriorityHigh, 1);
+}
+
+/**
+ * Tests the incremental searches and the velocity profile of a path, and the end of the task that follows a path.
+ */
+int main() {
+    
+    // a straight path of 1 m has 32 segments of about 3 cm
+    
+    const float lineX[] = {0.0f, 1.0f};
+    const float lineY[] = {0.0f, 0.0f};
+    
+    Path line;
+    
+    CHECK(line.compile(lineX, lineY, 2, false));
+    CHECK(line.getSize() == 33);
+    CHECK_NEAR(line.getLength(), 1.0, 1.0e-5);
+    
+    // the incremental search of the closest point follows a robot that moves along the path, and finds
+    // the same point as a search over the whole path, but it never moves backwards
+    
+    unsigned int index = 0;
+    
+    for (float x = 0.0f; x <= 1.0f; x += 0.01f) {
+        
+        unsigned int next = line.findClosestPoint(x, 0.05f, index);
+        
+        CHECK(next >= index);
+        CHECK(next == findClosestPoint(line, x, 0.05f));
+        
+        index = next;
+    }
+    
+    CHECK(index == line.getSize()-1);
+    CHECK(line.findClosestPoint(0.0f, 0.0f, 20) == 20);
+    CHECK(line.findClosestPoint(0.5f, 0.0f, 100) == line.getSize()-1);
+    
+    // the incremental search of a point with a given arc length resumes from the previous index
+    
+    index = 0;
+    
+    for (float distance = 0.0f; distance <= 1.2f; distance += 0.01f) {
+        
+        unsigned int next = line.findPoint(distance, index);
+        
+        CHECK(next >= index);
+        CHECK((line.getDistance(next) >= distance) || (next == line.getSize()-1));
+        CHECK((next == 0) || (line.getDistance(next-1) < distance));
+        
+        index = next;
+    }
+    
+    CHECK(index == line.getSize()-1);
+    CHECK(line.findPoint(0.1f, 20) == 20);
+    
+    // a lap of the route ends at its start: the incremental search stays at the end of the lap,
+    // where a search over the whole path would jump back to its start
+    
+    const float xs[] = {0.0f, 2.0f, 2.5f, 2.0f, 0.0f, -0.5f, 0.0f};
+    const float ys[] = {0.0f, 0.0f, 0.5f, 1.0f, 1.0f, 0.5f, 0.0f};
+    
+    Path path;
+    
+    CHECK(path.compile(xs, ys, 7, true));
+    
+    unsigned int size = path.getSize();
+    
+    index = 0;
+    
+    for (unsigned int i = 0; i < size; i++) {
+        
+        unsigned int next = path.findClosestPoint(path.getX(i), path.getY(i), index);
+        
+        CHECK(next == i);
+        
+        index = next;
+    }
+    
+    CHECK(findClosestPoint(path, path.getX(size-1), path.getY(size-1)) == 0);
+    
+    // the velocity profile is zero at both ends, and keeps the limits of the velocity, the acceleration and the lateral acceleration
+    
+    path.limitVelocity(VELOCITY, ACCELERATION, LATERAL_ACCELERATION);
+    
+    CHECK(path.getVelocity(0) == 0.0f);
+    CHECK(path.getVelocity(size-1) == 0.0f);
+    
+    float maximumVelocity = 0.0f;
+    float maximumLateralAcceleration = 0.0f;
+    bool limitedByCurvature = false;
+    
+    for (unsigned int i = 0; i < size; i++) {
+        
+        float velocity = path.getVelocity(i);
+        float lateralAcceleration = velocity*velocity*fabs(path.getCurvature(i));
+        
+        CHECK(velocity <= VELOCITY);
+        CHECK(lateralAcceleration <= LATERAL_ACCELERATION*1.0001f);
+        
+        if (lateralAcceleration > LATERAL_ACCELERATION*0.999f) limitedByCurvature = true;
+        
+        maximumVelocity = fmax(maximumVelocity, velocity);
+        maximumLateralAcceleration = fmax(maximumLateralAcceleration, lateralAcceleration);
+        
+        if (i > 0) {
+            float change = velocity*velocity-path.getVelocity(i-1)*path.getVelocity(i-1);
+            CHECK(fabs(change) <= 2.0f*ACCELERATION*(path.getDistance(i)-path.getDistance(i-1))*1.0001f+1.0e-6f);
+        }
+    }
+    
+    CHECK_NEAR(maximumVelocity, VELOCITY, 1.0e-6);
+    CHECK(limitedByCurvature);
+    
+    printf("velocity profile of %u points: %.3f m/s maximum, %.3f m/s2 lateral acceleration\n", size, maximumVelocity, maximumLateralAcceleration);
+    
+    // the task is done within the zone around the end of the path, or when the robot is beside or past
+    // the end of the path, but not when it is beside the path before its end
+    
+    static PwmOut pwmLeft(PF_9);
+    static PwmOut pwmRight(PF_8);
+    static EncoderCounter counterLeft(PD_12, PD_13);
+    static EncoderCounter counterRight(PB_4, PC_7);
+    static SPI spi(PC_12, PC_11, PC_10);
+    static DigitalOut csAG(PC_8);
+    static DigitalOut csM(PC_9);
+    static IMU imu(spi, csAG, csM);
+    static PoseHistory poseHistory;
+    static Controller controller(pwmLeft, pwmRight, counterLeft, counterRight, imu, poseHistory);
+    
+    line.limitVelocity(VELOCITY, ACCELERATION, LATERAL_ACCELERATION);
+    
+    const float poses[][3] = {{0.5f, 0.0f, 0.0f}, {0.99f, 0.0f, 0.0f}, {0.99f, 0.0f, 0.0f}, {0.99f, 0.3f, 0.0f}, {1.0f, 0.3f, 3.0f}, {1.05f, 0.0f, 3.0f}, {1.3f, -0.2f, 1.0f}};
+    const float zones[] = {0.02f, 0.02f, 0.005f, 0.02f, 0.02f, 0.02f, 0.02f};
+    const int results[] = {Task::RUNNING, Task::DONE, Task::RUNNING, Task::RUNNING, Task::DONE, Task::DONE, Task::DONE};
+    
+    for (unsigned int i = 0; i < 7; i++) {
+        
+        setPose(controller, poses[i][0], poses[i][1], poses[i][2]);
+        
+        TaskFollowPath taskFollowPath(controller, line, LATERAL_ACCELERATION, zones[i]);
+        
+        CHECK(taskFollowPath.run(0.01f) == results[i]);
+    }
+    
+    // an empty path is done at once
+    
+    Path empty;
+    TaskFollowPath taskFollowPath(controller, empty);
+    
+    CHECK(taskFollowPath.run(0.01f) == Task::DONE);
+    
+    return TEST_RESULT;
+}
@@ -0,0 +1,172 @@
+/*
+ * TestScanMatcher.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include "Test.h"
+#include "ScanMatcher.h"
+
+using namespace std;
+
+static const double PI = 3.14159265358979323846;
+static const float  WIDTH = 4.0f;       // width of the rectangular room, given in [m]
+static const float  HEIGHT = 3.0f;      // height of the rectangular room, given in [m]
+static const unsigned short MAXIMUM_ITERATIONS = 10;        // limits of the scan matcher
+static const unsigned short MINIMUM_CORRESPONDENCES = 20;
+
+/**
+ * Gets a random value with a standard deviation of about 1, from a sum of uniform random values.
+ */
+static float randomNoise() {
+    
+    float sum = 0.0f;
+    for (int i = 0; i < 12; i++) sum += (float)rand()/(float)RAND_MAX;
+    
+    return sum-6.0f;
+}
+
+/**
+ * Simulates a scan of the rectangular room with a given number of points over 360 degrees,
+ * seen from a given pose, with noise on the distances.
+ */
+static void createScan(Scan& scan, unsigned short points, float x, float y, float alpha, float noise) {
+    
+    scan.clear();
+    
+    for (unsigned short i = 0; i < points; i++) {
+        
+        float angle = 2.0f*PI*(float)i/(float)points;
+        float cosAngle = cos(alpha+angle);
+        float sinAngle = sin(alpha+angle);
+        
+        // distance to the nearest wall in the direction of this ray
+        
+        float r = 1.0e6f;
+        
+        if (cosAngle > 1.0e-6f) r = fmin(r, (WIDTH-x)/cosAngle);
+        if (cosAngle < -1.0e-6f) r = fmin(r, -x/cosAngle);
+        if (sinAngle > 1.0e-6f) r = fmin(r, (HEIGHT-y)/sinAngle);
+        if (sinAngle < -1.0e-6f) r = fmin(r, -y/sinAngle);
+        
+        r += noise*randomNoise();
+        
+        scan.add(r, angle, cos(angle), sin(angle), 0);
+    }
+}
+
+/**
+ * Tests the alignment of synthetic scans of a rectangular room with the map of its walls.
+ */
+int main() {
+    
+    srand(1);
+    
+    const float x1[] = {0.0f, WIDTH, WIDTH, 0.0f};
+    const float y1[] = {0.0f, 0.0f, HEIGHT, HEIGHT};
+    const float x2[] = {WIDTH, WIDTH, 0.0f, 0.0f};
+    const float y2[] = {0.0f, HEIGHT, HEIGHT, 0.0f};
+    
+    ScanMatcher scanMatcher;
+    
+    CHECK(scanMatcher.set(x1, y1, x2, y2, 4));
+    CHECK(scanMatcher.getSize() == 4);
+    
+    static Scan scan;
+    
+    // a scan from a known pose is aligned from a perturbed initial pose
+    
+    const float trueX = 1.5f, trueY = 1.2f, trueAlpha = 0.3f;
+    
+    createScan(scan, 720, trueX, trueY, trueAlpha, 0.01f);
+    
+    float x = trueX+0.10f;
+    float y = trueY-0.08f;
+    float alpha = trueAlpha+0.05f;
+    Matrix<3, 3> covariance;
+    
+    CHECK(scanMatcher.match(scan, x, y, alpha, covariance));
+    CHECK_NEAR(x, trueX, 0.01);
+    CHECK_NEAR(y, trueY, 0.01);
+    CHECK_NEAR(alpha, trueAlpha, 0.005);
+    CHECK((covariance(0, 0) > 0.0f) && (covariance(1, 1) > 0.0f) && (covariance(2, 2) > 0.0f));
+    CHECK(scanMatcher.getIterations() > 1);
+    CHECK(scanMatcher.getIterations() <= MAXIMUM_ITERATIONS);
+    CHECK(scanMatcher.getCorrespondences() >= 170);
+    
+    printf("aligned scan: error %.4f m, %.4f m, %.4f rad after %u iterations with %u correspondences\n", x-trueX, y-trueY, alpha-trueAlpha, scanMatcher.getIterations(), scanMatcher.getCorrespondences());
+    
+    // most matches from random initial poses converge to the true pose
+    
+    unsigned int matches = 0;
+    unsigned int aligned = 0;
+    
+    const unsigned int TRIALS = 1000;
+    
+    double start = testTime();
+    
+    for (unsigned int i = 0; i < TRIALS; i++) {
+        
+        x = trueX+0.08f*randomNoise();
+        y = trueY+0.08f*randomNoise();
+        alpha = trueAlpha+0.05f*randomNoise();
+        
+        if (scanMatcher.match(scan, x, y, alpha, covariance)) {
+            matches++;
+            if ((fabs(x-trueX) < 0.01f) && (fabs(y-trueY) < 0.01f) && (fabs(alpha-trueAlpha) < 0.005f)) aligned++;
+        }
+    }
+    
+    double duration = testTime()-start;
+    
+    CHECK(matches > TRIALS*9/10);
+    CHECK(aligned > matches*9/10);
+    
+    printf("random initial poses: %u of %u matches, %u aligned, %.1f us per match\n", matches, TRIALS, aligned, duration/TRIALS*1.0e6);
+    
+    // very noisy scans change the correspondences in every iteration, so that some matches do not converge:
+    // these stop at the maximum number of iterations
+    
+    unsigned int capped = 0;
+    
+    for (unsigned int i = 0; i < 200; i++) {
+        
+        createScan(scan, 720, trueX, trueY, trueAlpha, 0.15f);
+        
+        x = trueX+0.1f*randomNoise();
+        y = trueY+0.1f*randomNoise();
+        alpha = trueAlpha+0.05f*randomNoise();
+        
+        scanMatcher.match(scan, x, y, alpha, covariance);
+        
+        CHECK(scanMatcher.getIterations() <= MAXIMUM_ITERATIONS);
+        
+        if (scanMatcher.getIterations() == MAXIMUM_ITERATIONS) capped++;
+    }
+    
+    CHECK(capped > 0);
+    
+    printf("noisy scans: %u of 200 matches stopped after %u iterations\n", capped, MAXIMUM_ITERATIONS);
+    
+    // a scan with less valid points than the minimum number of correspondences is rejected, and leaves the pose unchanged
+    
+    createScan(scan, MINIMUM_CORRESPONDENCES-1, trueX, trueY, trueAlpha, 0.0f);
+    
+    x = trueX+0.05f;
+    y = trueY;
+    alpha = trueAlpha;
+    
+    CHECK(!scanMatcher.match(scan, x, y, alpha, covariance));
+    CHECK(scanMatcher.getCorrespondences() < MINIMUM_CORRESPONDENCES);
+    CHECK(scanMatcher.getIterations() == 0);
+    CHECK((x == trueX+0.05f) && (y == trueY) && (alpha == trueAlpha));
+    
+    createScan(scan, 4*MINIMUM_CORRESPONDENCES, trueX, trueY, trueAlpha, 0.0f);
+    
+    CHECK(scanMatcher.match(scan, x, y, alpha, covariance));
+    CHECK(scanMatcher.getCorrespondences() >= MINIMUM_CORRESPONDENCES);
+    
+    return TEST_RESULT;
+}
@@ -0,0 +1,147 @@
+/*
+ * TestSensorFusion.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include "Test.h"
+#include "SensorFusion.h"
+
+using namespace std;
+
+static const double PI = 3.14159265358979323846;
+static const float  PERIOD = 0.002f;        // period of the sensor fusion, given in [s]
+static const float  S_Q_ALPHA = 0.000010f;  // standard deviations of the Kalman filter of the sensor fusion
+static const float  S_Q_OMEGA = 0.010000f;
+static const float  S_R_ALPHA = 0.001000f;
+static const float  S_R_OMEGA = 0.000001f;
+
+/**
+ * Gets a random value with a standard deviation of about 1, from a sum of uniform random values.
+ */
+static double randomNoise() {
+    
+    double sum = 0.0;
+    for (int i = 0; i < 12; i++) sum += (double)rand()/(double)RAND_MAX;
+    
+    return sum-6.0;
+}
+
+/**
+ * Writes a 16 bit value into a low and a high register of the simulated IMU.
+ */
+static void setRegister(SPI& spi, int address, double value) {
+    
+    short raw = (short)fmax(-32768.0, fmin(32767.0, round(value)));
+    
+    spi.registers[address] = (uint8_t)(raw & 0xFF);
+    spi.registers[address+1] = (uint8_t)((raw >> 8) & 0xFF);
+}
+
+/**
+ * This is the previous Kalman filter of the tilt angle, with decoupled scalar gains.
+ * It zeroes the cross covariances in every update, and updates p22 with the noise of the angle.
+ */
+class DecoupledFilter {
+    
+    public:
+        
+        float   p11 = 0.0f, p12 = 0.0f, p21 = 0.0f, p22 = 0.0f;
+        float   xAlpha = 0.0f, xOmega = 0.0f;
+        
+        void update(float zAlpha, float zOmega) {
+            
+            xAlpha = xAlpha+PERIOD*xOmega;
+            
+            float p11 = this->p11+this->p12*PERIOD+this->p21*PERIOD+this->p22*PERIOD*PERIOD+S_Q_ALPHA*S_Q_ALPHA;
+            float p12 = this->p12+this->p22*PERIOD;
+            float p21 = this->p21+this->p22*PERIOD;
+            float p22 = this->p22+S_Q_OMEGA*S_Q_OMEGA;
+            
+            this->p11 = p11;
+            this->p12 = p12;
+            this->p21 = p21;
+            this->p22 = p22;
+            
+            float k11 = p11/(p11+S_R_ALPHA*S_R_ALPHA);
+            float k22 = p22/(p22+S_R_OMEGA*S_R_OMEGA);
+            
+            xAlpha = xAlpha+k11*(zAlpha-xAlpha);
+            xOmega = xOmega+k22*(zOmega-xOmega);
+            
+            this->p11 = p11*(1.0f-p11/(p11+S_R_ALPHA*S_R_ALPHA));
+            this->p12 = 0.0f;
+            this->p21 = 0.0f;
+            this->p22 = p22*(1.0f-p22/(p22+S_R_ALPHA*S_R_ALPHA));
+        }
+};
+
+/**
+ * Tests the coupled Kalman filter of the tilt angle against the previous decoupled filter,
+ * with synthetic readings of a simulated IMU.
+ */
+int main() {
+    
+    SPI spi(PC_12, PC_11, PC_10);
+    DigitalOut csAG(PC_8);
+    DigitalOut csM(PC_9);
+    
+    IMU imu(spi, csAG, csM);
+    SensorFusion sensorFusion(imu);
+    
+    DecoupledFilter decoupledFilter;
+    
+    const double ACCELERATION_PER_LSB = 2.0*9.81/32768.0;
+    const double GYRO_PER_LSB = 245.0*PI/180.0/32768.0;
+    
+    // tilt the IMU with a sine of 0.3 rad and 0.5 Hz for 20 s, with noise on the accelerometer and the gyro
+    
+    double errorCoupled = 0.0;
+    double errorDecoupled = 0.0;
+    double worstDifference = 0.0;
+    unsigned int samples = 0;
+    
+    for (unsigned int period = 1; period <= 10000; period++) {
+        
+        double time = period*PERIOD;
+        double tilt = 0.3*sin(2.0*PI*0.5*time);
+        double rotation = 0.3*2.0*PI*0.5*cos(2.0*PI*0.5*time);
+        
+        setRegister(spi, 0x2A, (-9.81*sin(tilt)+0.05*randomNoise())/ACCELERATION_PER_LSB);
+        setRegister(spi, 0x2C, (9.81*cos(tilt)+0.05*randomNoise())/ACCELERATION_PER_LSB);
+        setRegister(spi, 0x18, (rotation+0.005*randomNoise())/GYRO_PER_LSB);
+        
+        Thread::run(osPriorityHigh, 1);
+        
+        decoupledFilter.update(atan2(-imu.readAccelerationY(), imu.readAccelerationZ()), imu.readGyroX());
+        
+        // compare both filters after they settled
+        
+        if (time < 2.0) continue;
+        
+        double coupled = sensorFusion.readTiltAngleK();
+        double decoupled = decoupledFilter.xAlpha;
+        
+        errorCoupled += (coupled-tilt)*(coupled-tilt);
+        errorDecoupled += (decoupled-tilt)*(decoupled-tilt);
+        worstDifference = fmax(worstDifference, fabs(coupled-decoupled));
+        samples++;
+        
+        CHECK_NEAR(sensorFusion.readTiltAngleA(), tilt, 0.03);
+    }
+    
+    errorCoupled = sqrt(errorCoupled/samples);
+    errorDecoupled = sqrt(errorDecoupled/samples);
+    
+    // the coupled update is as accurate as the previous filter, and its estimate differs by less than 0.1 mrad
+    
+    CHECK(errorCoupled < 0.002);
+    CHECK(errorCoupled <= errorDecoupled*1.01);
+    CHECK(worstDifference < 0.0001);
+    
+    printf("tilt angle: %.6f rad rms error coupled, %.6f rad decoupled, largest difference %.6f rad\n", errorCoupled, errorDecoupled, worstDifference);
+    
+    return TEST_RESULT;
+}
@@ -0,0 +1,223 @@
+/*
+ * TestSpeedController.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include "Test.h"
+#include "SpeedController.h"
+#include "RobotProfile.h"
+
+using namespace std;
+
+typedef DefaultRobotProfile Profile;
+
+static const float  MAXIMUM_VOLTAGE = 0.48f/Profile::DUTY_CYCLE_PER_VOLTAGE;   // limit of the voltage of the controller, given in [V]
+
+/**
+ * This is a first order model of a DC motor with a constant load, which slows the motor down
+ * by a given speed at any voltage.
+ */
+class Motor {
+    
+    public:
+        
+        double  kn;             // speed constant, given in [rpm/V]
+        double  timeConstant;   // mechanical time constant, given in [s]
+        double  load;           // loss of speed of the load, given in [rpm]
+        double  speed;          // actual speed, given in [rpm]
+        
+        Motor(double kn, double timeConstant, double load) : kn(kn), timeConstant(timeConstant), load(load), speed(0.0) {}
+        
+        /**
+         * Applies a voltage for one period of the controller, integrated in small steps.
+         */
+        void run(double voltage) {
+            
+            for (int i = 0; i < 10; i++) speed += (kn*voltage-load-speed)/timeConstant*Profile::PERIOD/10.0;
+        }
+};
+
+/**
+ * This is a PI controller with the same feedforward as the speed controller, but without
+ * an anti-windup of the integrator, as a reference.
+ */
+class WindupController {
+    
+    public:
+        
+        float   integral = 0.0f;
+        
+        float control(float desiredSpeed, float actualSpeed) {
+            
+            float error = desiredSpeed-actualSpeed;
+            float voltage = desiredSpeed/Profile::KN+Profile::KP*error+integral;
+            
+            integral += Profile::PERIOD*Profile::KI*error;
+            
+            return fmax(-MAXIMUM_VOLTAGE, fmin(MAXIMUM_VOLTAGE, voltage));
+        }
+};
+
+/**
+ * Creates a speed controller with the gains, the model and the limits of the controller of the robot.
+ */
+static void initialize(SpeedController& speedController) {
+    
+    speedController.setPeriod(Profile::PERIOD);
+    speedController.setGains(Profile::KP, Profile::KI);
+    speedController.setModel(Profile::KN, Profile::TIME_CONSTANT);
+    speedController.setLimits(-MAXIMUM_VOLTAGE, MAXIMUM_VOLTAGE);
+}
+
+/**
+ * Gets the number of periods after a step of the desired speed, until the speed stays within a band around the desired speed.
+ */
+static unsigned int settle(const float speeds[], unsigned int periods, float desiredSpeed, float band) {
+    
+    unsigned int settled = 0;
+    
+    for (unsigned int period = 0; period < periods; period++) {
+        if (fabs(speeds[period]-desiredSpeed) > band) settled = period+1;
+    }
+    
+    return settled;
+}
+
+/**
+ * Tests the speed controller and the identification of the model of the motor with a simulated motor.
+ */
+int main() {
+    
+    // a motor that differs from the model of the controller, with a load: the integrator removes the steady-state error
+    
+    {
+        Motor motor(0.9*Profile::KN, 1.2*Profile::TIME_CONSTANT, 40.0);
+        
+        SpeedController speedController;
+        initialize(speedController);
+        
+        for (unsigned int period = 0; period < 3000; period++) {
+            
+            if (period == 2000) speedController.resetStatistics();
+            
+            motor.run(speedController.control(200.0f, 0.0f, motor.speed));
+        }
+        
+        CHECK_NEAR(motor.speed, 200.0, 0.01);
+        CHECK(fabs(speedController.getErrorMean()) < 0.01f);
+        CHECK(speedController.getErrorMaximum() < 0.05f);
+        
+        // without the integrator, the same motor keeps a large error
+        
+        Motor proportionalMotor(0.9*Profile::KN, 1.2*Profile::TIME_CONSTANT, 40.0);
+        
+        speedController.setGains(Profile::KP, 0.0f);
+        speedController.reset();
+        
+        for (unsigned int period = 0; period < 3000; period++) {
+            proportionalMotor.run(speedController.control(200.0f, 0.0f, proportionalMotor.speed));
+        }
+        
+        CHECK(200.0-proportionalMotor.speed > 5.0);
+        
+        printf("steady-state error: %.4f rpm with integrator, %.1f rpm without\n", 200.0-motor.speed, 200.0-proportionalMotor.speed);
+    }
+    
+    // a desired speed above the reach of the motor saturates the voltage for 2 s: with the anti-windup, the speed
+    // settles quickly after a step to a reachable speed, while the integrator of a plain PI controller winds up
+    
+    {
+        Motor motor(Profile::KN, Profile::TIME_CONSTANT, 20.0);
+        Motor windupMotor(Profile::KN, Profile::TIME_CONSTANT, 20.0);
+        
+        SpeedController speedController;
+        initialize(speedController);
+        
+        WindupController windupController;
+        
+        unsigned int saturated = 0;
+        
+        for (unsigned int period = 0; period < 2000; period++) {
+            
+            float voltage = speedController.control(600.0f, 0.0f, motor.speed);
+            if (voltage == MAXIMUM_VOLTAGE) saturated++;
+            
+            motor.run(voltage);
+            windupMotor.run(windupController.control(600.0f, windupMotor.speed));
+        }
+        
+        CHECK(saturated > 1900);
+        CHECK(motor.speed < 600.0-100.0);
+        
+        const unsigned int PERIODS = 2000;
+        
+        static float speeds[PERIODS];
+        static float windupSpeeds[PERIODS];
+        
+        unsigned int periodsAtLimit = 0;
+        unsigned int windupPeriodsAtLimit = 0;
+        
+        for (unsigned int period = 0; period < PERIODS; period++) {
+            
+            float voltage = speedController.control(200.0f, 0.0f, motor.speed);
+            float windupVoltage = windupController.control(200.0f, windupMotor.speed);
+            
+            if ((voltage == MAXIMUM_VOLTAGE) && (periodsAtLimit == period)) periodsAtLimit++;
+            if ((windupVoltage == MAXIMUM_VOLTAGE) && (windupPeriodsAtLimit == period)) windupPeriodsAtLimit++;
+            
+            motor.run(voltage);
+            windupMotor.run(windupVoltage);
+            
+            speeds[period] = motor.speed;
+            windupSpeeds[period] = windupMotor.speed;
+        }
+        
+        unsigned int settled = settle(speeds, PERIODS, 200.0f, 2.0f);
+        unsigned int windupSettled = settle(windupSpeeds, PERIODS, 200.0f, 2.0f);
+        
+        CHECK(periodsAtLimit == 0);
+        CHECK(windupPeriodsAtLimit > 100);
+        CHECK(settled < 300);
+        CHECK(windupSettled > 3*settled);
+        CHECK_NEAR(motor.speed, 200.0, 0.01);
+        
+        printf("after saturation: settled within 2 rpm after %u ms with anti-windup, %u ms without, which stays at the limit for %u ms\n", settled, windupSettled, windupPeriodsAtLimit);
+    }
+    
+    // a step response of a motor without load recovers the speed constant and the time constant of the motor
+    
+    {
+        const double kns[] = {25.0, 40.0, 60.0};
+        const double timeConstants[] = {0.02, 0.05, 0.1};
+        
+        for (unsigned int i = 0; i < 3; i++) {
+            
+            Motor motor(kns[i], timeConstants[i], 0.0);
+            
+            SpeedController speedController;
+            initialize(speedController);
+            
+            speedController.startIdentification(6.0f, 10.0f*timeConstants[i]);
+            
+            CHECK(speedController.isIdentifying());
+            
+            unsigned int periods = 0;
+            
+            while (speedController.isIdentifying() && (periods < 10000)) {
+                motor.run(speedController.control(0.0f, 0.0f, motor.speed));
+                periods++;
+            }
+            
+            CHECK(!speedController.isIdentifying());
+            CHECK_NEAR(speedController.getKN(), kns[i], 0.005*kns[i]);
+            CHECK_NEAR(speedController.getTimeConstant(), timeConstants[i], 0.05*timeConstants[i]);
+            
+            printf("identification: kn %.2f rpm/V of %.2f rpm/V, time constant %.4f s of %.4f s\n", speedController.getKN(), kns[i], speedController.getTimeConstant(), timeConstants[i]);
+        }
+    }
+    
+    return TEST_RESULT;
+}
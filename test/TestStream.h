@@ -0,0 +1,42 @@
+/*
+ * TestStream.h
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#ifndef TEST_STREAM_H_
+#define TEST_STREAM_H_
+
+#include <cstdlib>
+#include <deque>
+#include "ByteStream.h"
+
+/**
+ * This is a byte stream for tests. Bytes that a test writes into its input are read
+ * by the object under test, and bytes that this object writes are discarded.
+ */
+class TestStream : public ByteStream {
+    
+    public:
+        
+        std::deque<char>    input;  /**< The bytes that are read from this stream. */
+        
+        int read(char buffer[], int size) {
+        
+            int n = 0;
+        
+            while ((n < size) && !input.empty()) {
+                buffer[n++] = input.front();
+                input.pop_front();
+            }
+        
+            return n;
+        }
+        
+        int write(const char[], int size) {
+        
+            return size;
+        }
+};
+
+#endif /* TEST_STREAM_H_ */
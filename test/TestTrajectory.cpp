@@ -0,0 +1,166 @@
+/*
+ * TestTrajectory.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include "Test.h"
+#include "Trajectory.h"
+#include "TaskFollowTrajectory.h"
+#include "TaskMoveTo.h"
+
+using namespace std;
+
+static const float  VELOCITY = 0.2f;                // limits of the route of the state machine
+static const float  ACCELERATION = 0.2f;
+static const float  LATERAL_ACCELERATION = 0.3f;
+static const float  PERIOD = 0.01f;                 // period of the task sequencer, given in [s]
+
+/**
+ * Tests the reference of a trajectory through the waypoints of a lap of the route, and measures
+ * the duration of a period of the trajectory task against the task that moves to a single pose.
+ */
+int main() {
+    
+    const float xs[] = {0.0f, 2.0f, 2.5f, 2.0f, 0.0f, -0.5f, 0.0f};
+    const float ys[] = {0.0f, 0.0f, 0.5f, 1.0f, 1.0f, 0.5f, 0.0f};
+    const unsigned short SIZE = 7;
+    
+    Trajectory trajectory;
+    
+    CHECK(!trajectory.compile(xs, ys, SIZE, 0.0f, ACCELERATION, LATERAL_ACCELERATION));
+    CHECK(trajectory.compile(xs, ys, SIZE, VELOCITY, ACCELERATION, LATERAL_ACCELERATION));
+    
+    float duration = trajectory.getDuration();
+    
+    CHECK(duration > 0.0f);
+    CHECK_NEAR(duration, (trajectory.getSize()-1)*0.1, 1.0e-4);
+    
+    // the trajectory starts at the first waypoint with zero velocity, in the direction of the second waypoint
+    
+    float x, y, cosAlpha, sinAlpha, velocity, rotationalVelocity;
+    
+    trajectory.get(0.0f, x, y, cosAlpha, sinAlpha, velocity, rotationalVelocity);
+    
+    CHECK_NEAR(x, xs[0], 0.002);
+    CHECK_NEAR(y, ys[0], 0.002);
+    CHECK_NEAR(cosAlpha, 1.0, 0.01);
+    CHECK_NEAR(velocity, 0.0, 0.002);
+    
+    // it passes through every other waypoint without stopping, and keeps the limits of the velocity
+    
+    float distances[SIZE];
+    float velocities[SIZE];
+    
+    for (unsigned short i = 0; i < SIZE; i++) distances[i] = 1.0e6f;
+    
+    float previousX = x, previousY = y;
+    float length = 0.0f;
+    
+    for (float time = 0.0f; time <= duration; time += 0.001f) {
+        
+        trajectory.get(time, x, y, cosAlpha, sinAlpha, velocity, rotationalVelocity);
+        
+        CHECK(velocity <= VELOCITY+0.002f);
+        CHECK(fabs(velocity*rotationalVelocity) <= LATERAL_ACCELERATION*1.05f);
+        CHECK_NEAR(cosAlpha*cosAlpha+sinAlpha*sinAlpha, 1.0, 0.01);    // interpolated between samples 0.1 s apart
+        
+        length += sqrt((x-previousX)*(x-previousX)+(y-previousY)*(y-previousY));
+        previousX = x;
+        previousY = y;
+        
+        // the waypoints are searched between the ends of the trajectory, because the lap ends at its start
+        
+        if ((time < 1.0f) || (time > duration-1.0f)) continue;
+        
+        for (unsigned short i = 1; i < SIZE-1; i++) {
+            float distance = sqrt((x-xs[i])*(x-xs[i])+(y-ys[i])*(y-ys[i]));
+            if (distance < distances[i]) {
+                distances[i] = distance;
+                velocities[i] = velocity;
+            }
+        }
+    }
+    
+    for (unsigned short i = 1; i < SIZE-1; i++) {
+        CHECK(distances[i] < 0.005f);
+        CHECK(velocities[i] > 0.05f);
+        printf("waypoint (%.1f, %.1f): distance %.1f mm, velocity %.3f m/s\n", xs[i], ys[i], distances[i]*1000.0f, velocities[i]);
+    }
+    
+    // the duration is at least the length of the trajectory at the maximum velocity
+    
+    CHECK(duration > length/VELOCITY);
+    
+    // it ends at the last waypoint with zero velocity, and stays there after its duration
+    
+    trajectory.get(duration, x, y, cosAlpha, sinAlpha, velocity, rotationalVelocity);
+    
+    CHECK_NEAR(x, xs[SIZE-1], 0.002);
+    CHECK_NEAR(y, ys[SIZE-1], 0.002);
+    CHECK_NEAR(velocity, 0.0, 0.002);
+    CHECK_NEAR(rotationalVelocity, 0.0, 0.002);
+    
+    trajectory.get(duration+10.0f, x, y, cosAlpha, sinAlpha, velocity, rotationalVelocity);
+    
+    CHECK_NEAR(x, xs[SIZE-1], 0.002);
+    CHECK_NEAR(y, ys[SIZE-1], 0.002);
+    CHECK(velocity == 0.0f);
+    
+    printf("trajectory: %.2f m in %.2f s with %u samples\n", length, duration, trajectory.getSize());
+    
+    // measure the duration of a period of both tasks, with the pose of a controller that is not running
+    
+    static PwmOut pwmLeft(PF_9);
+    static PwmOut pwmRight(PF_8);
+    static EncoderCounter counterLeft(PD_12, PD_13);
+    static EncoderCounter counterRight(PB_4, PC_7);
+    static SPI spi(PC_12, PC_11, PC_10);
+    static DigitalOut csAG(PC_8);
+    static DigitalOut csM(PC_9);
+    static IMU imu(spi, csAG, csM);
+    static PoseHistory poseHistory;
+    static Controller controller(pwmLeft, pwmRight, counterLeft, counterRight, imu, poseHistory);
+    
+    const unsigned int RUNS = 200;
+    const unsigned int PERIODS = (unsigned int)(duration/PERIOD);
+    
+    unsigned int running = 0;
+    
+    double start = testTime();
+    
+    for (unsigned int run = 0; run < RUNS; run++) {
+        
+        TaskFollowTrajectory taskFollowTrajectory(controller, trajectory);
+        
+        for (unsigned int period = 0; period < PERIODS; period++) {
+            if (taskFollowTrajectory.run(PERIOD) == Task::RUNNING) running++;
+        }
+    }
+    
+    double durationFollowTrajectory = testTime()-start;
+    
+    CHECK(running == RUNS*PERIODS);
+    
+    running = 0;
+    start = testTime();
+    
+    for (unsigned int run = 0; run < RUNS; run++) {
+        
+        TaskMoveTo taskMoveTo(controller, 2.5f, 0.5f, 1.5f, VELOCITY);
+        
+        for (unsigned int period = 0; period < PERIODS; period++) {
+            if (taskMoveTo.run(PERIOD) == Task::RUNNING) running++;
+        }
+    }
+    
+    double durationMoveTo = testTime()-start;
+    
+    CHECK(running == RUNS*PERIODS);
+    
+    printf("period of the tasks: %.0f ns to follow the trajectory, %.0f ns to move to a pose\n", durationFollowTrajectory/(RUNS*PERIODS)*1.0e9, durationMoveTo/(RUNS*PERIODS)*1.0e9);
+    
+    return TEST_RESULT;
+}
@@ -0,0 +1,16 @@
+/*
+ * host.h
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#ifndef HOST_H_
+#define HOST_H_
+
+#include <cmath>
+
+// the classes of the robot declare their own constant M_PI, which the math library of the host defines as a macro
+
+#undef M_PI
+
+#endif /* HOST_H_ */
@@ -0,0 +1,141 @@
+/*
+ * mbed.cpp
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#include "mbed.h"
+
+using namespace std;
+
+static TIM_TypeDef      tim2;
+static TIM_TypeDef      tim3;
+static TIM_TypeDef      tim4;
+static GPIO_TypeDef     gpioA;
+static GPIO_TypeDef     gpioB;
+static GPIO_TypeDef     gpioC;
+static GPIO_TypeDef     gpioD;
+static RCC_TypeDef      rcc;
+static DWT_Type         dwt;
+static CoreDebug_Type   coreDebug;
+
+TIM_TypeDef*    TIM2 = &tim2;
+TIM_TypeDef*    TIM3 = &tim3;
+TIM_TypeDef*    TIM4 = &tim4;
+GPIO_TypeDef*   GPIOA = &gpioA;
+GPIO_TypeDef*   GPIOB = &gpioB;
+GPIO_TypeDef*   GPIOC = &gpioC;
+GPIO_TypeDef*   GPIOD = &gpioD;
+RCC_TypeDef*    RCC = &rcc;
+DWT_Type*       DWT = &dwt;
+CoreDebug_Type* CoreDebug = &coreDebug;
+
+vector<Thread*> Thread::threads;
+
+static uint32_t     tickerTime = 0;         // time of the microsecond ticker, given in [us]
+static unsigned int remainingPeriods = 0;   // number of periods the running thread may still wait for
+
+/**
+ * This exception stops the task of a thread, when it waits for more periods than requested.
+ */
+class ThreadStop {};
+
+/**
+ * Creates a thread object.
+ */
+Thread::Thread(osPriority priority, uint32_t) : priority(priority) {
+    
+    threads.push_back(this);
+}
+
+/**
+ * Deletes a thread object.
+ */
+Thread::~Thread() {
+    
+    for (unsigned int i = 0; i < threads.size(); i++) {
+        if (threads[i] == this) {
+            threads.erase(threads.begin()+i);
+            break;
+        }
+    }
+}
+
+/**
+ * Stores the task of this thread, it is only run with the <code>run()</code> method.
+ */
+void Thread::start(Callback<void()> task) {
+    
+    this->task = task;
+}
+
+/**
+ * Runs the tasks of all started threads with a given priority for a number of periods.
+ * A task is entered again from the beginning with every call of this method, and
+ * it is stopped when it waits for the thread flag after the last period.
+ * @param priority the priority of the threads to run.
+ * @param periods the number of periods to run every task for.
+ */
+void Thread::run(osPriority priority, unsigned int periods) {
+    
+    for (unsigned int i = 0; i < threads.size(); i++) {
+        
+        if ((threads[i]->priority != priority) || !threads[i]->task) continue;
+        
+        remainingPeriods = periods;
+        
+        try {
+            threads[i]->task();
+        } catch (ThreadStop&) {}
+    }
+}
+
+/**
+ * Waits for the next period of the running thread, or stops its task after the last period.
+ */
+void ThisThread::flags_wait_any(uint32_t) {
+    
+    if (remainingPeriods == 0) throw ThreadStop();
+    
+    remainingPeriods--;
+}
+
+/**
+ * Transfers a byte to the simulated device.
+ * @param value the byte to send.
+ * @return the value of the selected register when it is read, 0 otherwise.
+ */
+int SPI::write(int value) {
+    
+    if (address < 0) {
+        address = value & 0x7F;
+        reading = (value & 0x80) != 0;
+        return 0;
+    }
+    
+    int result = 0;
+    
+    if (reading) result = registers[address];
+    else registers[address] = (uint8_t)value;
+    
+    address = -1;
+    
+    return result;
+}
+
+/**
+ * Gets the time of the microsecond ticker.
+ */
+uint32_t us_ticker_read() {
+    
+    return tickerTime;
+}
+
+/**
+ * Advances the time of the microsecond ticker.
+ * @param microseconds the time to advance, given in [us].
+ */
+void us_ticker_advance(uint32_t microseconds) {
+    
+    tickerTime += microseconds;
+}
@@ -0,0 +1,215 @@
+/*
+ * mbed.h
+ * Copyright (c) 2024, ZHAW
+ * All rights reserved.
+ */
+
+#ifndef MBED_H_
+#define MBED_H_
+
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <chrono>
+#include <functional>
+#include <vector>
+#include "host.h"
+
+/**
+ * This is a small stub of the mbed OS API, to build the classes of the robot on a host
+ * computer for tests. It contains only the parts of the API that these classes use.
+ * <br/>
+ * Threads are not started concurrently. The task of a thread is stored, and it is run
+ * synchronously by a test for a given number of periods with <code>Thread::run()</code>.
+ * The time of the microsecond ticker only advances with <code>us_ticker_advance()</code>,
+ * and the registers of the peripherals are plain structures that a test can write to.
+ */
+
+using namespace std::chrono_literals;
+
+enum PinName { PA_0, PA_15, PB_3, PB_4, PC_7, PD_12, PD_13, PF_8, PF_9, PC_8, PC_9, PC_10, PC_11, PC_12, PG_9, PG_14, NC };
+
+enum osPriority { osPriorityLow, osPriorityBelowNormal, osPriorityNormal, osPriorityAboveNormal, osPriorityHigh, osPriorityRealtime };
+
+template <typename F> class Callback;
+
+/**
+ * Stores a callback to a method of an object.
+ */
+template <> class Callback<void()> : public std::function<void()> {
+    
+    public:
+        
+        Callback() {}
+        Callback(const std::function<void()>& function) : std::function<void()>(function) {}
+};
+
+template <typename T, typename M> Callback<void()> callback(T* object, M method) {
+    
+    return Callback<void()>([object, method]() { (object->*method)(); });
+}
+
+/**
+ * Stores the task of a thread, which is run synchronously by a test.
+ */
+class Thread {
+    
+    public:
+        
+        Thread(osPriority priority = osPriorityNormal, uint32_t stackSize = 0);
+        virtual ~Thread();
+        void start(Callback<void()> task);
+        void flags_set(uint32_t) {}
+        static void run(osPriority priority, unsigned int periods);
+        
+    private:
+        
+        osPriority              priority;
+        Callback<void()>        task;
+        static std::vector<Thread*> threads;
+};
+
+namespace ThisThread {
+    void flags_wait_any(uint32_t flags);
+    template <typename D> void sleep_for(D) {}
+}
+
+class Mutex {
+    
+    public:
+        
+        void lock() {}
+        void unlock() {}
+};
+
+class Ticker {
+    
+    public:
+        
+        template <typename C, typename P> void attach(C, P) {}
+        void detach() {}
+};
+
+class PwmOut {
+    
+    public:
+        
+        PwmOut(PinName) { value = 0.5f; }
+        void period(float) {}
+        void write(float value) { this->value = value; }
+        float read() { return value; }
+        PwmOut& operator=(float value) { write(value); return *this; }
+        operator float() { return read(); }
+        
+    private:
+        
+        float value;
+};
+
+/**
+ * Simulates a device on the SPI bus with 128 registers, which a test can write to.
+ * The first byte of a transfer selects the register, and reads it when its most significant
+ * bit is set, the second byte is written into the register or returns its value.
+ */
+class SPI {
+    
+    public:
+        
+        uint8_t registers[128];
+        
+        SPI(PinName, PinName, PinName) : registers(), address(-1), reading(false) {}
+        void format(int, int) {}
+        void frequency(int) {}
+        int write(int value);
+        
+    private:
+        
+        int     address;
+        bool    reading;
+};
+
+class DigitalOut {
+    
+    public:
+        
+        DigitalOut(PinName) { value = 0; }
+        DigitalOut& operator=(int value) { this->value = value; return *this; }
+        operator int() { return value; }
+        
+    private:
+        
+        int value;
+};
+
+uint32_t us_ticker_read();
+void us_ticker_advance(uint32_t microseconds);
+
+inline void sleep_manager_lock_deep_sleep() {}
+inline void core_util_critical_section_enter() {}
+inline void core_util_critical_section_exit() {}
+inline uint32_t core_util_atomic_load_u32(const volatile uint32_t* pointer) { return *pointer; }
+inline void core_util_atomic_store_u32(volatile uint32_t* pointer, uint32_t value) { *pointer = value; }
+
+// registers of the peripherals that the drivers access directly
+
+struct TIM_TypeDef { volatile uint32_t CR1, CR2, SMCR, DIER, SR, EGR, CCMR1, CCMR2, CCER, CNT, PSC, ARR; };
+struct GPIO_TypeDef { volatile uint32_t MODER, OTYPER, OSPEEDR, PUPDR, IDR, ODR, BSRR, LCKR, AFR[2]; };
+struct RCC_TypeDef { volatile uint32_t AHB1ENR, APB1RSTR, APB1ENR; };
+struct DWT_Type { volatile uint32_t CTRL, CYCCNT, LAR; };
+struct CoreDebug_Type { volatile uint32_t DEMCR; };
+
+extern TIM_TypeDef*     TIM2;
+extern TIM_TypeDef*     TIM3;
+extern TIM_TypeDef*     TIM4;
+extern GPIO_TypeDef*    GPIOA;
+extern GPIO_TypeDef*    GPIOB;
+extern GPIO_TypeDef*    GPIOC;
+extern GPIO_TypeDef*    GPIOD;
+extern RCC_TypeDef*     RCC;
+extern DWT_Type*        DWT;
+extern CoreDebug_Type*  CoreDebug;
+
+#define RCC_AHB1ENR_GPIOBEN         (1u << 1)
+#define RCC_AHB1ENR_GPIOCEN         (1u << 2)
+#define RCC_AHB1ENR_GPIODEN         (1u << 3)
+#define RCC_APB1RSTR_TIM2RST        (1u << 0)
+#define RCC_APB1RSTR_TIM3RST        (1u << 1)
+#define RCC_APB1RSTR_TIM4RST        (1u << 2)
+#define RCC_APB1ENR_TIM2EN          (1u << 0)
+#define RCC_APB1ENR_TIM3EN          (1u << 1)
+#define RCC_APB1ENR_TIM4EN          (1u << 2)
+#define GPIO_MODER_MODER3           (3u << 6)
+#define GPIO_MODER_MODER3_1         (2u << 6)
+#define GPIO_MODER_MODER4           (3u << 8)
+#define GPIO_MODER_MODER4_1         (2u << 8)
+#define GPIO_MODER_MODER7           (3u << 14)
+#define GPIO_MODER_MODER7_1         (2u << 14)
+#define GPIO_MODER_MODER12          (3u << 24)
+#define GPIO_MODER_MODER12_1        (2u << 24)
+#define GPIO_MODER_MODER13          (3u << 26)
+#define GPIO_MODER_MODER13_1        (2u << 26)
+#define GPIO_MODER_MODER15          (3u << 30)
+#define GPIO_MODER_MODER15_1        (2u << 30)
+#define GPIO_PUPDR_PUPDR3           (3u << 6)
+#define GPIO_PUPDR_PUPDR3_1         (2u << 6)
+#define GPIO_PUPDR_PUPDR4           (3u << 8)
+#define GPIO_PUPDR_PUPDR4_1         (2u << 8)
+#define GPIO_PUPDR_PUPDR7           (3u << 14)
+#define GPIO_PUPDR_PUPDR7_1         (2u << 14)
+#define GPIO_PUPDR_PUPDR12          (3u << 24)
+#define GPIO_PUPDR_PUPDR12_1        (2u << 24)
+#define GPIO_PUPDR_PUPDR13          (3u << 26)
+#define GPIO_PUPDR_PUPDR13_1        (2u << 26)
+#define GPIO_PUPDR_PUPDR15          (3u << 30)
+#define GPIO_PUPDR_PUPDR15_1        (2u << 30)
+#define TIM_SMCR_SMS_0              (1u << 0)
+#define TIM_SMCR_SMS_1              (1u << 1)
+#define TIM_CCMR1_CC1S_0            (1u << 0)
+#define TIM_CCMR1_CC2S_0            (1u << 8)
+#define TIM_CCER_CC1E               (1u << 0)
+#define TIM_CCER_CC2E               (1u << 4)
+#define TIM_CR1_CEN                 (1u << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk  (1u << 24)
+#define DWT_CTRL_CYCCNTENA_Msk      (1u << 0)
+
+#endif /* MBED_H_ */